@@ -0,0 +1,135 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/adc_sampler.c
+ * @author  WIZnet
+ * @brief   Background ADC sampling driven by the DUALTIMER0 interrupt
+ ******************************************************************************
+ * @attention
+ *
+ * Every DUALTIMER0 period the timer interrupt scans all configured channels,
+ * averages SAMPLER_OVERSAMPLE conversions per channel, filters and
+ * calibrates them (moisture.c) and publishes the result as one snapshot. The interrupt is the only writer and the main loop
+ * the only reader, so the snapshot is guarded by a sequence counter instead
+ * of a lock: the counter is odd while the interrupt is writing, and a reader
+ * that sees it odd or changed across its copy simply copies again.
+ *
+ * Sampler_TimerHandler() must be called from DUALTIMER0_Handler() in
+ * W7500x_it.c after the timer interrupt has been cleared.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "adc_sampler.h"
+#include "tick.h"
+#include "metrics.h"
+#include "moisture.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+#define SAMPLER_BARRIER() __asm volatile ("" ::: "memory")
+
+/* Private variables ---------------------------------------------------------*/
+/* ADC channel of every scanned input, in snapshot order */
+static const uint8_t sampler_channel[SAMPLER_CH_NUM] = {
+    2,      /* AIN2 : PC13, soil moisture probe */
+    1,      /* AIN1 : PC14 */
+    6,      /* AIN6 : PC9 */
+    7,      /* AIN7 : PC8 */
+};
+
+static __IO uint32_t sampler_lock = 0;
+static Sampler_Snapshot sampler_snap;
+
+/* Private function prototypes -----------------------------------------------*/
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Initializes the sampler.
+ * @note   DUALTIMER0 must be configured for SAMPLER_RATE_HZ interrupts.
+ * @param  None
+ * @retval None
+ */
+void Sampler_Init(void)
+{
+    memset(&sampler_snap, 0, sizeof(sampler_snap));
+    sampler_lock = 0;
+    Moisture_Init();
+
+    ADC_Cmd(ENABLE);
+}
+
+/**
+ * @brief  Scans all channels and publishes a new snapshot.
+ * @note   Runs in DUALTIMER0 interrupt context.
+ * @param  None
+ * @retval None
+ */
+void Sampler_TimerHandler(void)
+{
+    METRICS_TIMER(t);
+    uint16_t raw[SAMPLER_CH_NUM];
+    uint16_t value[SAMPLER_CH_NUM];
+    uint16_t moisture[SAMPLER_CH_NUM];
+    uint32_t sum;
+    uint8_t ch;
+    uint8_t n;
+
+    METRICS_START(t);
+    for (ch = 0; ch < SAMPLER_CH_NUM; ch++) {
+        ADC_ChannelConfig(sampler_channel[ch]);
+
+        sum = 0;
+        for (n = 0; n < SAMPLER_OVERSAMPLE; n++) {
+            ADC_StartOfConversion();
+            sum += ADC_GetConversionValue();
+        }
+        raw[ch] = (uint16_t) ((sum + SAMPLER_OVERSAMPLE / 2) / SAMPLER_OVERSAMPLE);
+    }
+    Moisture_Process(raw, value, moisture);
+    METRICS_STOP(METRICS_PHASE_ADC, t);
+
+    sampler_lock++;
+    SAMPLER_BARRIER();
+
+    sampler_snap.seq++;
+    sampler_snap.tick = Tick_GetMs();
+    memcpy(sampler_snap.value, value, sizeof(value));
+    memcpy(sampler_snap.moisture, moisture, sizeof(moisture));
+
+    SAMPLER_BARRIER();
+    sampler_lock++;
+}
+
+/**
+ * @brief  Copies the latest snapshot.
+ * @note   Never touches the ADC. Retries only if a scan completed while
+ *         copying.
+ * @param  snap: Destination of the snapshot.
+ * @retval None
+ */
+void Sampler_Read(Sampler_Snapshot* snap)
+{
+    uint32_t lock;
+
+    do {
+        lock = sampler_lock;
+        SAMPLER_BARRIER();
+        memcpy(snap, &sampler_snap, sizeof(*snap));
+        SAMPLER_BARRIER();
+    } while ((lock & 1) || lock != sampler_lock);
+}
+
+/**
+ * @brief  Returns the sequence number of the latest snapshot.
+ * @param  None
+ * @retval Scan sequence number, 0 before the first scan.
+ */
+uint32_t Sampler_GetSeq(void)
+{
+    return *(__IO uint32_t*) &sampler_snap.seq;
+}
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
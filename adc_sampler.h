@@ -0,0 +1,47 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/adc_sampler.h
+ * @author  WIZnet
+ * @brief   Header for adc_sampler.c module
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __ADC_SAMPLER_H
+#define __ADC_SAMPLER_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/* Number of analog inputs scanned (PC13, PC14, PC9, PC8) */
+#define SAMPLER_CH_NUM 4
+
+/* Channel scans per second; sets the DUALTIMER0 period */
+#ifndef SAMPLER_RATE_HZ
+#define SAMPLER_RATE_HZ 10
+#endif
+
+/* Conversions averaged into one reading per channel and scan */
+#ifndef SAMPLER_OVERSAMPLE
+#define SAMPLER_OVERSAMPLE 8
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t seq;                       /* Scan sequence number, 0 = no scan yet */
+    uint32_t tick;                      /* Millisecond tick of the scan */
+    uint16_t value[SAMPLER_CH_NUM];     /* Filtered ADC counts per channel */
+    uint16_t moisture[SAMPLER_CH_NUM];  /* Calibrated moisture per channel, 0.1 % */
+} Sampler_Snapshot;
+
+/* Exported functions ------------------------------------------------------- */
+void Sampler_Init(void);
+void Sampler_TimerHandler(void);
+void Sampler_Read(Sampler_Snapshot* snap);
+uint32_t Sampler_GetSeq(void);
+
+#endif /* __ADC_SAMPLER_H */
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
@@ -0,0 +1,151 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/arena.c
+ * @author  WIZnet
+ * @brief   Static arena of the protocol handlers' working buffers
+ ******************************************************************************
+ * @attention
+ *
+ * Every handler gets its own fixed slice of one statically allocated
+ * arena: the DHCP client, each HTTP socket's request buffer, the reply
+ * buffer the HTTP sockets render into one reply at a time, the telemetry
+ * datagram and the Modbus request and reply buffers. The layout is fixed
+ * at compile time, and the build fails if the arena and the state of the
+ * other modules leave less than RAM_STACK_RESERVE of SRAM for the stack.
+ *
+ * Arena_Init() fills the arena with a paint byte before any handler runs.
+ * The high-water mark of a region is then the offset past the last byte
+ * that no longer holds the paint, found by scanning down from the end of
+ * the region; a byte written with the paint value itself is missed, so
+ * the mark may come out a little low.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "arena.h"
+#include "log.h"
+
+/* Private define ------------------------------------------------------------*/
+#define ARENA_PAINT 0xA5
+
+/* Private variables ---------------------------------------------------------*/
+Arena arena;
+
+/* Names of the regions after the HTTP RX buffers */
+static const char* const arena_region_name[] = { "http_tx", "telemetry", "modbus_rx", "modbus_tx" };
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Returns the start of a region.
+ * @param  region: Region number, below ARENA_REGION_NUM.
+ * @retval Start of the region.
+ */
+static const uint8_t* Arena_RegionStart(uint8_t region)
+{
+    if (region == 0) return arena.dhcp;
+    if (region <= HTTP_SOCK_COUNT) return arena.http_rx[region - 1];
+
+    switch (region - HTTP_SOCK_COUNT)
+    {
+        case 1:
+            return arena.http_tx;
+        case 2:
+            return arena.telemetry;
+        case 3:
+            return arena.modbus_rx;
+        default:
+            return arena.modbus_tx;
+    }
+}
+
+/**
+ * @brief  Paints the arena.
+ * @note   Called once at boot, before any handler takes its buffer.
+ * @param  None
+ * @retval None
+ */
+void Arena_Init(void)
+{
+    memset(&arena, ARENA_PAINT, sizeof(arena));
+}
+
+/**
+ * @brief  Logs the size and high-water mark of every region.
+ * @param  None
+ * @retval None
+ */
+void Arena_Report(void)
+{
+    char name[ARENA_NAME_MAX];
+    uint32_t used = 0;
+    uint16_t high;
+    uint8_t region;
+
+    for (region = 0; region < ARENA_REGION_NUM; region++) {
+        Arena_RegionName(region, name);
+        high = Arena_HighWater(region);
+        used += high;
+        LOG_INFO("Arena %-9s : %4u bytes, %4u used", name, Arena_RegionSize(region), high);
+    }
+    LOG_INFO("Arena : %u bytes, %lu used; static data %u of %u bytes SRAM", (unsigned) sizeof(arena), (unsigned long) used,
+            (unsigned) RAM_STATIC_SIZE, RAM_SIZE);
+}
+
+/**
+ * @brief  Writes the name of a region.
+ * @note   The HTTP RX buffers are named after their sockets.
+ * @param  region: Region number, below ARENA_REGION_NUM.
+ * @param  out: Output, at least ARENA_NAME_MAX bytes.
+ * @retval Length of the name.
+ */
+uint8_t Arena_RegionName(uint8_t region, char* out)
+{
+    if (region == 0) return (uint8_t) sprintf(out, "dhcp");
+    if (region <= HTTP_SOCK_COUNT) return (uint8_t) sprintf(out, "http_rx%u", HTTP_SOCK_START + region - 1);
+    return (uint8_t) sprintf(out, "%s", arena_region_name[region - HTTP_SOCK_COUNT - 1]);
+}
+
+/**
+ * @brief  Returns the size of a region.
+ * @param  region: Region number, below ARENA_REGION_NUM.
+ * @retval Size in bytes.
+ */
+uint16_t Arena_RegionSize(uint8_t region)
+{
+    if (region == 0) return ARENA_DHCP_SIZE;
+    if (region <= HTTP_SOCK_COUNT) return HTTP_RX_BUF_SIZE;
+
+    switch (region - HTTP_SOCK_COUNT)
+    {
+        case 1:
+            return HTTP_TX_BUF_SIZE;
+        case 2:
+            return TELEMETRY_BUF_SIZE;
+        case 3:
+            return MODBUS_RX_BUF_SIZE;
+        default:
+            return MODBUS_TX_BUF_SIZE;
+    }
+}
+
+/**
+ * @brief  Returns how much of a region has been written since boot.
+ * @param  region: Region number, below ARENA_REGION_NUM.
+ * @retval Offset past the last byte written.
+ */
+uint16_t Arena_HighWater(uint8_t region)
+{
+    const uint8_t* start = Arena_RegionStart(region);
+    uint16_t len = Arena_RegionSize(region);
+
+    while (len > 0 && start[len - 1] == ARENA_PAINT) {
+        len--;
+    }
+    return len;
+}
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
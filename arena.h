@@ -0,0 +1,87 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/arena.h
+ * @author  WIZnet
+ * @brief   Header for arena.c module
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __ARENA_H
+#define __ARENA_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "web_server.h"
+#include "telemetry.h"
+#include "modbus.h"
+#include "history.h"
+#include "moisture.h"
+#include "flash_store.h"
+#include "metrics.h"
+#include "log.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* DHCP message buffer. The ioLibrary DHCP client reads whatever datagram
+ * is waiting on socket 0 into it, with no bound but the socket's RX buffer,
+ * so it must be as large as that buffer (NET_DHCP_RXBUF_KB in main.c) and
+ * not just the 548 bytes of a DHCP message. */
+#define ARENA_DHCP_SIZE 1024
+
+/* Every working buffer, laid out in the arena in this order */
+#define ARENA_SIZE (ARENA_DHCP_SIZE + HTTP_SOCK_COUNT * HTTP_RX_BUF_SIZE + HTTP_TX_BUF_SIZE \
+                    + TELEMETRY_BUF_SIZE + MODBUS_RX_BUF_SIZE + MODBUS_TX_BUF_SIZE)
+
+/* SRAM of the W7500x, and the part of it no static data may take so that
+ * the stack has room */
+#define RAM_SIZE 16384
+#ifndef RAM_STACK_RESERVE
+#define RAM_STACK_RESERVE 2048
+#endif
+
+/* Static data not accounted to a module: the scalars of the smaller
+ * modules, the ioLibrary's chip and DHCP client state and the C library */
+#ifndef RAM_OTHER_SIZE
+#define RAM_OTHER_SIZE 1024
+#endif
+
+/* All static data: the arena and the state of every module that holds more
+ * than a few scalars. Each module checks its *_RAM_SIZE against the size of
+ * its variables, so a table that grows shows up here. */
+#define RAM_STATIC_SIZE (ARENA_SIZE + HISTORY_RAM_SIZE + LOG_RAM_SIZE + METRICS_RAM_SIZE + MOISTURE_RAM_SIZE \
+                         + STORE_RAM_SIZE + HTTP_RAM_SIZE + RAM_OTHER_SIZE)
+
+#if (RAM_STATIC_SIZE + RAM_STACK_RESERVE) > RAM_SIZE
+#error "Static data leaves less than RAM_STACK_RESERVE of SRAM for the stack"
+#endif
+
+/* Regions reported on: DHCP, every HTTP RX buffer, then the rest */
+#define ARENA_REGION_NUM (1 + HTTP_SOCK_COUNT + 4)
+
+/* Longest region name */
+#define ARENA_NAME_MAX 12
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+    uint8_t dhcp[ARENA_DHCP_SIZE];                          /* DHCP client, socket 0 */
+    uint8_t http_rx[HTTP_SOCK_COUNT][HTTP_RX_BUF_SIZE];     /* Requests per HTTP socket */
+    uint8_t http_tx[HTTP_TX_BUF_SIZE];                      /* Replies, rendered per request */
+    uint8_t telemetry[TELEMETRY_BUF_SIZE];                  /* Telemetry datagram */
+    uint8_t modbus_rx[MODBUS_RX_BUF_SIZE];                  /* Modbus requests */
+    uint8_t modbus_tx[MODBUS_TX_BUF_SIZE];                  /* Modbus replies */
+} Arena;
+
+/* Exported variables --------------------------------------------------------*/
+extern Arena arena;
+
+/* Exported functions ------------------------------------------------------- */
+void Arena_Init(void);
+void Arena_Report(void);
+uint8_t Arena_RegionName(uint8_t region, char* out);
+uint16_t Arena_RegionSize(uint8_t region);
+uint16_t Arena_HighWater(uint8_t region);
+
+#endif /* __ARENA_H */
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
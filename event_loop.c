@@ -0,0 +1,142 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/event_loop.c
+ * @author  WIZnet
+ * @brief   Event-driven main loop that sleeps while there is nothing to do
+ ******************************************************************************
+ * @attention
+ *
+ * Interrupts post events: the WZTOE interrupt one per socket with pending
+ * Sn_IR bits (CON, DISCON, RECV and TIMEOUT, and SENDOK where the web
+ * server waits for it), DUALTIMER0 a new sample every
+ * scan and a second every SAMPLER_RATE_HZ scans. Event_Run() takes the pending events, runs every
+ * task of the table listening to one of them and puts the core to sleep
+ * with WFI once no event is left.
+ *
+ * Sn_IR is level-triggered, so the interrupt handler masks the sockets it
+ * has seen in SIMR. Before the tasks run, their Sn_IR bits are cleared,
+ * except CON, which the web server clears itself once it has taken over the
+ * connection, and SENDOK, which send() takes before it issues the next
+ * SEND; the sockets are unmasked again when the tasks are done, so
+ * whatever happened meanwhile raises a new interrupt.
+ *
+ * A task that leaves work behind without a new interrupt to come, such as
+ * pipelined requests or a socket to reopen, posts its event again.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "wizchip_conf.h"
+#include "event_loop.h"
+
+/* Private variables ---------------------------------------------------------*/
+static __IO uint32_t event_pending;
+static uint32_t event_sleeps;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Enables the socket interrupts and marks every event pending, so
+ *         every task runs once on the first pass.
+ * @note   SENDOK is left masked; the web server unmasks it on a socket
+ *         while a reply waits for the SEND in progress.
+ * @param  None
+ * @retval None
+ */
+void Event_Init(void)
+{
+    uint8_t sn;
+
+    for (sn = 0; sn < _WIZCHIP_SOCK_NUM_; sn++) {
+        setSn_IMR(sn, Sn_IR_CON | Sn_IR_DISCON | Sn_IR_RECV | Sn_IR_TIMEOUT);
+        setSn_IR(sn, 0xFF);
+    }
+    setSIMR((uint8_t) EVENT_SOCKET_ALL);
+
+    event_pending = EVENT_ALL;
+}
+
+/**
+ * @brief  Marks events pending.
+ * @note   May be called from interrupt handlers and from tasks.
+ * @param  events: EVENT_* bits.
+ * @retval None
+ */
+void Event_Post(uint32_t events)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    event_pending |= events;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Runs the tasks on the events posted to them; never returns.
+ * @param  tasks: Task table.
+ * @param  count: Number of tasks in the table.
+ * @retval None
+ */
+void Event_Run(const Event_Task* tasks, uint8_t count)
+{
+    uint32_t events;
+    uint8_t sn;
+    uint8_t i;
+
+    while (1) {
+        __disable_irq();
+        while (event_pending == 0) {
+            event_sleeps++;
+            /* Wakes on any interrupt, which is taken once unmasked */
+            __WFI();
+            __enable_irq();
+            __disable_irq();
+        }
+        events = event_pending;
+        event_pending = 0;
+        __enable_irq();
+
+        for (sn = 0; sn < _WIZCHIP_SOCK_NUM_; sn++) {
+            if (events & EVENT_SOCKET(sn)) setSn_IR(sn, (uint8_t) (getSn_IR(sn) & ~(Sn_IR_CON | Sn_IR_SENDOK)));
+        }
+
+        for (i = 0; i < count; i++) {
+            if (events & tasks[i].events) tasks[i].run();
+        }
+
+        if (events & EVENT_SOCKET_ALL) {
+            __disable_irq();
+            setSIMR((uint8_t) (getSIMR() | (events & EVENT_SOCKET_ALL)));
+            __enable_irq();
+        }
+    }
+}
+
+/**
+ * @brief  Posts the sockets with pending Sn_IR bits and masks them until
+ *         their tasks have run.
+ * @note   Must be called from WZTOE_Handler() in W7500x_it.c.
+ * @param  None
+ * @retval None
+ */
+void Event_SocketHandler(void)
+{
+    uint8_t sir = getSIR();
+
+    setSIMR((uint8_t) (getSIMR() & ~sir));
+    Event_Post(sir);
+}
+
+/**
+ * @brief  Returns how often the core has gone to sleep.
+ * @param  None
+ * @retval Sleeps since boot.
+ */
+uint32_t Event_GetSleeps(void)
+{
+    return event_sleeps;
+}
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
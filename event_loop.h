@@ -0,0 +1,40 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/event_loop.h
+ * @author  WIZnet
+ * @brief   Header for event_loop.c module
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __EVENT_LOOP_H
+#define __EVENT_LOOP_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/* Events, one bit each. The socket events use the bit layout of SIR. */
+#define EVENT_SOCKET(sn)    (1UL << (sn))
+#define EVENT_SOCKET_ALL    0xFFUL
+#define EVENT_SAMPLE        (1UL << 8)      /* New sample snapshot */
+#define EVENT_SECOND        (1UL << 9)      /* One second elapsed */
+#define EVENT_ALL           0x3FFUL
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+    void (*run)(void);
+    uint32_t events;                        /* Events the task runs on */
+} Event_Task;
+
+/* Exported functions ------------------------------------------------------- */
+void Event_Init(void);
+void Event_Post(uint32_t events);
+void Event_Run(const Event_Task* tasks, uint8_t count);
+void Event_SocketHandler(void);
+uint32_t Event_GetSleeps(void);
+
+#endif /* __EVENT_LOOP_H */
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
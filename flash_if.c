@@ -0,0 +1,97 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/flash_if.c
+ * @author  WIZnet
+ * @brief   Erase and program of the internal code flash through the IAP
+ *          routines in ROM
+ ******************************************************************************
+ * @attention
+ *
+ * The flash cannot be read while it is erased or programmed, so the IAP
+ * call runs with interrupts held off: a block erase stalls the core for
+ * milliseconds, programming for tens of microseconds a word. The TOE keeps
+ * the TCP connections going meanwhile, but callers should batch their
+ * writes and keep them off the request path.
+ *
+ * Programming only clears bits; a word has to be erased with its block
+ * before it can be written again. Addresses and lengths given to
+ * Flash_Program() are multiples of 4.
+ *
+ * The host build replaces this file with host/w7500_flash.c.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "main.h"
+#include "flash_if.h"
+
+/* Private define ------------------------------------------------------------*/
+#define IAP_ENTRY       0x1FFF1001
+#define IAP_ERAS_BLCK   0x013
+#define IAP_PROG        0x022
+
+/* Private typedef -----------------------------------------------------------*/
+typedef void (*IAP_Func)(uint32_t id, uint32_t dst_addr, const uint8_t* src_addr, uint32_t size);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Calls an IAP routine with interrupts held off.
+ * @param  id: IAP command.
+ * @param  dst_addr: Flash address.
+ * @param  src_addr: Data to program, 0 for an erase.
+ * @param  size: Length of the data.
+ * @retval None
+ */
+static void Flash_IAP(uint32_t id, uint32_t dst_addr, const uint8_t* src_addr, uint32_t size)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    ((IAP_Func) IAP_ENTRY)(id, dst_addr, src_addr, size);
+    if (!primask) __enable_irq();
+}
+
+/**
+ * @brief  Erases one block of FLASH_BLOCK_SIZE bytes to 0xFF.
+ * @param  addr: Address of the block, a multiple of FLASH_BLOCK_SIZE.
+ * @retval 0 on success, -1 if the address is invalid.
+ */
+int8_t Flash_EraseBlock(uint32_t addr)
+{
+    if (addr >= FLASH_SIZE || (addr & (FLASH_BLOCK_SIZE - 1)) != 0) return -1;
+
+    Flash_IAP(IAP_ERAS_BLCK, addr, 0, 0);
+    return 0;
+}
+
+/**
+ * @brief  Programs erased flash.
+ * @param  addr: Flash address, a multiple of 4.
+ * @param  data: Data to program.
+ * @param  len: Length of the data, a multiple of 4.
+ * @retval 0 on success, -1 if the range is invalid.
+ */
+int8_t Flash_Program(uint32_t addr, const void* data, uint32_t len)
+{
+    if (addr + len > FLASH_SIZE || ((addr | len) & 3) != 0) return -1;
+
+    Flash_IAP(IAP_PROG, addr, (const uint8_t*) data, len);
+    return 0;
+}
+
+/**
+ * @brief  Reads flash.
+ * @param  addr: Flash address.
+ * @param  out: Output buffer.
+ * @param  len: Number of bytes to read.
+ * @retval None
+ */
+void Flash_Read(uint32_t addr, void* out, uint32_t len)
+{
+    memcpy(out, (const void*) addr, len);
+}
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
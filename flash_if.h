@@ -0,0 +1,28 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/flash_if.h
+ * @author  WIZnet
+ * @brief   Header for flash_if.c module
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FLASH_IF_H
+#define __FLASH_IF_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/* Code flash: 128 KB from address 0, erased in blocks of 4 KB */
+#define FLASH_SIZE          0x20000
+#define FLASH_BLOCK_SIZE    0x1000
+
+/* Exported functions ------------------------------------------------------- */
+int8_t Flash_EraseBlock(uint32_t addr);
+int8_t Flash_Program(uint32_t addr, const void* data, uint32_t len);
+void Flash_Read(uint32_t addr, void* out, uint32_t len);
+
+#endif /* __FLASH_IF_H */
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
@@ -0,0 +1,410 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/flash_store.c
+ * @author  WIZnet
+ * @brief   Append-only, log-structured record store in the internal flash
+ ******************************************************************************
+ * @attention
+ *
+ * The store takes STORE_PAGE_NUM flash blocks and writes them in turn, so
+ * every block is erased equally often. A page starts with a header holding
+ * a sequence number, one more than the page written before it, followed by
+ * records:
+ *
+ *   type, key, len, check    check = type ^ key ^ len ^ 0x5A
+ *   payload                  len bytes, padded to a multiple of 4
+ *   CRC-32                   of the 4 header bytes and the payload
+ *
+ * Records are only ever appended. When the active page is full the next
+ * one is erased, given the next sequence number, and the latest record of
+ * every state type and key (the lease, the calibration of each channel) is
+ * copied into it first, so the page erased after it never holds the only
+ * copy of a state. Log records (rollups) are not copied and disappear with
+ * their page.
+ *
+ * Store_Write() only queues the encoded record in RAM; Store_Run(), a main
+ * loop task, programs the queue in one go once its oldest record has
+ * waited STORE_FLUSH_MS or it is half full, so flash stalls stay off the
+ * request path and few records cost few IAP calls.
+ *
+ * At boot Store_Init() orders the valid pages by sequence number and hands
+ * every record with a good CRC to the caller, oldest first, so later
+ * records override earlier ones. Power lost partway through a write leaves
+ * a page header or record that fails its check:
+ *   - a torn page header makes the page invalid, and it is erased again
+ *     when its turn comes;
+ *   - a torn record body fails its CRC and is skipped;
+ *   - a torn record header ends the page, and writing goes on in the next.
+ * A state missing from the active page, after its copies were cut short,
+ * is queued again.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "main.h"
+#include "flash_store.h"
+#include "tick.h"
+#include "metrics.h"
+#include "log.h"
+
+/* Private define ------------------------------------------------------------*/
+#define STORE_MAGIC         0x474C4D53  /* "SMLG" */
+#define STORE_PAGE_HDR_SIZE 12
+#define STORE_REC_HDR_SIZE  4
+#define STORE_REC_CHECK     0x5A
+#define STORE_ALIGN4(n)     (((n) + 3u) & ~3u)
+#define STORE_REC_SIZE(len) (STORE_REC_HDR_SIZE + STORE_ALIGN4(len) + 4)
+#define STORE_REC_MAX       STORE_REC_SIZE(STORE_DATA_MAX)
+
+#define STORE_PAGE_ADDR(p)  (STORE_BASE + (uint32_t) (p) * STORE_PAGE_SIZE)
+
+#if STORE_PAGE_NUM < 3
+#error "STORE_PAGE_NUM must be at least 3"
+#endif
+#if (STORE_BASE % FLASH_BLOCK_SIZE) != 0 || (STORE_BASE + STORE_PAGE_NUM * STORE_PAGE_SIZE) > FLASH_SIZE
+#error "The store must take whole flash blocks"
+#endif
+#if (STORE_PAGE_HDR_SIZE + 2 * STORE_STATE_NUM * STORE_REC_MAX) > STORE_PAGE_SIZE
+#error "STORE_STATE_NUM too high for the page size"
+#endif
+#if STORE_QUEUE_SIZE < 2 * STORE_REC_MAX
+#error "STORE_QUEUE_SIZE too small"
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+    uint8_t type;
+    uint8_t key;
+    uint8_t len;
+    uint8_t in_active;                  /* Seen in the active page at boot */
+    uint8_t data[STORE_DATA_MAX];
+} Store_State;
+
+/* Private variables ---------------------------------------------------------*/
+static const uint32_t store_crc_table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static int8_t store_page;               /* Active page, -1 before the first */
+static uint32_t store_seq;              /* Sequence number of the active page */
+static uint32_t store_pos;              /* Write offset in the active page */
+
+static uint8_t store_queue[STORE_QUEUE_SIZE];
+static uint16_t store_queue_len;
+static uint32_t store_queue_since;      /* Tick the oldest queued record came */
+
+static Store_State store_state[STORE_STATE_NUM];
+static uint8_t store_state_num;
+
+/* Fails to compile if STORE_RAM_SIZE no longer covers the state above */
+typedef char store_ram_check[(sizeof(store_page) + sizeof(store_seq) + sizeof(store_pos) + sizeof(store_queue)
+        + sizeof(store_queue_len) + sizeof(store_queue_since) + sizeof(store_state) + sizeof(store_state_num) <= STORE_RAM_SIZE) ? 1 : -1];
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Updates a CRC-32 (IEEE 802.3) with a block of data.
+ * @param  crc: CRC so far, 0xFFFFFFFF to start; complemented at the end.
+ * @param  data: Data.
+ * @param  len: Length of the data.
+ * @retval Updated CRC.
+ */
+static uint32_t Store_CRC(uint32_t crc, const uint8_t* data, uint32_t len)
+{
+    while (len--) {
+        crc ^= *data++;
+        crc = (crc >> 4) ^ store_crc_table[crc & 0x0F];
+        crc = (crc >> 4) ^ store_crc_table[crc & 0x0F];
+    }
+    return crc;
+}
+
+/**
+ * @brief  Encodes a record.
+ * @param  out: Output, STORE_REC_SIZE(len) bytes.
+ * @param  type: Record type.
+ * @param  key: Record key.
+ * @param  data: Payload.
+ * @param  len: Length of the payload, at most STORE_DATA_MAX.
+ * @retval Length of the record.
+ */
+static uint16_t Store_Encode(uint8_t* out, uint8_t type, uint8_t key, const void* data, uint8_t len)
+{
+    uint16_t size = STORE_REC_SIZE(len);
+    uint32_t crc;
+
+    out[0] = type;
+    out[1] = key;
+    out[2] = len;
+    out[3] = (uint8_t) (type ^ key ^ len ^ STORE_REC_CHECK);
+    memcpy(out + STORE_REC_HDR_SIZE, data, len);
+    memset(out + STORE_REC_HDR_SIZE + len, 0, STORE_ALIGN4(len) - len);
+
+    crc = ~Store_CRC(0xFFFFFFFF, out, STORE_REC_HDR_SIZE + len);
+    out[size - 4] = (uint8_t) crc;
+    out[size - 3] = (uint8_t) (crc >> 8);
+    out[size - 2] = (uint8_t) (crc >> 16);
+    out[size - 1] = (uint8_t) (crc >> 24);
+    return size;
+}
+
+/**
+ * @brief  Keeps the latest record of a state type and key.
+ * @param  type: Record type, with STORE_REC_STATE set.
+ * @param  key: Record key.
+ * @param  data: Payload.
+ * @param  len: Length of the payload.
+ * @retval The state entry, 0 if the table is full.
+ */
+static Store_State* Store_Remember(uint8_t type, uint8_t key, const uint8_t* data, uint8_t len)
+{
+    Store_State* s = store_state;
+    uint8_t i;
+
+    for (i = 0; i < store_state_num; i++, s++) {
+        if (s->type == type && s->key == key) break;
+    }
+    if (i == store_state_num) {
+        if (store_state_num == STORE_STATE_NUM) return 0;
+        store_state_num++;
+    }
+
+    s->type = type;
+    s->key = key;
+    s->len = len;
+    memcpy(s->data, data, len);
+    return s;
+}
+
+/**
+ * @brief  Appends an encoded record to the queue.
+ * @param  type: Record type.
+ * @param  key: Record key.
+ * @param  data: Payload.
+ * @param  len: Length of the payload.
+ * @retval 0 on success, -1 if the queue is full.
+ */
+static int8_t Store_Enqueue(uint8_t type, uint8_t key, const void* data, uint8_t len)
+{
+    if (store_queue_len + STORE_REC_SIZE(len) > STORE_QUEUE_SIZE) return -1;
+
+    if (store_queue_len == 0) store_queue_since = Tick_GetMs();
+    store_queue_len += Store_Encode(store_queue + store_queue_len, type, key, data, len);
+    return 0;
+}
+
+/**
+ * @brief  Reads the records of a page and hands the valid ones over.
+ * @param  page: Page number.
+ * @param  handler: Called for every valid record, may be 0.
+ * @param  active: The page is the active one.
+ * @retval Offset after the last record, STORE_PAGE_SIZE if the page
+ *         cannot take more.
+ */
+static uint32_t Store_ScanPage(uint8_t page, Store_Handler handler, uint8_t active)
+{
+    uint8_t rec[STORE_REC_MAX];
+    Store_State* s;
+    uint32_t addr = STORE_PAGE_ADDR(page);
+    uint32_t pos = STORE_PAGE_HDR_SIZE;
+    uint32_t crc;
+    uint16_t size;
+
+    while (pos + STORE_REC_SIZE(0) <= STORE_PAGE_SIZE) {
+        Flash_Read(addr + pos, rec, STORE_REC_HDR_SIZE);
+
+        /* Erased: the free space starts here */
+        if ((rec[0] & rec[1] & rec[2] & rec[3]) == 0xFF) return pos;
+
+        /* A torn header gives no length to skip by */
+        if ((rec[0] ^ rec[1] ^ rec[2] ^ STORE_REC_CHECK) != rec[3] || rec[2] > STORE_DATA_MAX) break;
+
+        size = STORE_REC_SIZE(rec[2]);
+        if (pos + size > STORE_PAGE_SIZE) break;
+
+        Flash_Read(addr + pos + STORE_REC_HDR_SIZE, rec + STORE_REC_HDR_SIZE, size - STORE_REC_HDR_SIZE);
+        crc = ~Store_CRC(0xFFFFFFFF, rec, STORE_REC_HDR_SIZE + rec[2]);
+        if (rec[size - 4] == (uint8_t) crc && rec[size - 3] == (uint8_t) (crc >> 8)
+                && rec[size - 2] == (uint8_t) (crc >> 16) && rec[size - 1] == (uint8_t) (crc >> 24)) {
+            if ((rec[0] & STORE_REC_STATE) && (s = Store_Remember(rec[0], rec[1], rec + STORE_REC_HDR_SIZE, rec[2])) != 0) {
+                s->in_active = active;
+            }
+            if (handler != 0) handler(rec[0], rec[1], rec + STORE_REC_HDR_SIZE, rec[2]);
+        }
+        pos += size;
+    }
+
+    LOG_WARN("Store: page %u damaged at %lu", page, (unsigned long) pos);
+    return STORE_PAGE_SIZE;
+}
+
+/**
+ * @brief  Erases the next page, makes it the active one and copies every
+ *         state into it.
+ * @param  None
+ * @retval 0 on success, -1 if the flash failed.
+ */
+static int8_t Store_NextPage(void)
+{
+    uint8_t rec[STORE_REC_MAX];
+    uint32_t hdr[3];
+    uint8_t page = (store_page < 0) ? 0 : (uint8_t) ((store_page + 1) % STORE_PAGE_NUM);
+    uint32_t addr = STORE_PAGE_ADDR(page);
+    uint32_t pos = STORE_PAGE_HDR_SIZE;
+    uint16_t size;
+    uint8_t i;
+
+    if (Flash_EraseBlock(addr) < 0) return -1;
+    METRICS_ADD(METRICS_FLASH_ERASES, 1);
+
+    hdr[0] = STORE_MAGIC;
+    hdr[1] = store_seq + 1;
+    hdr[2] = STORE_MAGIC ^ ~hdr[1];
+    if (Flash_Program(addr, hdr, sizeof(hdr)) < 0) return -1;
+
+    store_page = (int8_t) page;
+    store_seq++;
+
+    for (i = 0; i < store_state_num; i++) {
+        size = Store_Encode(rec, store_state[i].type, store_state[i].key, store_state[i].data, store_state[i].len);
+        if (Flash_Program(addr + pos, rec, size) < 0) return -1;
+        pos += size;
+    }
+    store_pos = pos;
+    return 0;
+}
+
+/**
+ * @brief  Scans the store and restores its records.
+ * @note   Called once at boot, before the main loop.
+ * @param  handler: Called for every valid record, oldest first.
+ * @retval None
+ */
+void Store_Init(Store_Handler handler)
+{
+    uint32_t seq[STORE_PAGE_NUM];
+    uint8_t order[STORE_PAGE_NUM];
+    uint32_t hdr[3];
+    uint32_t used = 0;
+    uint8_t count = 0;
+    uint8_t page;
+    uint8_t i;
+    uint8_t j;
+
+    store_page = -1;
+    store_seq = 0;
+    store_pos = STORE_PAGE_SIZE;
+    store_queue_len = 0;
+    store_state_num = 0;
+
+    /* Valid pages, ordered by sequence number */
+    for (page = 0; page < STORE_PAGE_NUM; page++) {
+        Flash_Read(STORE_PAGE_ADDR(page), hdr, sizeof(hdr));
+        if (hdr[0] != STORE_MAGIC || hdr[2] != (STORE_MAGIC ^ ~hdr[1])) continue;
+
+        for (j = count; j > 0 && seq[j - 1] > hdr[1]; j--) {
+            seq[j] = seq[j - 1];
+            order[j] = order[j - 1];
+        }
+        seq[j] = hdr[1];
+        order[j] = page;
+        count++;
+    }
+
+    for (i = 0; i < count; i++) {
+        store_pos = Store_ScanPage(order[i], handler, i == count - 1);
+        used += store_pos;
+    }
+    if (count > 0) {
+        store_page = (int8_t) order[count - 1];
+        store_seq = seq[count - 1];
+    }
+
+    /* States whose copies in the active page were cut short */
+    for (i = 0; i < store_state_num; i++) {
+        if (!store_state[i].in_active) Store_Enqueue(store_state[i].type, store_state[i].key, store_state[i].data, store_state[i].len);
+    }
+
+    LOG_INFO("Store: %u pages, %u states, %lu bytes", count, store_state_num, (unsigned long) used);
+}
+
+/**
+ * @brief  Queues a record to be written.
+ * @note   A state record replaces the state of its type and key at once,
+ *         also for the copies made when a page is started.
+ * @param  type: One of STORE_REC_*.
+ * @param  key: Key of the record within its type.
+ * @param  data: Payload.
+ * @param  len: Length of the payload, at most STORE_DATA_MAX.
+ * @retval 0 on success, -1 if the record is invalid or the queue is full.
+ */
+int8_t Store_Write(uint8_t type, uint8_t key, const void* data, uint8_t len)
+{
+    if (type == 0xFF || len > STORE_DATA_MAX) return -1;
+    if ((type & STORE_REC_STATE) && Store_Remember(type, key, (const uint8_t*) data, len) == 0) return -1;
+
+    if (Store_Enqueue(type, key, data, len) < 0) {
+        LOG_WARN("Store: queue full, record %02X dropped", type);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief  Programs the queued records once they have waited long enough.
+ * @note   Called from the main loop every second.
+ * @param  None
+ * @retval None
+ */
+void Store_Run(void)
+{
+    if (store_queue_len == 0) return;
+
+    if (store_queue_len >= STORE_QUEUE_SIZE / 2 || TICK_REACHED(Tick_GetMs(), store_queue_since + STORE_FLUSH_MS)) {
+        if (Store_Sync() < 0) LOG_WARN("Store: flash write failed");
+    }
+}
+
+/**
+ * @brief  Programs every queued record now.
+ * @note   As many records as fit in the active page go out in one IAP call.
+ * @param  None
+ * @retval 0 on success, -1 if the flash failed; the records not written
+ *         stay queued.
+ */
+int8_t Store_Sync(void)
+{
+    uint16_t n;
+    uint16_t size;
+    uint16_t records;
+
+    while (store_queue_len > 0) {
+        if (store_page < 0 || store_pos + STORE_REC_SIZE(store_queue[2]) > STORE_PAGE_SIZE) {
+            if (Store_NextPage() < 0) return -1;
+            continue;
+        }
+
+        n = 0;
+        records = 0;
+        while (n < store_queue_len) {
+            size = STORE_REC_SIZE(store_queue[n + 2]);
+            if (store_pos + n + size > STORE_PAGE_SIZE) break;
+            n += size;
+            records++;
+        }
+
+        if (Flash_Program(STORE_PAGE_ADDR(store_page) + store_pos, store_queue, n) < 0) return -1;
+        METRICS_ADD(METRICS_FLASH_RECORDS, records);
+
+        store_pos += n;
+        store_queue_len -= n;
+        memmove(store_queue, store_queue + n, store_queue_len);
+    }
+    return 0;
+}
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
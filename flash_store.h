@@ -0,0 +1,71 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/flash_store.h
+ * @author  WIZnet
+ * @brief   Header for flash_store.c module
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FLASH_STORE_H
+#define __FLASH_STORE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "flash_if.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Flash the store takes, STORE_PAGE_NUM blocks at the top of the code
+ * flash; the linker script must end the code before STORE_BASE */
+#ifndef STORE_PAGE_NUM
+#define STORE_PAGE_NUM 4
+#endif
+#define STORE_PAGE_SIZE FLASH_BLOCK_SIZE
+#ifndef STORE_BASE
+#define STORE_BASE (FLASH_SIZE - STORE_PAGE_NUM * STORE_PAGE_SIZE)
+#endif
+
+/* Longest record payload */
+#define STORE_DATA_MAX 32
+
+/* RAM queue of records waiting to be programmed, encoded */
+#ifndef STORE_QUEUE_SIZE
+#define STORE_QUEUE_SIZE 256
+#endif
+
+/* Time a record may wait in the queue before Store_Run() programs it */
+#ifndef STORE_FLUSH_MS
+#define STORE_FLUSH_MS 10000
+#endif
+
+/* State records: only the latest record of a type and key counts, and it
+ * is carried over to every new page. Other records form a log that loses
+ * its oldest entries as pages are reused. */
+#define STORE_REC_STATE         0x80
+
+/* Record types */
+#define STORE_REC_ROLLUP        0x01                        /* key: tier */
+#define STORE_REC_LEASE         (STORE_REC_STATE | 0x01)    /* key: 0 */
+#define STORE_REC_CALIBRATION   (STORE_REC_STATE | 0x02)    /* key: channel */
+
+/* Most state records, types and keys together, kept in RAM */
+#ifndef STORE_STATE_NUM
+#define STORE_STATE_NUM 8
+#endif
+
+/* SRAM of the queue, the state cache and the write position */
+#define STORE_RAM_SIZE (STORE_QUEUE_SIZE + STORE_STATE_NUM * (4 + STORE_DATA_MAX) + 24)
+
+/* Exported types ------------------------------------------------------------*/
+/* Called at boot for every valid record, oldest first */
+typedef void (*Store_Handler)(uint8_t type, uint8_t key, const uint8_t* data, uint8_t len);
+
+/* Exported functions ------------------------------------------------------- */
+void Store_Init(Store_Handler handler);
+int8_t Store_Write(uint8_t type, uint8_t key, const void* data, uint8_t len);
+void Store_Run(void);
+int8_t Store_Sync(void);
+
+#endif /* __FLASH_STORE_H */
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
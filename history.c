@@ -0,0 +1,439 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/history.c
+ * @author  WIZnet
+ * @brief   Fixed-size, multi-resolution history of the sampled readings
+ ******************************************************************************
+ * @attention
+ *
+ * Three rings of fixed length keep the recent past at decreasing resolution:
+ *   raw     the latest scan of every HISTORY_RAW_PERIOD_MS
+ *   minute  min/max/avg of every scan in each minute
+ *   hour    min/max/avg of every scan in each hour
+ * History_Update() feeds every new snapshot into the open period of each
+ * tier and closes periods as time passes, so no tier is ever recomputed.
+ * Periods are counted from the first scan; a period that saw no scan is
+ * stored with every field set to HISTORY_NO_DATA.
+ *
+ * Entries are numbered per tier from 0 at boot. A reader asks for the
+ * entries from a given number on and learns the number to ask for next, so
+ * a client only fetches what it has not seen yet.
+ *
+ * Every hour that saw a scan is also written to the flash store as it
+ * closes. At boot History_Restore() puts the stored hours back in front of
+ * the new ones, numbered on from where the node stopped, as if it had
+ * never been off; their timestamps lie before boot and so are negative.
+ *
+ * With the default sizes the rings take
+ *   180 * 8 + 60 * 24 + 24 * 24 = 3456 bytes of RAM.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "history.h"
+#include "flash_store.h"
+#include "tick.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+    uint16_t min[SAMPLER_CH_NUM];
+    uint16_t max[SAMPLER_CH_NUM];
+    uint16_t avg[SAMPLER_CH_NUM];
+} History_Rollup;
+
+typedef struct
+{
+    uint32_t period_ms;
+    uint16_t len;
+    uint32_t start;                     /* Tick at which the open period began */
+    uint32_t open;                      /* Number of the open period */
+    uint32_t n;                         /* Scans in the open period */
+    uint16_t last[SAMPLER_CH_NUM];
+    uint16_t min[SAMPLER_CH_NUM];
+    uint16_t max[SAMPLER_CH_NUM];
+    uint32_t sum[SAMPLER_CH_NUM];
+} History_Tier;
+
+/* Private define ------------------------------------------------------------*/
+#define HISTORY_MINUTE_MS 60000u
+#define HISTORY_HOUR_MS   3600000u
+
+/* Longest row, a rollup in CSV: "-2147483648" and 3 * SAMPLER_CH_NUM fields */
+#define HISTORY_ROW_MAX (11 + 3 * SAMPLER_CH_NUM * 6 + 1)
+
+/* Stored hour: entry number and the rollup, 3 fields per channel */
+#define HISTORY_STORE_SIZE (4 + 3 * SAMPLER_CH_NUM * 2)
+
+#if HISTORY_STORE_SIZE > STORE_DATA_MAX
+#error "HISTORY: SAMPLER_CH_NUM too high for a stored rollup"
+#endif
+
+/* The per-channel sums of an hour must not overflow */
+#if (SAMPLER_RATE_HZ * 3600ull * 4095ull) > 0xFFFFFFFFull
+#error "HISTORY: SAMPLER_RATE_HZ too high for the hourly sums"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static uint16_t history_raw[HISTORY_RAW_LEN][SAMPLER_CH_NUM];
+static History_Rollup history_minute[HISTORY_MINUTE_LEN];
+static History_Rollup history_hour[HISTORY_HOUR_LEN];
+
+static History_Tier history_tier[HISTORY_TIER_NUM];
+static uint32_t history_seq;
+
+/* Fails to compile if HISTORY_RAM_SIZE no longer covers the state above */
+typedef char history_ram_check[(sizeof(history_raw) + sizeof(history_minute) + sizeof(history_hour)
+        + sizeof(history_tier) + sizeof(history_seq) <= HISTORY_RAM_SIZE) ? 1 : -1];
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Queues a closed hour for the flash store.
+ * @param  index: Entry number.
+ * @param  r: Rollup of the hour.
+ * @retval None
+ */
+static void History_Store(uint32_t index, const History_Rollup* r)
+{
+    uint8_t data[HISTORY_STORE_SIZE];
+
+    data[0] = (uint8_t) index;
+    data[1] = (uint8_t) (index >> 8);
+    data[2] = (uint8_t) (index >> 16);
+    data[3] = (uint8_t) (index >> 24);
+    memcpy(data + 4, r, sizeof(History_Rollup));
+    Store_Write(STORE_REC_ROLLUP, HISTORY_TIER_HOUR, data, sizeof(data));
+}
+
+/**
+ * @brief  Stores the open period of a tier and opens the next one.
+ * @param  t: Tier.
+ * @param  tier: Tier number.
+ * @retval None
+ */
+static void History_Close(History_Tier* t, uint8_t tier)
+{
+    uint16_t slot = (uint16_t) (t->open % t->len);
+    History_Rollup* r;
+    uint8_t ch;
+
+    if (tier == HISTORY_TIER_RAW) {
+        for (ch = 0; ch < SAMPLER_CH_NUM; ch++) {
+            history_raw[slot][ch] = t->n ? t->last[ch] : HISTORY_NO_DATA;
+        }
+    }
+    else {
+        r = (tier == HISTORY_TIER_MINUTE) ? &history_minute[slot] : &history_hour[slot];
+        for (ch = 0; ch < SAMPLER_CH_NUM; ch++) {
+            r->min[ch] = t->n ? t->min[ch] : HISTORY_NO_DATA;
+            r->max[ch] = t->n ? t->max[ch] : HISTORY_NO_DATA;
+            r->avg[ch] = t->n ? (uint16_t) ((t->sum[ch] + t->n / 2) / t->n) : HISTORY_NO_DATA;
+        }
+        if (tier == HISTORY_TIER_HOUR && t->n) History_Store(t->open, r);
+    }
+
+    t->open++;
+    t->start += t->period_ms;
+    t->n = 0;
+}
+
+/**
+ * @brief  Closes every period of a tier that ended before a scan.
+ * @note   After a gap longer than the ring only the last ring's worth of
+ *         empty periods is written.
+ * @param  t: Tier.
+ * @param  tier: Tier number.
+ * @param  now: Tick of the scan.
+ * @retval None
+ */
+static void History_Advance(History_Tier* t, uint8_t tier, uint32_t now)
+{
+    uint32_t periods;
+    uint32_t skip;
+
+    if (!TICK_REACHED(now, t->start + t->period_ms)) return;
+
+    periods = (now - t->start) / t->period_ms;
+    History_Close(t, tier);
+    periods--;
+
+    if (periods > t->len) {
+        skip = periods - t->len;
+        t->open += skip;
+        t->start += skip * t->period_ms;
+        periods = t->len;
+    }
+    while (periods--) {
+        History_Close(t, tier);
+    }
+}
+
+/**
+ * @brief  Adds a scan to the open period of a tier.
+ * @param  t: Tier.
+ * @param  value: ADC counts of every channel.
+ * @retval None
+ */
+static void History_Accumulate(History_Tier* t, const uint16_t* value)
+{
+    uint8_t ch;
+
+    for (ch = 0; ch < SAMPLER_CH_NUM; ch++) {
+        if (t->n == 0 || value[ch] < t->min[ch]) t->min[ch] = value[ch];
+        if (t->n == 0 || value[ch] > t->max[ch]) t->max[ch] = value[ch];
+        t->sum[ch] = (t->n == 0) ? value[ch] : t->sum[ch] + value[ch];
+        t->last[ch] = value[ch];
+    }
+    t->n++;
+}
+
+/**
+ * @brief  Renders one entry as a CSV line or a binary record.
+ * @param  cur: Read cursor.
+ * @param  index: Entry number.
+ * @param  out: Output buffer, at least HISTORY_ROW_MAX bytes.
+ * @retval Length of the row.
+ */
+static uint16_t History_Row(const History_Cursor* cur, uint32_t index, uint8_t* out)
+{
+    const History_Tier* t = &history_tier[cur->tier];
+    uint16_t slot = (uint16_t) (index % t->len);
+    uint32_t ts = t->start - (t->open - index) * t->period_ms;
+    const uint16_t* field[3];
+    uint8_t nfield;
+    uint8_t ch;
+    uint8_t f;
+    uint16_t len;
+
+    if (cur->tier == HISTORY_TIER_RAW) {
+        field[0] = history_raw[slot];
+        nfield = 1;
+    }
+    else {
+        const History_Rollup* r = (cur->tier == HISTORY_TIER_MINUTE) ? &history_minute[slot] : &history_hour[slot];
+        field[0] = r->min;
+        field[1] = r->max;
+        field[2] = r->avg;
+        nfield = 3;
+    }
+
+    if (cur->fmt == HISTORY_FMT_BIN) {
+        len = 0;
+        for (ch = 0; ch < SAMPLER_CH_NUM; ch++) {
+            for (f = 0; f < nfield; f++) {
+                out[len++] = (uint8_t) field[f][ch];
+                out[len++] = (uint8_t) (field[f][ch] >> 8);
+            }
+        }
+        return len;
+    }
+
+    len = (uint16_t) sprintf((char*) out, "%ld", (long) (int32_t) ts);
+    for (ch = 0; ch < SAMPLER_CH_NUM; ch++) {
+        for (f = 0; f < nfield; f++) {
+            out[len++] = ',';
+            if (field[f][ch] != HISTORY_NO_DATA) len += (uint16_t) sprintf((char*) out + len, "%u", field[f][ch]);
+        }
+    }
+    out[len++] = '\n';
+    return len;
+}
+
+/**
+ * @brief  Renders the CSV column header or the binary record header.
+ * @param  cur: Read cursor.
+ * @param  out: Output buffer, at least HISTORY_ROW_MAX bytes.
+ * @retval Length of the header.
+ */
+static uint16_t History_Header(const History_Cursor* cur, uint8_t* out)
+{
+    const History_Tier* t = &history_tier[cur->tier];
+    uint8_t nfield = (cur->tier == HISTORY_TIER_RAW) ? 1 : 3;
+    uint32_t count = cur->end - cur->index;
+    uint32_t ts = t->start - (t->open - cur->index) * t->period_ms;
+    uint16_t len;
+    uint8_t ch;
+
+    if (cur->fmt == HISTORY_FMT_BIN) {
+        out[0] = 'S';
+        out[1] = 'H';
+        out[2] = HISTORY_BIN_VERSION;
+        out[3] = cur->tier;
+        out[4] = SAMPLER_CH_NUM;
+        out[5] = nfield;
+        out[6] = (uint8_t) count;
+        out[7] = (uint8_t) (count >> 8);
+        out[8] = (uint8_t) cur->index;
+        out[9] = (uint8_t) (cur->index >> 8);
+        out[10] = (uint8_t) (cur->index >> 16);
+        out[11] = (uint8_t) (cur->index >> 24);
+        out[12] = (uint8_t) ts;
+        out[13] = (uint8_t) (ts >> 8);
+        out[14] = (uint8_t) (ts >> 16);
+        out[15] = (uint8_t) (ts >> 24);
+        out[16] = (uint8_t) t->period_ms;
+        out[17] = (uint8_t) (t->period_ms >> 8);
+        out[18] = (uint8_t) (t->period_ms >> 16);
+        out[19] = (uint8_t) (t->period_ms >> 24);
+        return HISTORY_BIN_HDR_SIZE;
+    }
+
+    len = (uint16_t) sprintf((char*) out, "ts");
+    for (ch = 0; ch < SAMPLER_CH_NUM; ch++) {
+        if (nfield == 1) len += (uint16_t) sprintf((char*) out + len, ",ch%u", ch);
+        else len += (uint16_t) sprintf((char*) out + len, ",min%u,max%u,avg%u", ch, ch, ch);
+    }
+    out[len++] = '\n';
+    return len;
+}
+
+/**
+ * @brief  Clears the history.
+ * @param  None
+ * @retval None
+ */
+void History_Init(void)
+{
+    memset(history_tier, 0, sizeof(history_tier));
+    history_tier[HISTORY_TIER_RAW].period_ms = HISTORY_RAW_PERIOD_MS;
+    history_tier[HISTORY_TIER_RAW].len = HISTORY_RAW_LEN;
+    history_tier[HISTORY_TIER_MINUTE].period_ms = HISTORY_MINUTE_MS;
+    history_tier[HISTORY_TIER_MINUTE].len = HISTORY_MINUTE_LEN;
+    history_tier[HISTORY_TIER_HOUR].period_ms = HISTORY_HOUR_MS;
+    history_tier[HISTORY_TIER_HOUR].len = HISTORY_HOUR_LEN;
+    history_seq = 0;
+}
+
+/**
+ * @brief  Puts an hour read back from the flash store into the history.
+ * @note   Called at boot, before the first scan, with the stored hours in
+ *         the order they were written; hours that never saw a scan come
+ *         back as empty entries.
+ * @param  data: Entry number and rollup as queued by History_Store().
+ * @param  len: Length of the data.
+ * @retval None
+ */
+void History_Restore(const uint8_t* data, uint8_t len)
+{
+    History_Tier* t = &history_tier[HISTORY_TIER_HOUR];
+    History_Rollup* r;
+    uint32_t index;
+
+    if (len != HISTORY_STORE_SIZE || history_seq != 0) return;
+
+    index = data[0] | ((uint32_t) data[1] << 8) | ((uint32_t) data[2] << 16) | ((uint32_t) data[3] << 24);
+    if (index < t->open) return;
+
+    if (index - t->open > t->len) t->open = index - t->len;
+    while (t->open < index) {
+        memset(&history_hour[t->open % t->len], 0xFF, sizeof(History_Rollup));
+        t->open++;
+    }
+
+    r = &history_hour[index % t->len];
+    memcpy(r, data + 4, sizeof(History_Rollup));
+    t->open = index + 1;
+}
+
+/**
+ * @brief  Feeds the latest sample snapshot into every tier.
+ * @note   Called from the main loop; does nothing until the sampler has
+ *         published a new scan.
+ * @param  None
+ * @retval None
+ */
+void History_Update(void)
+{
+    Sampler_Snapshot snap;
+    uint8_t tier;
+
+    if (Sampler_GetSeq() == history_seq) return;
+
+    Sampler_Read(&snap);
+    for (tier = 0; tier < HISTORY_TIER_NUM; tier++) {
+        if (history_seq == 0) history_tier[tier].start = snap.tick;
+        History_Advance(&history_tier[tier], tier, snap.tick);
+        History_Accumulate(&history_tier[tier], snap.value);
+    }
+    history_seq = snap.seq;
+}
+
+/**
+ * @brief  Positions a cursor on the stored entries of a tier.
+ * @note   A cursor past the newest entry, as kept by a client across a
+ *         reboot of the node, starts over from the oldest entry.
+ * @param  cur: Cursor to set up; cur->end is the cursor for the next read.
+ * @param  tier: One of HISTORY_TIER_*.
+ * @param  fmt: One of HISTORY_FMT_*.
+ * @param  since: First entry wanted.
+ * @retval None
+ */
+void History_Open(History_Cursor* cur, uint8_t tier, uint8_t fmt, uint32_t since)
+{
+    const History_Tier* t = &history_tier[tier];
+    uint32_t oldest = (t->open > t->len) ? t->open - t->len : 0;
+
+    cur->tier = tier;
+    cur->fmt = fmt;
+    cur->started = 0;
+    cur->end = t->open;
+    cur->index = (since < oldest || since > t->open) ? oldest : since;
+}
+
+/**
+ * @brief  Renders as many whole rows as fit, starting at the cursor.
+ * @note   A document read slower than its tier fills up loses its oldest
+ *         rows; nothing is rendered once the next row has been overwritten.
+ * @param  cur: Read cursor, advanced past the rows rendered.
+ * @param  out: Output buffer.
+ * @param  size: Size of the output buffer, at least HISTORY_ROW_MAX.
+ * @retval Number of bytes rendered, 0 when the cursor is at its end or its
+ *         next row is gone.
+ */
+uint16_t History_Read(History_Cursor* cur, uint8_t* out, uint16_t size)
+{
+    const History_Tier* t = &history_tier[cur->tier];
+    uint8_t row[HISTORY_ROW_MAX];
+    uint16_t len = 0;
+    uint16_t n;
+
+    if (cur->index < cur->end && t->open - cur->index > t->len) return 0;
+
+    if (!cur->started) {
+        len = History_Header(cur, out);
+        cur->started = 1;
+    }
+
+    while (cur->index < cur->end) {
+        n = History_Row(cur, cur->index, row);
+        if (len + n > size) break;
+        memcpy(out + len, row, n);
+        len += n;
+        cur->index++;
+    }
+    return len;
+}
+
+/**
+ * @brief  Returns the number of bytes History_Read() will render from a
+ *         freshly opened cursor.
+ * @param  cur: Read cursor.
+ * @retval Length of the whole document.
+ */
+uint32_t History_Length(const History_Cursor* cur)
+{
+    uint8_t row[HISTORY_ROW_MAX];
+    uint32_t len = History_Header(cur, row);
+    uint32_t index;
+
+    for (index = cur->index; index < cur->end; index++) {
+        len += History_Row(cur, index, row);
+    }
+    return len;
+}
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
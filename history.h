@@ -0,0 +1,79 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/history.h
+ * @author  WIZnet
+ * @brief   Header for history.c module
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __HISTORY_H
+#define __HISTORY_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "adc_sampler.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Tiers, finest first */
+#define HISTORY_TIER_RAW    0
+#define HISTORY_TIER_MINUTE 1
+#define HISTORY_TIER_HOUR   2
+#define HISTORY_TIER_NUM    3
+
+/* Output formats */
+#define HISTORY_FMT_CSV 0
+#define HISTORY_FMT_BIN 1
+
+/* Marks a period without any scan in every field of its entry */
+#define HISTORY_NO_DATA 0xFFFF
+
+/* Raw tier: the latest scan once per period */
+#ifndef HISTORY_RAW_PERIOD_MS
+#define HISTORY_RAW_PERIOD_MS 1000
+#endif
+#ifndef HISTORY_RAW_LEN
+#define HISTORY_RAW_LEN 180
+#endif
+
+/* Minute tier: min/max/avg of every scan in the minute */
+#ifndef HISTORY_MINUTE_LEN
+#define HISTORY_MINUTE_LEN 60
+#endif
+
+/* Hour tier: min/max/avg of every scan in the hour */
+#ifndef HISTORY_HOUR_LEN
+#define HISTORY_HOUR_LEN 24
+#endif
+
+/* SRAM of the rings, the open period of every tier and the sequence
+ * number, checked against the arrays in history.c */
+#define HISTORY_RAM_SIZE (2 * SAMPLER_CH_NUM * (HISTORY_RAW_LEN + 3 * (HISTORY_MINUTE_LEN + HISTORY_HOUR_LEN)) \
+                          + HISTORY_TIER_NUM * (20 + 10 * SAMPLER_CH_NUM) + 4)
+
+/* Version of the /history.bin layout */
+#define HISTORY_BIN_VERSION 1
+#define HISTORY_BIN_HDR_SIZE 20
+
+/* Exported types ------------------------------------------------------------*/
+/* Read position in one tier; entries are numbered from 0 at boot */
+typedef struct
+{
+    uint8_t tier;
+    uint8_t fmt;
+    uint8_t started;        /* Column header (CSV) or record header (binary) sent */
+    uint32_t index;         /* Next entry to read */
+    uint32_t end;           /* One past the last entry to read */
+} History_Cursor;
+
+/* Exported functions ------------------------------------------------------- */
+void History_Init(void);
+void History_Restore(const uint8_t* data, uint8_t len);
+void History_Update(void);
+void History_Open(History_Cursor* cur, uint8_t tier, uint8_t fmt, uint32_t since);
+uint16_t History_Read(History_Cursor* cur, uint8_t* out, uint16_t size);
+uint32_t History_Length(const History_Cursor* cur);
+
+#endif /* __HISTORY_H */
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
@@ -0,0 +1,209 @@
+/**
+ ******************************************************************************
+ * @file    host/conn_check.c
+ * @author  WIZnet
+ * @brief   Host-side check of how the HTTP sockets hand over from one client
+ *          to the next, on the in-memory sockets.
+ ******************************************************************************
+ * @attention
+ *
+ * Usage: conn_check
+ *
+ * Each check first has a client A leave a socket in some state, then has a
+ * client B connect to the same socket, send its request and close its side
+ * before the firmware runs again, so the socket is first seen in CLOSE_WAIT.
+ * B must get the reply to its own request:
+ *   - after A's request asked for the connection to be closed;
+ *   - after A left a kept-alive connection;
+ *   - after A left an /events stream.
+ * It exits with status 1 on the first check that fails.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <unistd.h>
+#include "main.h"
+#include "w7500_host.h"
+#include "w7500_sim.h"
+#include "web_server.h"
+#include "adc_sampler.h"
+
+/* Private define ------------------------------------------------------------*/
+#define CHECK_SOCK     HTTP_SOCK_START
+#define CHECK_MAX_POLL 64
+#define CHECK_RX_SIZE  8192
+
+/* Private variables ---------------------------------------------------------*/
+static const uint8_t check_peer_a[4] = { 192, 168, 0, 100 };
+static const uint8_t check_peer_b[4] = { 192, 168, 0, 101 };
+
+static char check_rx[CHECK_RX_SIZE];
+static uint32_t check_rx_len;
+static unsigned check_passed;
+static FILE* check_out;
+
+/* Private functions ---------------------------------------------------------*/
+
+static void check_on_send(uint8_t sn, const uint8_t* buf, uint16_t len)
+{
+    if (sn != CHECK_SOCK) return;
+    if (len > sizeof(check_rx) - 1 - check_rx_len) len = (uint16_t) (sizeof(check_rx) - 1 - check_rx_len);
+    memcpy(check_rx + check_rx_len, buf, len);
+    check_rx_len += len;
+    check_rx[check_rx_len] = '\0';
+}
+
+static int check_wait_state(uint8_t state)
+{
+    int i;
+
+    for (i = 0; i < CHECK_MAX_POLL; i++) {
+        if (getSn_SR(CHECK_SOCK) == state) return 0;
+        WebServer_Run();
+        Sim_AdvanceMs(1);
+    }
+    return getSn_SR(CHECK_SOCK) == state ? 0 : -1;
+}
+
+static void check_run_ms(uint32_t ms)
+{
+    while (ms--) {
+        WebServer_Run();
+        Sim_AdvanceMs(1);
+    }
+}
+
+static void check_feed(const char* path, const char* connection)
+{
+    char req[256];
+    int len;
+
+    len = snprintf(req, sizeof(req), "GET %s HTTP/1.1\r\n"
+            "Host: 192.168.0.10\r\n"
+            "Connection: %s\r\n"
+            "\r\n", path, connection);
+    Sim_Feed(CHECK_SOCK, req, (uint16_t) len);
+}
+
+static int check_status(const char* what, const char* want)
+{
+    if (strncmp(check_rx, want, strlen(want)) != 0) {
+        fprintf(check_out, "%s: got \"%.*s\", expected \"%s\"\n", what,
+                (int) strcspn(check_rx, "\r\n"), check_rx, want);
+        return -1;
+    }
+    check_passed++;
+    return 0;
+}
+
+/**
+  * @brief  Runs client B: connect, request and FIN within one pass.
+  * @param  what: Name of the check.
+  * @retval 0 when B gets its own 404 and the socket listens again, -1 if not
+  */
+static int check_client_b(const char* what)
+{
+    check_rx_len = 0;
+    check_rx[0] = '\0';
+
+    Sim_Connect(CHECK_SOCK, check_peer_b, 40001);
+    check_feed("/nope", "close");
+    Sim_PeerClose(CHECK_SOCK);
+
+    if (check_wait_state(SOCK_LISTEN) < 0) {
+        fprintf(check_out, "%s: socket did not listen again\n", what);
+        return -1;
+    }
+    return check_status(what, "HTTP/1.1 404");
+}
+
+static int check_after_close(void)
+{
+    if (check_wait_state(SOCK_LISTEN) < 0) return -1;
+    check_rx_len = 0;
+    check_rx[0] = '\0';
+    Sim_Connect(CHECK_SOCK, check_peer_a, 40000);
+    check_feed("/api/moisture", "close");
+    if (check_wait_state(SOCK_LISTEN) < 0) {
+        fprintf(check_out, "close: client A was not disconnected\n");
+        return -1;
+    }
+    if (check_status("close: client A", "HTTP/1.1 200") < 0) return -1;
+
+    return check_client_b("close: client B");
+}
+
+static int check_after_keepalive(void)
+{
+    if (check_wait_state(SOCK_LISTEN) < 0) return -1;
+    check_rx_len = 0;
+    check_rx[0] = '\0';
+    Sim_Connect(CHECK_SOCK, check_peer_a, 40000);
+    check_feed("/api/moisture", "keep-alive");
+    WebServer_Run();
+    if (check_status("keep-alive: client A", "HTTP/1.1 200") < 0) return -1;
+    Sim_PeerClose(CHECK_SOCK);
+    if (check_wait_state(SOCK_LISTEN) < 0) {
+        fprintf(check_out, "keep-alive: client A was not disconnected\n");
+        return -1;
+    }
+
+    return check_client_b("keep-alive: client B");
+}
+
+static int check_after_stream(void)
+{
+    if (check_wait_state(SOCK_LISTEN) < 0) return -1;
+    check_rx_len = 0;
+    check_rx[0] = '\0';
+    Sim_Connect(CHECK_SOCK, check_peer_a, 40000);
+    check_feed("/events", "keep-alive");
+    WebServer_Run();
+    if (check_status("events: client A", "HTTP/1.1 200") < 0) return -1;
+
+    /* Let a few events go out before the client leaves */
+    check_run_ms(3000);
+    if (strstr(check_rx, "data: ") == NULL) {
+        fprintf(check_out, "events: client A got no event\n");
+        return -1;
+    }
+    Sim_PeerClose(CHECK_SOCK);
+    if (check_wait_state(SOCK_LISTEN) < 0) {
+        fprintf(check_out, "events: client A was not disconnected\n");
+        return -1;
+    }
+
+    return check_client_b("events: client B");
+}
+
+int main(int argc, char** argv)
+{
+    int out_fd;
+
+    (void) argc;
+    (void) argv;
+
+    /* The firmware logs every request to stdout; keep the report separate. */
+    fflush(stdout);
+    out_fd = dup(STDOUT_FILENO);
+    check_out = fdopen(out_fd, "w");
+    freopen("/dev/null", "w", stdout);
+
+    Sim_Reset();
+    Sim_SetSendHook(check_on_send);
+    Sampler_Init();
+    DUALTIMER_Init(DUALTIMER0_0, &(DUALTIMER_InitTypDef) { .Timer_Load = GetSystemClock() / SAMPLER_RATE_HZ });
+    DUALTIMER_Cmd(DUALTIMER0_0, ENABLE);
+    WebServer_Init();
+    Sim_AdvanceMs(1000);
+
+    if (check_after_close() < 0) return 1;
+    if (check_after_keepalive() < 0) return 1;
+    if (check_after_stream() < 0) return 1;
+
+    fprintf(check_out, "checks       : %u passed\n", check_passed);
+    fclose(check_out);
+    return 0;
+}
@@ -0,0 +1,35 @@
+/**
+ ******************************************************************************
+ * @file    host/dhcp.h
+ * @author  WIZnet
+ * @brief   Host (Linux) stand-in for the ioLibrary DHCP client.
+ ******************************************************************************
+ */
+
+#ifndef __HOST_DHCP_H
+#define __HOST_DHCP_H
+
+#include <stdint.h>
+
+enum
+{
+    DHCP_FAILED = 0,
+    DHCP_RUNNING,
+    DHCP_IP_ASSIGN,
+    DHCP_IP_CHANGED,
+    DHCP_IP_LEASED,
+    DHCP_STOPPED
+};
+
+void DHCP_init(uint8_t s, uint8_t* buf);
+void reg_dhcp_cbfunc(void (*ip_assign)(void), void (*ip_update)(void), void (*ip_conflict)(void));
+uint8_t DHCP_run(void);
+void DHCP_stop(void);
+void DHCP_time_handler(void);
+void getIPfromDHCP(uint8_t* ip);
+void getGWfromDHCP(uint8_t* ip);
+void getSNfromDHCP(uint8_t* ip);
+void getDNSfromDHCP(uint8_t* ip);
+uint32_t getDHCPLeasetime(void);
+
+#endif /* __HOST_DHCP_H */
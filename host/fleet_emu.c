@@ -0,0 +1,413 @@
+/**
+ ******************************************************************************
+ * @file    host/fleet_emu.c
+ * @author  WIZnet
+ * @brief   Stand-in for a fleet of sensor nodes: one process answers the
+ *          node's reading endpoints for thousands of loopback addresses.
+ ******************************************************************************
+ * @attention
+ *
+ * Usage: fleet_emu [-N nodes] [-b first-address] [-p port] [-l latency-ms]
+ *                  [-x dead-percent]
+ *
+ * Node k is first-address + k (default 127.1.0.1) on the same port (default
+ * 8080), so a fleet of N emulated nodes looks like N boards to a scraper.
+ * One socket bound to the wildcard address takes every connection and the
+ * local address it arrived on tells which node was asked.
+ *
+ * Replies follow the firmware byte for byte in their framing: /api/moisture
+ * and /api/moisture.bin carry a reading that every node advances ten times
+ * a second, other paths get 404. A connection is closed after
+ * HTTP_KEEPALIVE_MAX requests or HTTP_KEEPALIVE_TIMEOUT_MS of idleness, as
+ * the board does. -l delays every reply, standing in for the board's
+ * service time; -x makes that share of nodes accept connections but never
+ * answer, so scrapers see timeouts.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include "web_server.h"
+#include "moisture.h"
+
+/* Private define ------------------------------------------------------------*/
+#define FE_BUF_SIZE     1024
+#define FE_OUT_SIZE     256
+#define FE_CHANNELS     4
+#define FE_SAMPLE_MS    100
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct FE_Conn
+{
+    int fd;
+    uint32_t node;
+    unsigned requests;
+    char buf[FE_BUF_SIZE];
+    size_t len;
+    char out[FE_OUT_SIZE];
+    size_t out_len;
+    uint8_t close;              /* Close once the reply is out */
+    int64_t due_us;             /* Reply held back until then, 0 if none */
+    int64_t last_us;            /* Last request */
+    struct FE_Conn* next;       /* Delay queue, in due order */
+    struct FE_Conn* next_all;
+    struct FE_Conn* prev_all;
+} FE_Conn;
+
+/* Private variables ---------------------------------------------------------*/
+static int fe_epfd;
+static uint32_t fe_first;       /* Host order */
+static uint32_t fe_nodes = 1000;
+static unsigned fe_latency_ms;
+static unsigned fe_dead_pct;
+static int64_t fe_start_us;
+
+static FE_Conn* fe_all;         /* Every open connection */
+static FE_Conn* fe_delay_head;
+static FE_Conn* fe_delay_tail;
+
+/* Private functions ---------------------------------------------------------*/
+
+static int64_t fe_now_us(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (int64_t) t.tv_sec * 1000000 + t.tv_nsec / 1000;
+}
+
+/* A fixed share of nodes, spread over the address range, is dead */
+static int fe_is_dead(uint32_t node)
+{
+    return (node * 37u) % 100u < fe_dead_pct;
+}
+
+/* The reading of a node: a slow wave per channel, offset per node, between
+ * the default wet and dry counts of the firmware */
+static void fe_reading(uint32_t node, uint32_t* seq, uint32_t* ts, uint16_t* value, uint16_t* moisture)
+{
+    uint32_t ms = (uint32_t) ((fe_now_us() - fe_start_us) / 1000);
+    uint32_t phase;
+    uint8_t ch;
+
+    *ts = ms;
+    *seq = ms / FE_SAMPLE_MS;
+    for (ch = 0; ch < FE_CHANNELS; ch++) {
+        phase = (ms / 16 + node * 97u + ch * 512u) % 3200u;
+        phase = phase < 1600 ? phase : 3199 - phase;
+        value[ch] = (uint16_t) (MOISTURE_WET_COUNTS + phase);
+        moisture[ch] = (uint16_t) ((MOISTURE_DRY_COUNTS - value[ch]) * MOISTURE_FULL / (MOISTURE_DRY_COUNTS - MOISTURE_WET_COUNTS));
+    }
+}
+
+static void fe_close(FE_Conn* c)
+{
+    FE_Conn* prev = NULL;
+    FE_Conn* p;
+
+    if (c->due_us != 0) {
+        for (p = fe_delay_head; p != NULL; prev = p, p = p->next) {
+            if (p != c) continue;
+            if (prev != NULL) prev->next = c->next;
+            else fe_delay_head = c->next;
+            if (fe_delay_tail == c) fe_delay_tail = prev;
+            break;
+        }
+    }
+
+    if (c->prev_all != NULL) c->prev_all->next_all = c->next_all;
+    else fe_all = c->next_all;
+    if (c->next_all != NULL) c->next_all->prev_all = c->prev_all;
+
+    close(c->fd);
+    free(c);
+}
+
+/* Sends the reply built for a connection. Returns 0 if it was closed. */
+static int fe_send(FE_Conn* c)
+{
+    ssize_t r;
+
+    /* Replies fit any socket buffer; a short write is a dead client */
+    r = send(c->fd, c->out, c->out_len, MSG_NOSIGNAL);
+    c->out_len = 0;
+    if (r < 0 || c->close) {
+        fe_close(c);
+        return 0;
+    }
+    return 1;
+}
+
+/* Builds the reply to the request at the start of the buffer and sends it,
+ * or queues it when replies are delayed. Returns 0 if the connection was
+ * closed. */
+static int fe_reply(FE_Conn* c, size_t req_len)
+{
+    char body[128];
+    uint8_t* b = (uint8_t*) body;
+    const char* type = NULL;
+    uint16_t value[FE_CHANNELS];
+    uint16_t moisture[FE_CHANNELS];
+    uint32_t seq;
+    uint32_t ts;
+    size_t body_len = 0;
+    uint8_t ch;
+    int n;
+
+    c->requests++;
+    c->close = c->requests >= HTTP_KEEPALIVE_MAX || strstr(c->buf, "Connection: close") != NULL;
+    fe_reading(c->node, &seq, &ts, value, moisture);
+
+    if (strncmp(c->buf, "GET /api/moisture.bin ", 22) == 0) {
+        type = "application/octet-stream";
+        *b++ = 'S';
+        *b++ = 'M';
+        *b++ = 2;
+        *b++ = FE_CHANNELS;
+        for (n = 0; n < 32; n += 8) *b++ = (uint8_t) (seq >> n);
+        for (n = 0; n < 32; n += 8) *b++ = (uint8_t) (ts >> n);
+        for (ch = 0; ch < FE_CHANNELS; ch++) {
+            *b++ = (uint8_t) value[ch];
+            *b++ = (uint8_t) (value[ch] >> 8);
+        }
+        for (ch = 0; ch < FE_CHANNELS; ch++) {
+            *b++ = (uint8_t) moisture[ch];
+            *b++ = (uint8_t) (moisture[ch] >> 8);
+        }
+        body_len = (size_t) (b - (uint8_t*) body);
+    }
+    else if (strncmp(c->buf, "GET /api/moisture ", 18) == 0) {
+        type = "application/json";
+        n = snprintf(body, sizeof(body), "{\"reading\":%u.%u,\"moisture\":[%u,%u,%u,%u],\"channels\":[%u,%u,%u,%u],\"ts\":%lu,\"seq\":%lu}",
+                moisture[0] / 10, moisture[0] % 10, moisture[0], moisture[1], moisture[2], moisture[3],
+                value[0], value[1], value[2], value[3], (unsigned long) ts, (unsigned long) seq);
+        body_len = (size_t) n;
+    }
+
+    if (type != NULL) {
+        n = snprintf(c->out, FE_OUT_SIZE, "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nCache-Control: no-cache\r\n%sContent-Length: %u\r\n\r\n",
+                type, c->close ? "Connection: close\r\n" : "", (unsigned) body_len);
+    }
+    else {
+        n = snprintf(c->out, FE_OUT_SIZE, "HTTP/1.1 404 Not Found\r\n%sContent-Length: 0\r\n\r\n",
+                c->close ? "Connection: close\r\n" : "");
+    }
+    memcpy(c->out + n, body, body_len);
+    c->out_len = (size_t) n + body_len;
+
+    /* Drop the request, keep what was pipelined behind it */
+    memmove(c->buf, c->buf + req_len, c->len - req_len);
+    c->len -= req_len;
+    c->buf[c->len] = '\0';
+
+    if (fe_latency_ms == 0) return fe_send(c);
+
+    c->due_us = fe_now_us() + (int64_t) fe_latency_ms * 1000;
+    c->next = NULL;
+    if (fe_delay_tail != NULL) fe_delay_tail->next = c;
+    else fe_delay_head = c;
+    fe_delay_tail = c;
+    return 1;
+}
+
+/* Answers the complete requests in the buffer, one at a time when replies
+ * are delayed */
+static void fe_serve(FE_Conn* c)
+{
+    char* end;
+
+    while (c->due_us == 0 && (end = strstr(c->buf, "\r\n\r\n")) != NULL) {
+        if (!fe_reply(c, (size_t) (end + 4 - c->buf))) return;
+    }
+    if (c->len == FE_BUF_SIZE - 1) fe_close(c);
+}
+
+static void fe_on_data(FE_Conn* c)
+{
+    ssize_t r;
+
+    r = recv(c->fd, c->buf + c->len, FE_BUF_SIZE - 1 - c->len, 0);
+    if (r < 0 && errno == EAGAIN) return;
+    if (r <= 0) {
+        fe_close(c);
+        return;
+    }
+    c->len += (size_t) r;
+    c->buf[c->len] = '\0';
+    c->last_us = fe_now_us();
+
+    /* Dead nodes swallow requests */
+    if (fe_is_dead(c->node)) {
+        c->len = 0;
+        return;
+    }
+    fe_serve(c);
+}
+
+static void fe_accept(int lfd)
+{
+    struct epoll_event ev;
+    struct sockaddr_in local;
+    socklen_t len;
+    FE_Conn* c;
+    uint32_t node;
+    int one = 1;
+    int fd;
+
+    for (;;) {
+        fd = accept4(lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+
+        len = sizeof(local);
+        getsockname(fd, (struct sockaddr*) &local, &len);
+        node = ntohl(local.sin_addr.s_addr) - fe_first;
+        if (node >= fe_nodes) {
+            close(fd);
+            continue;
+        }
+
+        c = calloc(1, sizeof(*c));
+        if (c == NULL) {
+            close(fd);
+            continue;
+        }
+        c->fd = fd;
+        c->node = node;
+        c->last_us = fe_now_us();
+        c->next_all = fe_all;
+        if (fe_all != NULL) fe_all->prev_all = c;
+        fe_all = c;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        ev.events = EPOLLIN;
+        ev.data.ptr = c;
+        epoll_ctl(fe_epfd, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+/* Sends the delayed replies that are due */
+static void fe_flush(int64_t now)
+{
+    FE_Conn* c;
+
+    while ((c = fe_delay_head) != NULL && c->due_us <= now) {
+        fe_delay_head = c->next;
+        if (fe_delay_head == NULL) fe_delay_tail = NULL;
+        c->due_us = 0;
+        if (fe_send(c)) fe_serve(c);
+    }
+}
+
+/* Closes the connections idle for longer than the board keeps them */
+static void fe_expire(int64_t now)
+{
+    FE_Conn* c;
+    FE_Conn* next;
+
+    for (c = fe_all; c != NULL; c = next) {
+        next = c->next_all;
+        if (c->due_us == 0 && now - c->last_us >= (int64_t) HTTP_KEEPALIVE_TIMEOUT_MS * 1000) fe_close(c);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    struct epoll_event events[256];
+    struct epoll_event ev;
+    struct sockaddr_in addr;
+    struct in_addr first;
+    const char* first_str = "127.1.0.1";
+    int64_t now;
+    int64_t next_expire;
+    int timeout;
+    int port = 8080;
+    int one = 1;
+    int lfd;
+    int opt;
+    int n;
+    int i;
+
+    while ((opt = getopt(argc, argv, "N:b:p:l:x:")) != -1) {
+        switch (opt)
+        {
+            case 'N':
+                fe_nodes = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'b':
+                first_str = optarg;
+                break;
+            case 'p':
+                port = atoi(optarg);
+                break;
+            case 'l':
+                fe_latency_ms = (unsigned) strtoul(optarg, NULL, 0);
+                break;
+            case 'x':
+                fe_dead_pct = (unsigned) strtoul(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-N nodes] [-b first-address] [-p port] [-l latency-ms] [-x dead-percent]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (inet_pton(AF_INET, first_str, &first) != 1) {
+        fprintf(stderr, "%s: not an IPv4 address\n", first_str);
+        return 2;
+    }
+    fe_first = ntohl(first.s_addr);
+
+    lfd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t) port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(lfd, (struct sockaddr*) &addr, sizeof(addr)) < 0 || listen(lfd, 4096) < 0) {
+        perror("listen");
+        return 1;
+    }
+
+    fe_epfd = epoll_create1(EPOLL_CLOEXEC);
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    epoll_ctl(fe_epfd, EPOLL_CTL_ADD, lfd, &ev);
+    fe_start_us = fe_now_us();
+    next_expire = fe_start_us + 1000000;
+
+    printf("%u nodes from %s port %d, latency %u ms, %u%% dead\n", fe_nodes, first_str, port, fe_latency_ms, fe_dead_pct);
+    fflush(stdout);
+
+    for (;;) {
+        timeout = 1000;
+        if (fe_delay_head != NULL) {
+            timeout = (int) ((fe_delay_head->due_us - fe_now_us() + 999) / 1000);
+            if (timeout < 0) timeout = 0;
+        }
+
+        n = epoll_wait(fe_epfd, events, 256, timeout);
+        for (i = 0; i < n; i++) {
+            if (events[i].data.ptr == NULL) fe_accept(lfd);
+            else fe_on_data(events[i].data.ptr);
+        }
+
+        now = fe_now_us();
+        fe_flush(now);
+        if (now >= next_expire) {
+            fe_expire(now);
+            next_expire = now + 1000000;
+        }
+    }
+}
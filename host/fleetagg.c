@@ -0,0 +1,1056 @@
+/**
+ ******************************************************************************
+ * @file    host/fleetagg.c
+ * @author  WIZnet
+ * @brief   Fleet aggregator: scrapes the reading of many sensor nodes over
+ *          their HTTP interface and serves the merged latest values.
+ ******************************************************************************
+ * @attention
+ *
+ * Usage: fleetagg [-f node-file | -N nodes -b first-address] [-p port]
+ *                 [-i interval-ms] [-T timeout-ms] [-B max-backoff-ms]
+ *                 [-c in-flight] [-w workers] [-l listen-port] [-C cycles]
+ *
+ * The nodes are read from a file of "address[:port]" lines, or are -N
+ * consecutive addresses from -b (default 127.1.0.1), on port -p (default
+ * 8080) unless a line says otherwise.
+ *
+ * Every node is scraped for /api/moisture.bin every -i milliseconds (default
+ * 1000), starting spread over the interval. A scrape that takes longer than
+ * -T milliseconds (default 2000), fails or returns anything but a valid
+ * record counts as a failure, and the node is retried after twice the
+ * interval, doubling on every further failure up to -B milliseconds
+ * (default 60000), with +-12% jitter. Connections are kept alive between
+ * scrapes; one the node closed while idle is reopened without counting a
+ * failure. At most -c scrapes (default 256) are in flight per worker; due
+ * nodes beyond that wait in line.
+ *
+ * The nodes are split over -w workers (default 1, 0 for one per core), each
+ * a thread with its own epoll set, timer heap and share of the nodes. With
+ * one worker the aggregator is a single-threaded event loop.
+ *
+ * The merged table is served on 127.0.0.1:-l (default 9180, 0 for none):
+ *   /nodes   CSV, one line per node: address, state, seq, ts, counts and
+ *            moisture [%] per channel, age of the reading, scrape latency,
+ *            scrape and failure counts
+ *   /stats   Totals in the Prometheus text format
+ *
+ * -C runs a benchmark instead: every node is scraped -C times in lockstep
+ * cycles as fast as the nodes answer, and the cycle times are reported. The
+ * first cycle, which opens the connections, is reported on its own.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+/* Private define ------------------------------------------------------------*/
+#define FA_BUF_SIZE         512
+#define FA_CHANNELS_MAX     8
+#define FA_RECORD_VERSION   2       /* Newest known; 1 lacks moisture */
+#define FA_DOWN_AFTER       3       /* Consecutive failures to call a node down */
+#define FA_MAX_WORKERS      64
+#define FA_MAX_CLIENTS      16
+#define FA_EVENTS           256
+
+/* Kinds of epoll entries */
+#define FA_KIND_NODE    1
+#define FA_KIND_LISTEN  2
+#define FA_KIND_CLIENT  3
+
+/* Node states */
+#define FA_IDLE         0           /* Waiting for its next scrape */
+#define FA_READY        1           /* Due, waiting for a free slot */
+#define FA_CONNECTING   2
+#define FA_SENDING      3
+#define FA_READING      4
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+    uint8_t valid;                  /* A reading has been taken */
+    uint8_t channels;
+    uint8_t has_moisture;
+    uint16_t value[FA_CHANNELS_MAX];
+    uint16_t moisture[FA_CHANNELS_MAX];     /* 0.1 % */
+    uint32_t seq;
+    uint32_t ts;
+    int64_t when_us;                /* Time of the last good scrape */
+    uint32_t latency_us;
+    uint32_t scrapes;
+    uint32_t failures;
+    uint32_t streak;                /* Consecutive failures */
+} FA_Latest;
+
+struct FA_Worker;
+
+typedef struct FA_Node
+{
+    uint8_t kind;
+    uint8_t state;
+    uint8_t retried;                /* Current scrape reopened the connection */
+    uint8_t close;                  /* Node closes after this reply */
+    int fd;                         /* -1 when not connected */
+    uint32_t events;                /* epoll events registered */
+    unsigned requests;              /* Requests on this connection */
+    struct sockaddr_in addr;
+    struct FA_Worker* w;
+    int64_t due_us;                 /* Next scrape */
+    int64_t deadline_us;            /* Heap key: due time or timeout */
+    int heap_pos;                   /* -1 when not in the heap */
+    struct FA_Node* next_ready;
+    int64_t start_us;
+    char buf[FA_BUF_SIZE];
+    size_t len;
+    size_t req_len;
+    size_t sent;
+    long hdr_len;                   /* 0 until the header is complete */
+    long body_len;
+    int status;
+    FA_Latest latest;               /* Guarded by the worker lock */
+} FA_Node;
+
+typedef struct FA_Worker
+{
+    int epfd;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    FA_Node** own;                  /* Nodes of this worker */
+    unsigned own_len;
+    FA_Node** heap;                 /* Timers, earliest deadline first */
+    unsigned heap_len;
+    FA_Node* ready_head;
+    FA_Node* ready_tail;
+    unsigned inflight;
+    unsigned pending;               /* Benchmark: scrapes left in the cycle */
+    unsigned long scrapes;
+    unsigned long failures;
+} FA_Worker;
+
+typedef struct
+{
+    uint8_t kind;
+    int fd;
+} FA_Listen;
+
+typedef struct
+{
+    uint8_t kind;
+    int fd;
+    char in[1024];
+    size_t in_len;
+    char* out;
+    size_t out_len;
+    size_t out_sent;
+} FA_Client;
+
+/* Private variables ---------------------------------------------------------*/
+static FA_Node* fa_node;
+static unsigned fa_nodes;
+static FA_Worker fa_worker[FA_MAX_WORKERS];
+static unsigned fa_workers = 1;
+
+static int64_t fa_interval_us = 1000000;
+static int64_t fa_timeout_us = 2000000;
+static int64_t fa_backoff_max_us = 60000000;
+static unsigned fa_max_inflight = 256;
+static unsigned fa_cycles;              /* Benchmark cycles, 0 = serve */
+
+static pthread_barrier_t fa_barrier;
+static int64_t* fa_cycle_us;
+
+static FA_Listen fa_listen = { FA_KIND_LISTEN, -1 };
+static FA_Client fa_client[FA_MAX_CLIENTS];
+
+/* Private functions ---------------------------------------------------------*/
+
+static int64_t fa_now_us(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (int64_t) t.tv_sec * 1000000 + t.tv_nsec / 1000;
+}
+
+/* Timer heap ----------------------------------------------------------------*/
+
+static void fa_heap_place(FA_Worker* w, unsigned i, FA_Node* n)
+{
+    w->heap[i] = n;
+    n->heap_pos = (int) i;
+}
+
+static void fa_heap_up(FA_Worker* w, unsigned i)
+{
+    FA_Node* n = w->heap[i];
+    unsigned parent;
+
+    while (i > 0) {
+        parent = (i - 1) / 2;
+        if (w->heap[parent]->deadline_us <= n->deadline_us) break;
+        fa_heap_place(w, i, w->heap[parent]);
+        i = parent;
+    }
+    fa_heap_place(w, i, n);
+}
+
+static void fa_heap_down(FA_Worker* w, unsigned i)
+{
+    FA_Node* n = w->heap[i];
+    unsigned child;
+
+    for (;;) {
+        child = 2 * i + 1;
+        if (child >= w->heap_len) break;
+        if (child + 1 < w->heap_len && w->heap[child + 1]->deadline_us < w->heap[child]->deadline_us) child++;
+        if (n->deadline_us <= w->heap[child]->deadline_us) break;
+        fa_heap_place(w, i, w->heap[child]);
+        i = child;
+    }
+    fa_heap_place(w, i, n);
+}
+
+/* Sets the deadline of a node, adding it to the heap if it is not there */
+static void fa_heap_set(FA_Worker* w, FA_Node* n, int64_t deadline_us)
+{
+    n->deadline_us = deadline_us;
+    if (n->heap_pos < 0) {
+        fa_heap_place(w, w->heap_len++, n);
+        fa_heap_up(w, (unsigned) n->heap_pos);
+        return;
+    }
+    fa_heap_up(w, (unsigned) n->heap_pos);
+    fa_heap_down(w, (unsigned) n->heap_pos);
+}
+
+static void fa_heap_remove(FA_Worker* w, FA_Node* n)
+{
+    unsigned i = (unsigned) n->heap_pos;
+    FA_Node* last;
+
+    if (n->heap_pos < 0) return;
+    n->heap_pos = -1;
+    last = w->heap[--w->heap_len];
+    if (last == n) return;
+
+    fa_heap_place(w, i, last);
+    fa_heap_up(w, i);
+    fa_heap_down(w, (unsigned) last->heap_pos);
+}
+
+/* Scraping ------------------------------------------------------------------*/
+
+static void fa_watch(FA_Worker* w, FA_Node* n, uint32_t events)
+{
+    struct epoll_event ev;
+
+    if (n->events == events) return;
+    ev.events = events;
+    ev.data.ptr = n;
+    epoll_ctl(w->epfd, n->events == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, n->fd, &ev);
+    n->events = events;
+}
+
+static void fa_disconnect(FA_Node* n)
+{
+    if (n->fd < 0) return;
+    close(n->fd);
+    n->fd = -1;
+    n->events = 0;
+    n->requests = 0;
+}
+
+static void fa_start(FA_Worker* w, FA_Node* n, int64_t now);
+static void fa_begin(FA_Worker* w, FA_Node* n);
+
+/* Schedules the next scrape of a node whose scrape ended, and starts the
+ * nodes waiting for the slot it frees */
+static void fa_finish(FA_Worker* w, FA_Node* n, int ok, int64_t now)
+{
+    int64_t delay;
+    unsigned shift;
+    FA_Node* r;
+
+    w->inflight--;
+    n->state = FA_IDLE;
+    fa_heap_remove(w, n);
+    if (n->fd >= 0) fa_watch(w, n, EPOLLIN);
+
+    if (fa_cycles != 0) {
+        w->pending--;
+    }
+    else if (ok) {
+        /* Keep the phase the node was given, unless it fell behind */
+        n->due_us += fa_interval_us;
+        if (n->due_us < now) n->due_us = now;
+        fa_heap_set(w, n, n->due_us);
+    }
+    else {
+        shift = n->latest.streak < 16 ? n->latest.streak : 16;
+        delay = fa_interval_us << shift;
+        if (delay > fa_backoff_max_us) delay = fa_backoff_max_us;
+        delay += (delay / 8) * ((rand() % 201) - 100) / 100;
+        n->due_us = now + delay;
+        fa_heap_set(w, n, n->due_us);
+    }
+
+    while (w->inflight < fa_max_inflight && (r = w->ready_head) != NULL) {
+        w->ready_head = r->next_ready;
+        if (w->ready_head == NULL) w->ready_tail = NULL;
+        fa_start(w, r, now);
+    }
+}
+
+static void fa_fail(FA_Worker* w, FA_Node* n, int64_t now)
+{
+    fa_disconnect(n);
+
+    pthread_mutex_lock(&w->lock);
+    n->latest.failures++;
+    n->latest.streak++;
+    pthread_mutex_unlock(&w->lock);
+    w->failures++;
+
+    fa_finish(w, n, 0, now);
+}
+
+/* Retries a scrape the node closed a kept-alive connection on before
+ * answering: it timed the connection out while it was idle */
+static int fa_retry(FA_Worker* w, FA_Node* n)
+{
+    if (n->retried || n->requests == 0 || n->len != 0) return 0;
+
+    fa_disconnect(n);
+    n->retried = 1;
+    fa_begin(w, n);
+    return 1;
+}
+
+/* Takes the record out of a complete reply */
+static void fa_done(FA_Worker* w, FA_Node* n, int64_t now)
+{
+    const uint8_t* b = (const uint8_t*) n->buf + n->hdr_len;
+    const uint8_t* m;
+    uint8_t version = n->body_len >= 4 ? b[2] : 0;
+    uint8_t channels = n->body_len >= 4 ? b[3] : 0;
+    uint8_t ch;
+
+    if (n->status != 200 || n->body_len < 4 || b[0] != 'S' || b[1] != 'M' || version < 1 || version > FA_RECORD_VERSION
+            || channels > FA_CHANNELS_MAX || n->body_len != 12 + (version == 1 ? 2 : 4) * channels) {
+        fa_fail(w, n, now);
+        return;
+    }
+
+    pthread_mutex_lock(&w->lock);
+    n->latest.valid = 1;
+    n->latest.channels = channels;
+    n->latest.has_moisture = version >= 2;
+    n->latest.seq = b[4] | (uint32_t) b[5] << 8 | (uint32_t) b[6] << 16 | (uint32_t) b[7] << 24;
+    n->latest.ts = b[8] | (uint32_t) b[9] << 8 | (uint32_t) b[10] << 16 | (uint32_t) b[11] << 24;
+    m = b + 12 + 2 * channels;
+    for (ch = 0; ch < channels; ch++) {
+        n->latest.value[ch] = (uint16_t) (b[12 + 2 * ch] | b[13 + 2 * ch] << 8);
+        if (version >= 2) n->latest.moisture[ch] = (uint16_t) (m[2 * ch] | m[2 * ch + 1] << 8);
+    }
+    n->latest.when_us = now;
+    n->latest.latency_us = (uint32_t) (now - n->start_us);
+    n->latest.scrapes++;
+    n->latest.streak = 0;
+    pthread_mutex_unlock(&w->lock);
+    w->scrapes++;
+
+    n->requests++;
+    if (n->close) fa_disconnect(n);
+    fa_finish(w, n, 1, now);
+}
+
+static void fa_parse_header(FA_Node* n)
+{
+    char* end;
+    char* line;
+    char* next;
+
+    n->buf[n->len] = '\0';
+    end = strstr(n->buf, "\r\n\r\n");
+    if (end == NULL) return;
+
+    n->hdr_len = end + 4 - n->buf;
+    n->status = (int) strtol(n->buf + 9, NULL, 10);
+    n->body_len = 0;
+
+    for (line = strstr(n->buf, "\r\n") + 2; line < end; line = next + 2) {
+        next = strstr(line, "\r\n");
+        if (strncasecmp(line, "Content-Length:", 15) == 0) n->body_len = strtol(line + 15, NULL, 10);
+        else if (strncasecmp(line, "Connection:", 11) == 0 && strstr(line, "close") != NULL && strstr(line, "close") < next) n->close = 1;
+    }
+}
+
+static void fa_send(FA_Worker* w, FA_Node* n)
+{
+    ssize_t r;
+
+    r = send(n->fd, n->buf + n->sent, n->req_len - n->sent, MSG_NOSIGNAL);
+    if (r < 0) {
+        if (errno == EAGAIN) {
+            fa_watch(w, n, EPOLLOUT);
+            return;
+        }
+        if (!fa_retry(w, n)) fa_fail(w, n, fa_now_us());
+        return;
+    }
+    n->sent += (size_t) r;
+    if (n->sent < n->req_len) {
+        fa_watch(w, n, EPOLLOUT);
+        return;
+    }
+
+    n->state = FA_READING;
+    n->len = 0;
+    fa_watch(w, n, EPOLLIN);
+}
+
+/* Sends the request, opening a connection first if there is none */
+static void fa_begin(FA_Worker* w, FA_Node* n)
+{
+    char host[INET_ADDRSTRLEN];
+    int one = 1;
+
+    inet_ntop(AF_INET, &n->addr.sin_addr, host, sizeof(host));
+    n->req_len = (size_t) snprintf(n->buf, FA_BUF_SIZE, "GET /api/moisture.bin HTTP/1.1\r\nHost: %s\r\n\r\n", host);
+    n->sent = 0;
+    n->len = 0;
+    n->hdr_len = 0;
+    n->body_len = 0;
+    n->status = 0;
+    n->close = 0;
+
+    if (n->fd >= 0) {
+        n->state = FA_SENDING;
+        fa_send(w, n);
+        return;
+    }
+
+    n->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (n->fd < 0) {
+        fa_fail(w, n, fa_now_us());
+        return;
+    }
+    setsockopt(n->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(n->fd, (struct sockaddr*) &n->addr, sizeof(n->addr)) < 0 && errno != EINPROGRESS) {
+        fa_fail(w, n, fa_now_us());
+        return;
+    }
+    n->state = FA_CONNECTING;
+    fa_watch(w, n, EPOLLOUT);
+}
+
+static void fa_start(FA_Worker* w, FA_Node* n, int64_t now)
+{
+    w->inflight++;
+    n->start_us = now;
+    n->retried = 0;
+    fa_heap_set(w, n, now + fa_timeout_us);
+    fa_begin(w, n);
+}
+
+/* A node's timer went off: its scrape is due, or has timed out */
+static void fa_timer(FA_Worker* w, FA_Node* n, int64_t now)
+{
+    if (n->state != FA_IDLE) {
+        fa_fail(w, n, now);
+        return;
+    }
+
+    if (w->inflight < fa_max_inflight) {
+        fa_start(w, n, now);
+        return;
+    }
+    n->state = FA_READY;
+    n->next_ready = NULL;
+    if (w->ready_tail != NULL) w->ready_tail->next_ready = n;
+    else w->ready_head = n;
+    w->ready_tail = n;
+}
+
+static void fa_on_node(FA_Worker* w, FA_Node* n)
+{
+    struct sockaddr_in peer;
+    socklen_t len = sizeof(int);
+    socklen_t peer_len = sizeof(peer);
+    char scratch[64];
+    int err = 0;
+    ssize_t r;
+
+    switch (n->state)
+    {
+        case FA_IDLE:
+        case FA_READY:
+            /* The node closed the kept-alive connection, or sent junk */
+            r = recv(n->fd, scratch, sizeof(scratch), 0);
+            if (r < 0 && errno == EAGAIN) return;
+            fa_disconnect(n);
+            return;
+
+        case FA_CONNECTING:
+            getsockopt(n->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+            if (err != 0) {
+                fa_fail(w, n, fa_now_us());
+                return;
+            }
+            /* Event left over from the connection this one replaced */
+            if (getpeername(n->fd, (struct sockaddr*) &peer, &peer_len) < 0) return;
+
+            n->state = FA_SENDING;
+            fa_send(w, n);
+            return;
+
+        case FA_SENDING:
+            fa_send(w, n);
+            return;
+
+        case FA_READING:
+            if (n->len == FA_BUF_SIZE - 1) {
+                fa_fail(w, n, fa_now_us());
+                return;
+            }
+            r = recv(n->fd, n->buf + n->len, FA_BUF_SIZE - 1 - n->len, 0);
+            if (r < 0 && errno == EAGAIN) return;
+            if (r <= 0) {
+                if (!fa_retry(w, n)) fa_fail(w, n, fa_now_us());
+                return;
+            }
+            n->len += (size_t) r;
+
+            if (n->hdr_len == 0) fa_parse_header(n);
+            if (n->hdr_len && (long) n->len >= n->hdr_len + n->body_len) fa_done(w, n, fa_now_us());
+            return;
+    }
+}
+
+/* Table server --------------------------------------------------------------*/
+
+static void fa_client_close(FA_Client* c)
+{
+    close(c->fd);
+    free(c->out);
+    memset(c, 0, sizeof(*c));
+    c->fd = -1;
+}
+
+/* Renders the merged table, one CSV line per node */
+static void fa_render_nodes(FILE* f, int64_t now)
+{
+    char host[INET_ADDRSTRLEN];
+    const char* state;
+    FA_Latest l;
+    FA_Node* n;
+    unsigned i;
+    uint8_t ch;
+
+    fprintf(f, "node,state,seq,ts_ms,channels,moisture,age_ms,latency_us,scrapes,failures\n");
+    for (i = 0; i < fa_nodes; i++) {
+        n = &fa_node[i];
+        pthread_mutex_lock(&n->w->lock);
+        l = n->latest;
+        pthread_mutex_unlock(&n->w->lock);
+
+        if (l.streak >= FA_DOWN_AFTER) state = "down";
+        else if (l.streak > 0) state = "retry";
+        else if (l.valid) state = "up";
+        else state = "new";
+
+        inet_ntop(AF_INET, &n->addr.sin_addr, host, sizeof(host));
+        fprintf(f, "%s:%u,%s,", host, ntohs(n->addr.sin_port), state);
+        if (!l.valid) {
+            fprintf(f, ",,,,,,%lu,%lu\n", (unsigned long) l.scrapes, (unsigned long) l.failures);
+            continue;
+        }
+        fprintf(f, "%lu,%lu,", (unsigned long) l.seq, (unsigned long) l.ts);
+        for (ch = 0; ch < l.channels; ch++) {
+            fprintf(f, "%s%u", ch ? " " : "", l.value[ch]);
+        }
+        fprintf(f, ",");
+        for (ch = 0; ch < l.channels && l.has_moisture; ch++) {
+            fprintf(f, "%s%u.%u", ch ? " " : "", l.moisture[ch] / 10, l.moisture[ch] % 10);
+        }
+        fprintf(f, ",%lu,%lu,%lu,%lu\n", (unsigned long) ((now - l.when_us) / 1000), (unsigned long) l.latency_us,
+                (unsigned long) l.scrapes, (unsigned long) l.failures);
+    }
+}
+
+/* Renders the totals */
+static void fa_render_stats(FILE* f)
+{
+    unsigned long scrapes = 0;
+    unsigned long failures = 0;
+    unsigned up = 0;
+    unsigned down = 0;
+    unsigned inflight = 0;
+    FA_Node* n;
+    unsigned i;
+
+    for (i = 0; i < fa_nodes; i++) {
+        n = &fa_node[i];
+        pthread_mutex_lock(&n->w->lock);
+        scrapes += n->latest.scrapes;
+        failures += n->latest.failures;
+        if (n->latest.streak >= FA_DOWN_AFTER) down++;
+        else if (n->latest.valid && n->latest.streak == 0) up++;
+        pthread_mutex_unlock(&n->w->lock);
+    }
+    for (i = 0; i < fa_workers; i++) {
+        inflight += fa_worker[i].inflight;
+    }
+
+    fprintf(f, "# TYPE fleet_nodes gauge\nfleet_nodes %u\n", fa_nodes);
+    fprintf(f, "# TYPE fleet_nodes_up gauge\nfleet_nodes_up %u\n", up);
+    fprintf(f, "# TYPE fleet_nodes_down gauge\nfleet_nodes_down %u\n", down);
+    fprintf(f, "# TYPE fleet_inflight gauge\nfleet_inflight %u\n", inflight);
+    fprintf(f, "# TYPE fleet_scrapes_total counter\nfleet_scrapes_total %lu\n", scrapes);
+    fprintf(f, "# TYPE fleet_failures_total counter\nfleet_failures_total %lu\n", failures);
+}
+
+static void fa_client_request(FA_Worker* w, FA_Client* c)
+{
+    struct epoll_event ev;
+    const char* status = "200 OK";
+    const char* type = "text/plain";
+    char* body = NULL;
+    size_t body_len = 0;
+    FILE* f;
+
+    f = open_memstream(&body, &body_len);
+    if (strncmp(c->in, "GET /nodes ", 11) == 0) {
+        type = "text/csv";
+        fa_render_nodes(f, fa_now_us());
+    }
+    else if (strncmp(c->in, "GET /stats ", 11) == 0) {
+        fa_render_stats(f);
+    }
+    else {
+        status = "404 Not Found";
+    }
+    fclose(f);
+
+    f = open_memstream(&c->out, &c->out_len);
+    fprintf(f, "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %lu\r\nConnection: close\r\n\r\n",
+            status, type, (unsigned long) body_len);
+    fwrite(body, 1, body_len, f);
+    fclose(f);
+    free(body);
+
+    ev.events = EPOLLOUT;
+    ev.data.ptr = c;
+    epoll_ctl(w->epfd, EPOLL_CTL_MOD, c->fd, &ev);
+}
+
+static void fa_on_client(FA_Worker* w, FA_Client* c)
+{
+    ssize_t r;
+
+    if (c->out != NULL) {
+        r = send(c->fd, c->out + c->out_sent, c->out_len - c->out_sent, MSG_NOSIGNAL);
+        if (r < 0 && errno == EAGAIN) return;
+        if (r < 0) {
+            fa_client_close(c);
+            return;
+        }
+        c->out_sent += (size_t) r;
+        if (c->out_sent == c->out_len) fa_client_close(c);
+        return;
+    }
+
+    r = recv(c->fd, c->in + c->in_len, sizeof(c->in) - 1 - c->in_len, 0);
+    if (r < 0 && errno == EAGAIN) return;
+    if (r <= 0) {
+        fa_client_close(c);
+        return;
+    }
+    c->in_len += (size_t) r;
+    c->in[c->in_len] = '\0';
+
+    if (strstr(c->in, "\r\n\r\n") != NULL) fa_client_request(w, c);
+    else if (c->in_len == sizeof(c->in) - 1) fa_client_close(c);
+}
+
+static void fa_on_listen(FA_Worker* w)
+{
+    struct epoll_event ev;
+    FA_Client* c;
+    int fd;
+    int i;
+
+    for (;;) {
+        fd = accept4(fa_listen.fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+
+        for (i = 0; i < FA_MAX_CLIENTS && fa_client[i].fd >= 0; i++)
+            ;
+        if (i == FA_MAX_CLIENTS) {
+            close(fd);
+            continue;
+        }
+        c = &fa_client[i];
+        c->kind = FA_KIND_CLIENT;
+        c->fd = fd;
+        ev.events = EPOLLIN;
+        ev.data.ptr = c;
+        epoll_ctl(w->epfd, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+static int fa_serve(int port)
+{
+    struct sockaddr_in addr;
+    struct epoll_event ev;
+    int one = 1;
+    int i;
+
+    for (i = 0; i < FA_MAX_CLIENTS; i++) {
+        fa_client[i].fd = -1;
+    }
+
+    fa_listen.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    setsockopt(fa_listen.fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t) port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fa_listen.fd, (struct sockaddr*) &addr, sizeof(addr)) < 0 || listen(fa_listen.fd, 16) < 0) {
+        perror("listen");
+        return -1;
+    }
+
+    /* The first worker serves the table */
+    ev.events = EPOLLIN;
+    ev.data.ptr = &fa_listen;
+    epoll_ctl(fa_worker[0].epfd, EPOLL_CTL_ADD, fa_listen.fd, &ev);
+    return 0;
+}
+
+/* Workers -------------------------------------------------------------------*/
+
+/* Waits for the next event or timer and handles what is due */
+static void fa_poll(FA_Worker* w)
+{
+    struct epoll_event events[FA_EVENTS];
+    int64_t now = fa_now_us();
+    int64_t wait = 1000000;
+    FA_Node* n;
+    int count;
+    int i;
+
+    if (w->heap_len > 0) {
+        wait = w->heap[0]->deadline_us - now;
+        if (wait < 0) wait = 0;
+        if (wait > 1000000) wait = 1000000;
+    }
+
+    count = epoll_wait(w->epfd, events, FA_EVENTS, (int) ((wait + 999) / 1000));
+    for (i = 0; i < count; i++) {
+        switch (*(uint8_t*) events[i].data.ptr)
+        {
+            case FA_KIND_NODE:
+                fa_on_node(w, events[i].data.ptr);
+                break;
+            case FA_KIND_LISTEN:
+                fa_on_listen(w);
+                break;
+            case FA_KIND_CLIENT:
+                fa_on_client(w, events[i].data.ptr);
+                break;
+        }
+    }
+
+    now = fa_now_us();
+    while (w->heap_len > 0 && (n = w->heap[0])->deadline_us <= now) {
+        fa_heap_remove(w, n);
+        fa_timer(w, n, now);
+    }
+}
+
+static void* fa_run(void* arg)
+{
+    FA_Worker* w = arg;
+    int64_t now = fa_now_us();
+    unsigned i;
+
+    /* Spread the first scrapes over the interval */
+    for (i = 0; i < w->own_len; i++) {
+        w->own[i]->due_us = now + fa_interval_us * i / w->own_len;
+        fa_heap_set(w, w->own[i], w->own[i]->due_us);
+    }
+
+    for (;;) {
+        fa_poll(w);
+    }
+    return NULL;
+}
+
+static void* fa_bench(void* arg)
+{
+    FA_Worker* w = arg;
+    int64_t t0 = 0;
+    int64_t now;
+    unsigned cycle;
+    unsigned i;
+
+    for (cycle = 0; cycle < fa_cycles; cycle++) {
+        pthread_barrier_wait(&fa_barrier);
+        now = fa_now_us();
+        if (w == &fa_worker[0]) t0 = now;
+
+        w->pending = w->own_len;
+        for (i = 0; i < w->own_len; i++) {
+            fa_timer(w, w->own[i], now);
+        }
+        while (w->pending > 0) {
+            fa_poll(w);
+        }
+
+        pthread_barrier_wait(&fa_barrier);
+        if (w == &fa_worker[0]) fa_cycle_us[cycle] = fa_now_us() - t0;
+    }
+    return NULL;
+}
+
+/* Setup ---------------------------------------------------------------------*/
+
+static int fa_add_node(const char* spec, int default_port)
+{
+    char host[64];
+    const char* colon = strchr(spec, ':');
+    size_t len = colon != NULL ? (size_t) (colon - spec) : strlen(spec);
+    FA_Node* n;
+
+    if (len >= sizeof(host)) len = sizeof(host) - 1;
+    memcpy(host, spec, len);
+    host[len] = '\0';
+
+    fa_node = realloc(fa_node, (fa_nodes + 1) * sizeof(*fa_node));
+    if (fa_node == NULL) {
+        perror("realloc");
+        exit(1);
+    }
+    n = &fa_node[fa_nodes];
+    memset(n, 0, sizeof(*n));
+    n->addr.sin_family = AF_INET;
+    n->addr.sin_port = htons((uint16_t) (colon != NULL ? atoi(colon + 1) : default_port));
+    if (inet_pton(AF_INET, host, &n->addr.sin_addr) != 1) {
+        fprintf(stderr, "%s: not an IPv4 address\n", host);
+        return -1;
+    }
+    fa_nodes++;
+    return 0;
+}
+
+static int fa_load_nodes(const char* path, int default_port)
+{
+    char line[128];
+    char* p;
+    FILE* f = fopen(path, "r");
+
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), f) != NULL) {
+        p = line + strspn(line, " \t");
+        p[strcspn(p, " \t\r\n#")] = '\0';
+        if (*p == '\0') continue;
+        if (fa_add_node(p, default_port) < 0) {
+            fclose(f);
+            return -1;
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+/* Deals the nodes out to the workers */
+static void fa_setup_workers(void)
+{
+    FA_Worker* w;
+    FA_Node* n;
+    unsigned i;
+
+    for (i = 0; i < fa_workers; i++) {
+        w = &fa_worker[i];
+        w->epfd = epoll_create1(EPOLL_CLOEXEC);
+        pthread_mutex_init(&w->lock, NULL);
+        w->own = calloc(fa_nodes / fa_workers + 1, sizeof(*w->own));
+        w->heap = calloc(fa_nodes / fa_workers + 1, sizeof(*w->heap));
+        if (w->own == NULL || w->heap == NULL) {
+            perror("calloc");
+            exit(1);
+        }
+    }
+    for (i = 0; i < fa_nodes; i++) {
+        n = &fa_node[i];
+        w = &fa_worker[i % fa_workers];
+        n->kind = FA_KIND_NODE;
+        n->fd = -1;
+        n->heap_pos = -1;
+        n->w = w;
+        w->own[w->own_len++] = n;
+    }
+}
+
+static int fa_cmp_i64(const void* a, const void* b)
+{
+    int64_t x = *(const int64_t*) a;
+    int64_t y = *(const int64_t*) b;
+
+    return x < y ? -1 : x > y;
+}
+
+static void fa_report(void)
+{
+    unsigned long scrapes = 0;
+    unsigned long failures = 0;
+    int64_t total = 0;
+    unsigned warm = fa_cycles - 1;
+    unsigned i;
+
+    for (i = 0; i < fa_workers; i++) {
+        scrapes += fa_worker[i].scrapes;
+        failures += fa_worker[i].failures;
+    }
+
+    printf("nodes %6u  workers %2u  first %8.2f ms", fa_nodes, fa_workers, fa_cycle_us[0] / 1e3);
+    if (warm > 0) {
+        for (i = 1; i < fa_cycles; i++) {
+            total += fa_cycle_us[i];
+        }
+        qsort(fa_cycle_us + 1, warm, sizeof(*fa_cycle_us), fa_cmp_i64);
+        printf("  cycle p50 %8.2f ms  max %8.2f ms  %8.0f scrapes/s",
+                fa_cycle_us[1 + warm / 2] / 1e3, fa_cycle_us[fa_cycles - 1] / 1e3,
+                (double) fa_nodes * warm / (total / 1e6));
+    }
+    printf("  ok %lu  failed %lu\n", scrapes, failures);
+}
+
+int main(int argc, char** argv)
+{
+    const char* file = NULL;
+    const char* first_str = "127.1.0.1";
+    struct in_addr first;
+    char spec[INET_ADDRSTRLEN];
+    unsigned count = 1;
+    int port = 8080;
+    int listen_port = 9180;
+    long cores;
+    int opt;
+    unsigned i;
+
+    while ((opt = getopt(argc, argv, "f:N:b:p:i:T:B:c:w:l:C:")) != -1) {
+        switch (opt)
+        {
+            case 'f':
+                file = optarg;
+                break;
+            case 'N':
+                count = (unsigned) strtoul(optarg, NULL, 0);
+                break;
+            case 'b':
+                first_str = optarg;
+                break;
+            case 'p':
+                port = atoi(optarg);
+                break;
+            case 'i':
+                fa_interval_us = strtol(optarg, NULL, 0) * 1000L;
+                if (fa_interval_us <= 0) fa_interval_us = 1000;
+                break;
+            case 'T':
+                fa_timeout_us = strtol(optarg, NULL, 0) * 1000L;
+                break;
+            case 'B':
+                fa_backoff_max_us = strtol(optarg, NULL, 0) * 1000L;
+                break;
+            case 'c':
+                fa_max_inflight = (unsigned) strtoul(optarg, NULL, 0);
+                if (fa_max_inflight == 0) fa_max_inflight = 1;
+                break;
+            case 'w':
+                fa_workers = (unsigned) strtoul(optarg, NULL, 0);
+                if (fa_workers == 0) {
+                    cores = sysconf(_SC_NPROCESSORS_ONLN);
+                    fa_workers = cores > 0 ? (unsigned) cores : 1;
+                }
+                if (fa_workers > FA_MAX_WORKERS) fa_workers = FA_MAX_WORKERS;
+                break;
+            case 'l':
+                listen_port = atoi(optarg);
+                break;
+            case 'C':
+                fa_cycles = (unsigned) strtoul(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-f node-file | -N nodes -b first-address] [-p port] [-i interval-ms] [-T timeout-ms] [-B max-backoff-ms] [-c in-flight] [-w workers] [-l listen-port] [-C cycles]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    if (file != NULL) {
+        if (fa_load_nodes(file, port) < 0) return 1;
+    }
+    else {
+        if (inet_pton(AF_INET, first_str, &first) != 1) {
+            fprintf(stderr, "%s: not an IPv4 address\n", first_str);
+            return 2;
+        }
+        for (i = 0; i < count; i++) {
+            first.s_addr = htonl(ntohl(first.s_addr) + (i != 0));
+            inet_ntop(AF_INET, &first, spec, sizeof(spec));
+            fa_add_node(spec, port);
+        }
+    }
+    if (fa_nodes == 0) {
+        fprintf(stderr, "no nodes\n");
+        return 2;
+    }
+    if (fa_workers > fa_nodes) fa_workers = fa_nodes;
+    fa_setup_workers();
+    srand((unsigned) fa_now_us());
+
+    if (fa_cycles != 0) {
+        fa_cycle_us = calloc(fa_cycles, sizeof(*fa_cycle_us));
+        pthread_barrier_init(&fa_barrier, NULL, fa_workers);
+        for (i = 1; i < fa_workers; i++) {
+            pthread_create(&fa_worker[i].thread, NULL, fa_bench, &fa_worker[i]);
+        }
+        fa_bench(&fa_worker[0]);
+        for (i = 1; i < fa_workers; i++) {
+            pthread_join(fa_worker[i].thread, NULL);
+        }
+        fa_report();
+        return 0;
+    }
+
+    if (listen_port != 0 && fa_serve(listen_port) < 0) return 1;
+    printf("scraping %u nodes every %ld ms with %u worker%s, table on port %d\n", fa_nodes,
+            (long) (fa_interval_us / 1000), fa_workers, fa_workers == 1 ? "" : "s", listen_port);
+    fflush(stdout);
+
+    for (i = 1; i < fa_workers; i++) {
+        pthread_create(&fa_worker[i].thread, NULL, fa_run, &fa_worker[i]);
+    }
+    fa_run(&fa_worker[0]);
+    return 0;
+}
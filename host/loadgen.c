@@ -0,0 +1,480 @@
+/**
+ ******************************************************************************
+ * @file    host/loadgen.c
+ * @author  WIZnet
+ * @brief   HTTP load generator for the node running on a host or on the
+ *          board: requests per second, latency percentiles, and segments
+ *          and bytes per response at a given concurrency.
+ ******************************************************************************
+ * @attention
+ *
+ * Usage: loadgen [-H host] [-p port] [-c concurrency] [-n requests]
+ *                [-d seconds] [-r requests-per-connection] [-u path] [-z]
+ *                [-b source-address] [-i interval-ms]
+ *
+ * Each of the -c connections sends one request at a time and the next one
+ * as soon as the reply is complete. With -r 1 every request asks for the
+ * connection to be closed and opens a new one; with -r 0 (the default) a
+ * connection is kept until the server closes it. -z asks for gzip. The run
+ * stops after -n requests, or after -d seconds (default 5) when -n is 0.
+ * -b connects from another local address, such as 127.0.0.2, to appear as
+ * another client; -i makes each connection wait that many milliseconds
+ * after a reply before its next request, like a dashboard polling.
+ *
+ * Latency is measured from writing the request to the last byte of the
+ * reply. Segments are the data segments the kernel received on each
+ * connection (TCP_INFO), so they reflect how the server split its replies.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <linux/tcp.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+/* Private define ------------------------------------------------------------*/
+#define LG_MAX_CONN  1024
+#define LG_BUF_SIZE  16384
+#define LG_REQ_SIZE  512
+
+/* Connection states */
+#define LG_CONNECTING 1
+#define LG_SENDING    2
+#define LG_READING    3
+#define LG_WAITING    4     /* Paced, until t_due */
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+    int fd;
+    int state;
+    unsigned requests;          /* Requests sent on this connection */
+    uint8_t close;              /* Current request asked for close */
+    const char* req;
+    size_t req_len;
+    size_t req_sent;
+    char buf[LG_BUF_SIZE];
+    size_t len;
+    long hdr_len;               /* 0 until the header is complete */
+    long body_len;              /* -1: delimited by close */
+    int status;
+    struct timespec t_start;
+    struct timespec t_due;      /* Paced: next request not before */
+} LG_Conn;
+
+/* Private variables ---------------------------------------------------------*/
+static struct sockaddr_in lg_addr;
+static struct sockaddr_in lg_src;
+static int lg_bind;
+static long lg_interval_ms;
+static int lg_epfd;
+static LG_Conn lg_conn[LG_MAX_CONN];
+
+static char lg_req_keep[LG_REQ_SIZE];
+static char lg_req_close[LG_REQ_SIZE];
+static unsigned lg_per_conn;
+
+static unsigned long lg_limit;          /* Requests to issue, 0 = by time */
+static unsigned long lg_issued;
+static int lg_stopping;
+
+static uint32_t* lg_latency_us;
+static size_t lg_latency_cap;
+static unsigned long lg_responses;
+static unsigned long lg_status[6];
+static unsigned long lg_errors;
+static unsigned long lg_connections;
+static unsigned long long lg_bytes;
+static unsigned long long lg_segments;
+
+/* Private functions ---------------------------------------------------------*/
+
+static double lg_elapsed_us(const struct timespec* t0)
+{
+    struct timespec t1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (t1.tv_sec - t0->tv_sec) * 1e6 + (t1.tv_nsec - t0->tv_nsec) / 1e3;
+}
+
+static void lg_record_latency(uint32_t us)
+{
+    if (lg_responses == lg_latency_cap) {
+        lg_latency_cap = lg_latency_cap ? lg_latency_cap * 2 : 65536;
+        lg_latency_us = realloc(lg_latency_us, lg_latency_cap * sizeof(*lg_latency_us));
+        if (lg_latency_us == NULL) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    lg_latency_us[lg_responses] = us;
+}
+
+static int lg_cmp_u32(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*) a;
+    uint32_t y = *(const uint32_t*) b;
+
+    return x < y ? -1 : x > y;
+}
+
+static uint32_t lg_segments_in(int fd)
+{
+    struct tcp_info ti;
+    socklen_t len = sizeof(ti);
+
+    if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &ti, &len) < 0) return 0;
+    return ti.tcpi_data_segs_in;
+}
+
+static void lg_close(LG_Conn* c)
+{
+    if (c->fd < 0) return;
+    lg_segments += lg_segments_in(c->fd);
+    close(c->fd);
+    c->fd = -1;
+    c->state = 0;
+}
+
+static void lg_open(LG_Conn* c)
+{
+    struct epoll_event ev;
+
+    c->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (c->fd < 0) {
+        perror("socket");
+        exit(1);
+    }
+    if (lg_bind && bind(c->fd, (struct sockaddr*) &lg_src, sizeof(lg_src)) < 0) {
+        perror("bind");
+        exit(1);
+    }
+    if (connect(c->fd, (struct sockaddr*) &lg_addr, sizeof(lg_addr)) < 0 && errno != EINPROGRESS) {
+        perror("connect");
+        exit(1);
+    }
+
+    c->state = LG_CONNECTING;
+    c->requests = 0;
+    ev.events = EPOLLOUT;
+    ev.data.ptr = c;
+    epoll_ctl(lg_epfd, EPOLL_CTL_ADD, c->fd, &ev);
+    lg_connections++;
+}
+
+static int lg_want_more(void)
+{
+    return !lg_stopping && (lg_limit == 0 || lg_issued < lg_limit);
+}
+
+/* Starts the next request on an open connection, or reopens it when the
+ * previous request asked for it to be closed. */
+static void lg_next(LG_Conn* c)
+{
+    struct epoll_event ev;
+
+    if (!lg_want_more()) {
+        lg_close(c);
+        c->state = 0;
+        return;
+    }
+    if (c->state == 0 || c->fd < 0) {
+        lg_open(c);
+        return;
+    }
+
+    c->close = (lg_per_conn != 0 && c->requests + 1 >= lg_per_conn)
+            || (lg_limit != 0 && lg_issued + 1 == lg_limit);
+    c->req = c->close ? lg_req_close : lg_req_keep;
+    c->req_len = strlen(c->req);
+    c->req_sent = 0;
+    c->len = 0;
+    c->hdr_len = 0;
+    c->body_len = -1;
+    c->status = 0;
+    c->state = LG_SENDING;
+    c->requests++;
+    lg_issued++;
+    clock_gettime(CLOCK_MONOTONIC, &c->t_start);
+
+    ev.events = EPOLLOUT;
+    ev.data.ptr = c;
+    epoll_ctl(lg_epfd, EPOLL_CTL_MOD, c->fd, &ev);
+}
+
+/* Retries a request the server closed the connection on before answering */
+static void lg_retry(LG_Conn* c)
+{
+    lg_issued--;
+    lg_close(c);
+    lg_open(c);
+}
+
+/* Parks a paced connection until its next request is due */
+static void lg_wait(LG_Conn* c)
+{
+    struct epoll_event ev;
+
+    clock_gettime(CLOCK_MONOTONIC, &c->t_due);
+    c->t_due.tv_nsec += lg_interval_ms % 1000 * 1000000;
+    c->t_due.tv_sec += lg_interval_ms / 1000 + c->t_due.tv_nsec / 1000000000;
+    c->t_due.tv_nsec %= 1000000000;
+
+    if (c->fd >= 0) {
+        ev.events = 0;
+        ev.data.ptr = c;
+        epoll_ctl(lg_epfd, EPOLL_CTL_MOD, c->fd, &ev);
+    }
+    c->state = LG_WAITING;
+}
+
+static void lg_complete(LG_Conn* c)
+{
+    lg_record_latency((uint32_t) lg_elapsed_us(&c->t_start));
+    lg_responses++;
+    lg_bytes += c->len;
+    lg_status[c->status / 100 < 6 ? c->status / 100 : 0]++;
+
+    if (c->close) lg_close(c);
+    if (lg_interval_ms > 0 && lg_want_more()) lg_wait(c);
+    else lg_next(c);
+}
+
+static void lg_parse_header(LG_Conn* c)
+{
+    char* end;
+    char* line;
+    char* next;
+
+    c->buf[c->len < LG_BUF_SIZE ? c->len : LG_BUF_SIZE - 1] = '\0';
+    end = strstr(c->buf, "\r\n\r\n");
+    if (end == NULL) return;
+
+    c->hdr_len = end + 4 - c->buf;
+    c->status = (int) strtol(c->buf + 9, NULL, 10);
+    if (c->status == 304 || c->status == 204) c->body_len = 0;
+
+    for (line = strstr(c->buf, "\r\n") + 2; line < end; line = next + 2) {
+        next = strstr(line, "\r\n");
+        if (strncasecmp(line, "Content-Length:", 15) == 0) c->body_len = strtol(line + 15, NULL, 10);
+        else if (strncasecmp(line, "Connection:", 11) == 0 && strstr(line, "close") != NULL && strstr(line, "close") < next) c->close = 1;
+    }
+}
+
+static void lg_on_event(LG_Conn* c)
+{
+    struct epoll_event ev;
+    struct sockaddr_in peer;
+    socklen_t len = sizeof(int);
+    socklen_t peer_len = sizeof(peer);
+    int err = 0;
+    ssize_t r;
+
+    switch (c->state)
+    {
+        case LG_CONNECTING:
+            getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+            if (err != 0) {
+                lg_errors++;
+                lg_close(c);
+                lg_next(c);
+                return;
+            }
+            /* Event left over from the connection this one replaced */
+            if (getpeername(c->fd, (struct sockaddr*) &peer, &peer_len) < 0) return;
+
+            c->state = LG_READING;  /* Connected and idle */
+            lg_next(c);
+            return;
+
+        case LG_SENDING:
+            r = send(c->fd, c->req + c->req_sent, c->req_len - c->req_sent, MSG_NOSIGNAL);
+            if (r < 0) {
+                if (errno == EAGAIN) return;
+                if (c->requests > 1) lg_retry(c);
+                else {
+                    lg_errors++;
+                    lg_close(c);
+                    lg_next(c);
+                }
+                return;
+            }
+            c->req_sent += (size_t) r;
+            if (c->req_sent < c->req_len) return;
+
+            c->state = LG_READING;
+            ev.events = EPOLLIN;
+            ev.data.ptr = c;
+            epoll_ctl(lg_epfd, EPOLL_CTL_MOD, c->fd, &ev);
+            return;
+
+        case LG_READING:
+            if (c->len == LG_BUF_SIZE && c->hdr_len == 0) {
+                lg_errors++;
+                lg_close(c);
+                lg_next(c);
+                return;
+            }
+            if (c->len == LG_BUF_SIZE) {
+                /* Only the header has to stay; count and drop body bytes */
+                lg_bytes += c->len - c->hdr_len;
+                c->body_len -= c->len - c->hdr_len;
+                c->len = c->hdr_len;
+            }
+            r = recv(c->fd, c->buf + c->len, LG_BUF_SIZE - c->len, 0);
+            if (r < 0 && errno == EAGAIN) return;
+            if (r <= 0) {
+                if (c->hdr_len && c->body_len < 0) lg_complete(c);
+                else if (c->len == 0 && c->requests > 1) lg_retry(c);
+                else {
+                    lg_errors++;
+                    lg_issued--;
+                    lg_close(c);
+                    lg_next(c);
+                }
+                return;
+            }
+            c->len += (size_t) r;
+
+            if (c->hdr_len == 0) lg_parse_header(c);
+            if (c->hdr_len && c->body_len >= 0 && (long) c->len >= c->hdr_len + c->body_len) lg_complete(c);
+            return;
+    }
+}
+
+static void lg_build_request(char* out, const char* path, const char* host, int gzip, int close)
+{
+    snprintf(out, LG_REQ_SIZE, "GET %s HTTP/1.1\r\nHost: %s\r\n%s%s\r\n", path, host,
+            gzip ? "Accept-Encoding: gzip\r\n" : "",
+            close ? "Connection: close\r\n" : "");
+}
+
+int main(int argc, char** argv)
+{
+    struct epoll_event events[64];
+    struct timespec t0;
+    const char* host = "127.0.0.1";
+    const char* path = "/";
+    unsigned concurrency = 4;
+    double duration_s = 5;
+    double elapsed_us;
+    int port = 8080;
+    int gzip = 0;
+    int opt;
+    int n;
+    int i;
+
+    while ((opt = getopt(argc, argv, "H:p:c:n:d:r:u:zb:i:")) != -1) {
+        switch (opt)
+        {
+            case 'H':
+                host = optarg;
+                break;
+            case 'p':
+                port = atoi(optarg);
+                break;
+            case 'c':
+                concurrency = (unsigned) strtoul(optarg, NULL, 0);
+                if (concurrency == 0) concurrency = 1;
+                if (concurrency > LG_MAX_CONN) concurrency = LG_MAX_CONN;
+                break;
+            case 'n':
+                lg_limit = strtoul(optarg, NULL, 0);
+                break;
+            case 'd':
+                duration_s = atof(optarg);
+                break;
+            case 'r':
+                lg_per_conn = (unsigned) strtoul(optarg, NULL, 0);
+                break;
+            case 'u':
+                path = optarg;
+                break;
+            case 'z':
+                gzip = 1;
+                break;
+            case 'b':
+                if (inet_pton(AF_INET, optarg, &lg_src.sin_addr) != 1) {
+                    fprintf(stderr, "%s: not an IPv4 address\n", optarg);
+                    return 2;
+                }
+                lg_src.sin_family = AF_INET;
+                lg_bind = 1;
+                break;
+            case 'i':
+                lg_interval_ms = strtol(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-H host] [-p port] [-c concurrency] [-n requests] [-d seconds] [-r requests-per-connection] [-u path] [-z] [-b source-address] [-i interval-ms]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    lg_addr.sin_family = AF_INET;
+    lg_addr.sin_port = htons((uint16_t) port);
+    if (inet_pton(AF_INET, host, &lg_addr.sin_addr) != 1) {
+        fprintf(stderr, "%s: not an IPv4 address\n", host);
+        return 2;
+    }
+    lg_build_request(lg_req_keep, path, host, gzip, 0);
+    lg_build_request(lg_req_close, path, host, gzip, 1);
+
+    lg_epfd = epoll_create1(EPOLL_CLOEXEC);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < (int) concurrency; i++) {
+        lg_conn[i].fd = -1;
+        lg_open(&lg_conn[i]);
+    }
+
+    for (;;) {
+        if (lg_limit == 0 && !lg_stopping && lg_elapsed_us(&t0) >= duration_s * 1e6) lg_stopping = 1;
+
+        for (i = 0; i < (int) concurrency && lg_conn[i].fd < 0 && lg_conn[i].state != LG_WAITING; i++)
+            ;
+        if (i == (int) concurrency) break;
+
+        n = epoll_wait(lg_epfd, events, 64, lg_interval_ms > 0 ? 1 : 100);
+        for (i = 0; i < n; i++) {
+            lg_on_event(events[i].data.ptr);
+        }
+
+        for (i = 0; i < (int) concurrency && lg_interval_ms > 0; i++) {
+            if (lg_conn[i].state == LG_WAITING && (lg_stopping || lg_elapsed_us(&lg_conn[i].t_due) >= 0)) lg_next(&lg_conn[i]);
+        }
+
+        /* A time-limited run does not wait for connections still opening */
+        if (lg_stopping) {
+            for (i = 0; i < (int) concurrency; i++) {
+                if (lg_conn[i].state == LG_CONNECTING) lg_close(&lg_conn[i]);
+            }
+        }
+    }
+    elapsed_us = lg_elapsed_us(&t0);
+
+    if (lg_responses == 0) {
+        printf("no responses (%lu errors)\n", lg_errors);
+        return 1;
+    }
+    qsort(lg_latency_us, lg_responses, sizeof(*lg_latency_us), lg_cmp_u32);
+
+    printf("responses          : %lu in %.2f s, concurrency %u, %lu connections\n", lg_responses, elapsed_us / 1e6, concurrency, lg_connections);
+    printf("status             : 2xx %lu, 3xx %lu, 4xx %lu, 5xx %lu, errors %lu\n", lg_status[2], lg_status[3], lg_status[4], lg_status[5], lg_errors);
+    printf("requests/s         : %.0f\n", lg_responses / (elapsed_us / 1e6));
+    printf("latency p50        : %u us\n", lg_latency_us[lg_responses / 2]);
+    printf("latency p99        : %u us\n", lg_latency_us[lg_responses * 99 / 100]);
+    printf("latency max        : %u us\n", lg_latency_us[lg_responses - 1]);
+    printf("TCP segments/resp  : %.2f\n", (double) lg_segments / lg_responses);
+    printf("bytes/resp         : %.1f\n", (double) lg_bytes / lg_responses);
+    return 0;
+}
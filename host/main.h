@@ -0,0 +1,151 @@
+/**
+ ******************************************************************************
+ * @file    host/main.h
+ * @author  WIZnet
+ * @brief   Host (Linux) stand-in for the W7500x Standard Peripheral Library
+ *          headers pulled in by the firmware's main.h.
+ ******************************************************************************
+ * @attention
+ *
+ * Only the types, constants and functions referenced by the firmware sources
+ * are declared here. The definitions live in w7500_periph.c.
+ *
+ ******************************************************************************
+ */
+
+#ifndef __HOST_MAIN_H
+#define __HOST_MAIN_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "socket.h"
+
+/* Exported types ------------------------------------------------------------*/
+#define __IO volatile
+
+typedef enum { RESET = 0, SET = !RESET } FlagStatus, ITStatus;
+typedef enum { DISABLE = 0, ENABLE = !DISABLE } FunctionalState;
+
+typedef struct { int id; } GPIO_TypeDef;
+typedef struct { int id; } UART_TypeDef;
+typedef struct { int id; } DUALTIMER_TypeDef;
+
+typedef struct {
+    uint32_t UART_BaudRate;
+} UART_InitTypeDef;
+
+typedef struct {
+    uint32_t GPIO_Pin;
+    uint32_t GPIO_Direction;
+    uint32_t GPIO_Pad;
+    uint32_t GPIO_AF;
+} GPIO_InitTypeDef;
+
+typedef struct {
+    uint32_t Timer_Load;
+    uint32_t Timer_Prescaler;
+    uint32_t Timer_Wrapping;
+    uint32_t Timer_Repetition;
+    uint32_t Timer_Size;
+} DUALTIMER_InitTypDef;
+
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t LOAD;
+    volatile uint32_t VAL;
+    volatile uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct {
+    uint32_t NVIC_IRQChannel;
+    uint32_t NVIC_IRQChannelPriority;
+    FunctionalState NVIC_IRQChannelCmd;
+} NVIC_InitTypeDef;
+
+/* Exported constants --------------------------------------------------------*/
+#define W7500
+
+#define __W7500X_STDPERIPH_VERSION_MAIN 1
+#define __W7500X_STDPERIPH_VERSION_SUB1 0
+#define __W7500X_STDPERIPH_VERSION_SUB2 0
+
+#define GPIO_Pin_8  (1u << 8)
+#define GPIO_Pin_9  (1u << 9)
+#define GPIO_Pin_13 (1u << 13)
+#define GPIO_Pin_14 (1u << 14)
+#define GPIO_Pin_15 (1u << 15)
+#define GPIO_Direction_IN 0
+#define GPIO_Pad_Default 0
+#define PAD_AF0 0
+
+#define DUALTIMER_Prescaler_1 0
+#define DUALTIMER_Periodic 0
+#define DUALTIMER_Wrapping 0
+#define DUALTIMER_Size_32 0
+#define DUALTIMER0_IRQn 10
+#define UART1_IRQn 1
+#define UART2_IRQn 2
+
+#define UART_IT_FLAG_TXI 0x0020
+#define S_UART_CTRL_TXI 0x04
+#define S_UART_INTSTATUS_TXI 0x01
+#define WZTOE_IRQn 8
+
+#define PHY_LINK_ON 1
+
+extern GPIO_TypeDef* const GPIOB;
+extern GPIO_TypeDef* const GPIOC;
+extern UART_TypeDef* const UART1;
+extern DUALTIMER_TypeDef* const DUALTIMER0_0;
+
+/* SysTick->VAL is brought up to date with the host clock on every access */
+#define SysTick (Host_SysTick())
+
+/* Exported functions --------------------------------------------------------*/
+void SystemInit(void);
+uint32_t SysTick_Config(uint32_t ticks);
+SysTick_Type* Host_SysTick(void);
+uint32_t GetSystemClock(void);
+uint32_t GetSourceClock(void);
+void setTIC100US(uint32_t tic);
+
+void UART_StructInit(UART_InitTypeDef* UART_InitStruct);
+void UART_Init(UART_TypeDef* UARTx, UART_InitTypeDef* UART_InitStruct);
+void UART_Cmd(UART_TypeDef* UARTx, FunctionalState NewState);
+void S_UART_Init(uint32_t baud);
+void S_UART_Cmd(FunctionalState NewState);
+void UART_ITConfig(UART_TypeDef* UARTx, uint16_t UART_IT, FunctionalState NewState);
+ITStatus UART_GetITStatus(UART_TypeDef* UARTx, uint16_t UART_IT);
+void UART_ClearITPendingBit(UART_TypeDef* UARTx, uint16_t UART_IT);
+void UART_SendData(UART_TypeDef* UARTx, uint16_t Data);
+void S_UART_ITConfig(uint16_t S_UART_IT, FunctionalState NewState);
+ITStatus S_UART_GetITStatus(uint16_t S_UART_IT);
+void S_UART_ClearITPendingBit(uint16_t S_UART_IT);
+void S_UART_SendData(uint16_t Data);
+
+void GPIO_Init(GPIO_TypeDef* GPIOx, GPIO_InitTypeDef* GPIO_InitStruct);
+
+void DUALTIMER_Init(DUALTIMER_TypeDef* DUALTIMERn, DUALTIMER_InitTypDef* DUALTIMER_InitStruct);
+void DUALTIMER_ITConfig(DUALTIMER_TypeDef* DUALTIMERn, FunctionalState NewState);
+void DUALTIMER_Cmd(DUALTIMER_TypeDef* DUALTIMERn, FunctionalState NewState);
+void NVIC_Init(NVIC_InitTypeDef* NVIC_InitStruct);
+
+/* CMSIS core intrinsics; interrupts are the host's timer signal and the
+ * WZTOE interrupt raised when the firmware unmasks or sleeps */
+void __enable_irq(void);
+void __disable_irq(void);
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t primask);
+void __WFI(void);
+
+uint8_t PHY_Init(GPIO_TypeDef* GPIOx, uint16_t mdc, uint16_t mdio);
+uint8_t PHY_GetLinkStatus(void);
+
+void ADC_Cmd(FunctionalState NewState);
+void ADC_ChannelConfig(uint32_t ADC_Channel);
+void ADC_StartOfConversion(void);
+uint16_t ADC_GetConversionValue(void);
+
+#endif /* __HOST_MAIN_H */
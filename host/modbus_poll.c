@@ -0,0 +1,423 @@
+/**
+ ******************************************************************************
+ * @file    host/modbus_poll.c
+ * @author  WIZnet
+ * @brief   Modbus/TCP client for the node running on a host or on the
+ *          board: checks the register map, then polls with several
+ *          requests in flight and reports polls per second and latency.
+ ******************************************************************************
+ * @attention
+ *
+ * Usage: modbus_poll [-H host] [-p port] [-q in-flight] [-n polls]
+ *                    [-d seconds] [-w] [-P node-pid]
+ *
+ * The checks read every input and holding register, expect the exception
+ * codes for an unknown function, an address out of range and an invalid
+ * calibration, and with -w write a calibration to the last channel, read
+ * it back and put the old one back. One request is sent split after its
+ * MBAP header, with a pause before the rest; with -P the node's CPU time
+ * over the pause is read from /proc and must show it waiting, not spinning
+ * on the partial frame. A failed check exits with status 1.
+ *
+ * Polling reads all input registers over one connection, keeping -q
+ * requests in flight (default 4) and checking that every reply carries the
+ * transaction id of the oldest request. The run stops after -n polls, or
+ * after -d seconds (default 3) when -n is 0. Latency is measured from
+ * writing a request to the end of its reply.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "modbus.h"
+
+/* Private define ------------------------------------------------------------*/
+#define MP_ADU_MAX      260
+#define MP_INFLIGHT_MAX 64
+#define MP_UNIT         1
+#define MP_SPLIT_MS     300     /* Pause inside the split request */
+#define MP_SPLIT_CPU    0.3     /* Share of the pause the node may run */
+
+/* Private variables ---------------------------------------------------------*/
+static int mp_fd = -1;
+static uint16_t mp_tid;
+static unsigned mp_checks;
+
+static uint32_t* mp_latency_us;
+static size_t mp_latency_cap;
+static unsigned long mp_polls;
+
+/* Private functions ---------------------------------------------------------*/
+
+static double mp_elapsed_us(const struct timespec* t0)
+{
+    struct timespec t1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (double) (t1.tv_sec - t0->tv_sec) * 1e6 + (double) (t1.tv_nsec - t0->tv_nsec) / 1e3;
+}
+
+static int mp_cmp_u32(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*) a;
+    uint32_t y = *(const uint32_t*) b;
+
+    return (x > y) - (x < y);
+}
+
+static int mp_connect(const char* host, int port)
+{
+    struct sockaddr_in addr;
+    int one = 1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t) port);
+    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
+        fprintf(stderr, "%s: not an IPv4 address\n", host);
+        return -1;
+    }
+
+    mp_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (mp_fd < 0 || connect(mp_fd, (struct sockaddr*) &addr, sizeof(addr)) < 0) {
+        perror("connect");
+        return -1;
+    }
+    setsockopt(mp_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return 0;
+}
+
+static int mp_read_all(uint8_t* buf, size_t len)
+{
+    ssize_t n;
+
+    while (len > 0) {
+        n = read(mp_fd, buf, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        buf += n;
+        len -= (size_t) n;
+    }
+    return 0;
+}
+
+/* Sends a request PDU; returns its transaction id */
+static int mp_send(const uint8_t* pdu, uint16_t len)
+{
+    uint8_t adu[MP_ADU_MAX];
+
+    mp_tid++;
+    adu[0] = (uint8_t) (mp_tid >> 8);
+    adu[1] = (uint8_t) mp_tid;
+    adu[2] = 0;
+    adu[3] = 0;
+    adu[4] = (uint8_t) ((len + 1) >> 8);
+    adu[5] = (uint8_t) (len + 1);
+    adu[6] = MP_UNIT;
+    memcpy(adu + 7, pdu, len);
+    if (write(mp_fd, adu, 7u + len) != (ssize_t) (7u + len)) return -1;
+    return mp_tid;
+}
+
+/* Reads a reply; returns the length of its PDU */
+static int mp_recv(int tid, uint8_t* pdu)
+{
+    uint8_t mbap[7];
+    uint16_t len;
+
+    if (mp_read_all(mbap, sizeof(mbap)) < 0) {
+        printf("connection lost\n");
+        return -1;
+    }
+    len = (uint16_t) ((mbap[4] << 8) | mbap[5]);
+    if (len < 2 || len > MP_ADU_MAX - 6 || mp_read_all(pdu, len - 1u) < 0) {
+        printf("bad reply length %u\n", len);
+        return -1;
+    }
+    if (((mbap[0] << 8) | mbap[1]) != tid || mbap[2] != 0 || mbap[3] != 0 || mbap[6] != MP_UNIT) {
+        printf("reply to transaction %u, expected %d\n", (mbap[0] << 8) | mbap[1], tid);
+        return -1;
+    }
+    return len - 1;
+}
+
+static int mp_transact(const uint8_t* req, uint16_t len, uint8_t* rsp)
+{
+    int tid = mp_send(req, len);
+
+    return tid < 0 ? -1 : mp_recv(tid, rsp);
+}
+
+/* Reads count registers from addr into regs; returns 0 or the exception */
+static int mp_read(uint8_t fc, uint16_t addr, uint16_t count, uint16_t* regs)
+{
+    uint8_t req[5] = { fc, (uint8_t) (addr >> 8), (uint8_t) addr, (uint8_t) (count >> 8), (uint8_t) count };
+    uint8_t rsp[MP_ADU_MAX];
+    int n = mp_transact(req, sizeof(req), rsp);
+    uint16_t i;
+
+    if (n < 0) return -1;
+    if (n == 2 && rsp[0] == (fc | 0x80)) return rsp[1];
+    if (n != 2 + 2 * count || rsp[0] != fc || rsp[1] != 2 * count) {
+        printf("read %u+%u: bad reply\n", addr, count);
+        return -1;
+    }
+    for (i = 0; i < count; i++) regs[i] = (uint16_t) ((rsp[2 + 2 * i] << 8) | rsp[3 + 2 * i]);
+    return 0;
+}
+
+/* Writes count registers; returns 0 or the exception */
+static int mp_write(uint16_t addr, uint16_t count, const uint16_t* regs)
+{
+    uint8_t req[MP_ADU_MAX];
+    uint8_t rsp[MP_ADU_MAX];
+    uint16_t len = 6;
+    uint16_t i;
+    int n;
+
+    req[0] = MODBUS_FC_WRITE_MULTIPLE;
+    req[1] = (uint8_t) (addr >> 8);
+    req[2] = (uint8_t) addr;
+    req[3] = (uint8_t) (count >> 8);
+    req[4] = (uint8_t) count;
+    req[5] = (uint8_t) (2 * count);
+    for (i = 0; i < count; i++) {
+        req[len++] = (uint8_t) (regs[i] >> 8);
+        req[len++] = (uint8_t) regs[i];
+    }
+
+    if ((n = mp_transact(req, len, rsp)) < 0) return -1;
+    if (n == 2 && rsp[0] == (MODBUS_FC_WRITE_MULTIPLE | 0x80)) return rsp[1];
+    if (n != 5 || memcmp(rsp, req, 5) != 0) {
+        printf("write %u+%u: bad reply\n", addr, count);
+        return -1;
+    }
+    return 0;
+}
+
+/* CPU time of a process in seconds, or -1 */
+static double mp_cpu_s(long pid)
+{
+    char path[64];
+    unsigned long utime;
+    unsigned long stime;
+    FILE* f;
+    int n;
+
+    snprintf(path, sizeof(path), "/proc/%ld/stat", pid);
+    if ((f = fopen(path, "r")) == NULL) return -1;
+    n = fscanf(f, "%*d %*s %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime);
+    fclose(f);
+    return (n == 2) ? (double) (utime + stime) / (double) sysconf(_SC_CLK_TCK) : -1;
+}
+
+static int mp_expect(const char* what, int got, int want)
+{
+    if (got != want) {
+        printf("%s: got %d, expected %d\n", what, got, want);
+        return -1;
+    }
+    mp_checks++;
+    return 0;
+}
+
+static int mp_check(int write)
+{
+    uint16_t ir[MODBUS_IR_NUM];
+    uint16_t hr[MODBUS_HR_NUM];
+    uint16_t cal[MODBUS_HR_CAL_REGS];
+    uint16_t back[MODBUS_HR_CAL_REGS];
+    uint8_t bad_fc[5] = { 0x2B, 0, 0, 0, 1 };
+    uint8_t rsp[MP_ADU_MAX];
+    uint16_t last = MODBUS_HR_CAL(SAMPLER_CH_NUM - 1);
+    unsigned ch;
+
+    if (mp_expect("read input registers", mp_read(MODBUS_FC_READ_INPUT, 0, MODBUS_IR_NUM, ir), 0) < 0) return -1;
+    for (ch = 0; ch < SAMPLER_CH_NUM; ch++) {
+        if (mp_expect("moisture in range", ir[MODBUS_IR_MOISTURE + ch] <= MOISTURE_FULL, 1) < 0) return -1;
+        if (mp_expect("counts in range", ir[MODBUS_IR_COUNTS + ch] <= 4095, 1) < 0) return -1;
+    }
+    if (mp_expect("scan sequence", ir[MODBUS_IR_SEQ] != 0 || ir[MODBUS_IR_SEQ + 1] != 0, 1) < 0) return -1;
+    if (mp_expect("read holding registers", mp_read(MODBUS_FC_READ_HOLDING, 0, MODBUS_HR_NUM, hr), 0) < 0) return -1;
+    for (ch = 0; ch < SAMPLER_CH_NUM; ch++) {
+        if (mp_expect("calibration points", hr[MODBUS_HR_CAL(ch)] >= 2 && hr[MODBUS_HR_CAL(ch)] <= MOISTURE_CAL_POINTS_MAX, 1) < 0) return -1;
+    }
+
+    if (mp_expect("unknown function", mp_transact(bad_fc, sizeof(bad_fc), rsp) == 2 && rsp[0] == 0xAB ? rsp[1] : -1,
+            MODBUS_EX_ILLEGAL_FUNCTION) < 0) return -1;
+    if (mp_expect("input address out of range", mp_read(MODBUS_FC_READ_INPUT, MODBUS_IR_NUM - 1, 2, ir), MODBUS_EX_ILLEGAL_ADDRESS) < 0) return -1;
+    if (mp_expect("holding address out of range", mp_read(MODBUS_FC_READ_HOLDING, MODBUS_HR_NUM, 1, hr), MODBUS_EX_ILLEGAL_ADDRESS) < 0) return -1;
+    if (mp_expect("too many registers", mp_read(MODBUS_FC_READ_INPUT, 0, 126, ir), MODBUS_EX_ILLEGAL_VALUE) < 0) return -1;
+    if (!write) return 0;
+
+    /* A falling curve is refused and changes nothing */
+    memcpy(cal, hr + last, sizeof(cal));
+    back[0] = 2;
+    back[1] = 3000;
+    back[2] = 0;
+    back[3] = 1000;
+    back[4] = 1000;
+    if (mp_expect("invalid calibration", mp_write(last, 5, back), MODBUS_EX_ILLEGAL_VALUE) < 0) return -1;
+    if (mp_expect("across channels", mp_write(last - 1, 2, back), MODBUS_EX_ILLEGAL_ADDRESS) < 0) return -1;
+
+    /* Three points, read back, then the old curve again */
+    memset(back, 0, sizeof(back));
+    back[0] = 3;
+    back[1] = 1400;
+    back[2] = 1000;
+    back[3] = 2200;
+    back[4] = 450;
+    back[5] = 3050;
+    back[6] = 0;
+    if (mp_expect("write calibration", mp_write(last, 7, back), 0) < 0) return -1;
+    if (mp_expect("read calibration", mp_read(MODBUS_FC_READ_HOLDING, last, MODBUS_HR_CAL_REGS, hr), 0) < 0) return -1;
+    if (mp_expect("calibration read back", memcmp(hr, back, sizeof(back)) == 0, 1) < 0) return -1;
+    if (mp_expect("restore calibration", mp_write(last, MODBUS_HR_CAL_REGS, cal), 0) < 0) return -1;
+    return 0;
+}
+
+/* Sends a read of the input registers in two writes, the MBAP header and
+ * the function code first, and checks the reply; the node's CPU time over
+ * the pause between them must stay low when pid is not 0 */
+static int mp_split(long pid)
+{
+    uint8_t adu[12] = { 0, 0, 0, 0, 0, 6, MP_UNIT, MODBUS_FC_READ_INPUT, 0, 0, 0, MODBUS_IR_NUM };
+    uint8_t rsp[MP_ADU_MAX];
+    struct timespec pause = { 0, MP_SPLIT_MS * 1000000L };
+    double cpu = 0;
+
+    mp_tid++;
+    adu[0] = (uint8_t) (mp_tid >> 8);
+    adu[1] = (uint8_t) mp_tid;
+    if (write(mp_fd, adu, 8) != 8) return -1;
+    if (pid) cpu = mp_cpu_s(pid);
+    nanosleep(&pause, NULL);
+    if (pid) cpu = mp_cpu_s(pid) - cpu;
+    if (write(mp_fd, adu + 8, 4) != 4) return -1;
+
+    if (mp_expect("split request", mp_recv(mp_tid, rsp) == 2 + 2 * MODBUS_IR_NUM && rsp[0] == MODBUS_FC_READ_INPUT, 1) < 0) return -1;
+    if (pid && mp_expect("idle on a partial frame", cpu < MP_SPLIT_CPU * MP_SPLIT_MS / 1000, 1) < 0) {
+        printf("node ran %.0f ms of the %u ms pause\n", cpu * 1000, MP_SPLIT_MS);
+        return -1;
+    }
+    return 0;
+}
+
+static void mp_record_latency(uint32_t us)
+{
+    if (mp_polls == mp_latency_cap) {
+        mp_latency_cap = mp_latency_cap ? mp_latency_cap * 2 : 65536;
+        mp_latency_us = realloc(mp_latency_us, mp_latency_cap * sizeof(*mp_latency_us));
+        if (mp_latency_us == NULL) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    mp_latency_us[mp_polls++] = us;
+}
+
+static int mp_poll(unsigned inflight, unsigned long limit, double seconds)
+{
+    static const uint8_t req[5] = { MODBUS_FC_READ_INPUT, 0, 0, 0, MODBUS_IR_NUM };
+    struct timespec sent[MP_INFLIGHT_MAX];
+    int tid[MP_INFLIGHT_MAX];
+    uint8_t rsp[MP_ADU_MAX];
+    struct timespec t0;
+    unsigned long issued = 0;
+    unsigned head = 0;
+    unsigned count = 0;
+    double elapsed;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (;;) {
+        while (count < inflight && (limit ? issued < limit : mp_elapsed_us(&t0) < seconds * 1e6)) {
+            unsigned slot = (head + count) % MP_INFLIGHT_MAX;
+
+            clock_gettime(CLOCK_MONOTONIC, &sent[slot]);
+            if ((tid[slot] = mp_send(req, sizeof(req))) < 0) return -1;
+            issued++;
+            count++;
+        }
+        if (count == 0) break;
+
+        if (mp_recv(tid[head], rsp) != 2 + 2 * MODBUS_IR_NUM || rsp[0] != MODBUS_FC_READ_INPUT) {
+            printf("poll %lu: bad reply\n", mp_polls);
+            return -1;
+        }
+        mp_record_latency((uint32_t) mp_elapsed_us(&sent[head]));
+        head = (head + 1) % MP_INFLIGHT_MAX;
+        count--;
+    }
+    elapsed = mp_elapsed_us(&t0) / 1e6;
+
+    qsort(mp_latency_us, mp_polls, sizeof(*mp_latency_us), mp_cmp_u32);
+    printf("polls        : %lu in %.2f s, %u in flight\n", mp_polls, elapsed, inflight);
+    printf("polls/s      : %.0f\n", mp_polls / elapsed);
+    printf("latency      : p50 %u us  p99 %u us  max %u us\n", mp_latency_us[mp_polls / 2],
+           mp_latency_us[mp_polls * 99 / 100], mp_latency_us[mp_polls - 1]);
+    printf("bytes/poll   : %u request, %u reply\n", 7 + (unsigned) sizeof(req), 7 + 2 + 2 * MODBUS_IR_NUM);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    const char* host = "127.0.0.1";
+    int port = 8502;
+    unsigned inflight = 4;
+    unsigned long limit = 0;
+    double seconds = 3;
+    int write = 0;
+    long pid = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "H:p:q:n:d:wP:")) != -1) {
+        switch (opt)
+        {
+            case 'H':
+                host = optarg;
+                break;
+            case 'p':
+                port = atoi(optarg);
+                break;
+            case 'q':
+                inflight = (unsigned) strtoul(optarg, NULL, 0);
+                if (inflight == 0) inflight = 1;
+                if (inflight > MP_INFLIGHT_MAX) inflight = MP_INFLIGHT_MAX;
+                break;
+            case 'n':
+                limit = strtoul(optarg, NULL, 0);
+                break;
+            case 'd':
+                seconds = atof(optarg);
+                break;
+            case 'w':
+                write = 1;
+                break;
+            case 'P':
+                pid = strtol(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-H host] [-p port] [-q in-flight] [-n polls] [-d seconds] [-w] [-P node-pid]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    if (mp_connect(host, port) < 0) return 1;
+    if (mp_check(write) < 0 || mp_split(pid) < 0) return 1;
+    printf("checks       : %u passed\n", mp_checks);
+    if (mp_poll(inflight, limit, seconds) < 0) return 1;
+
+    close(mp_fd);
+    return 0;
+}
@@ -0,0 +1,175 @@
+/**
+ ******************************************************************************
+ * @file    host/node.c
+ * @author  WIZnet
+ * @brief   Runs the unmodified firmware as a sensor node on a Linux host,
+ *          serving real clients through the POSIX socket backend.
+ ******************************************************************************
+ * @attention
+ *
+ * Usage: node [-b bind-address] [-o port-offset] [-a adc-script]
+ *             [-s step-ms] [-t collector-ip:port] [-m batch] [-i interval-ms]
+ *             [-f flash-file]
+ *
+ * Firmware ports are moved up by the port offset (default 8000), so the web
+ * server listens on 127.0.0.1:8080 unless told otherwise.
+ *
+ * Without a script every ADC input follows a one minute triangle wave with a
+ * little noise. An ADC script has one line per step of -s milliseconds
+ * (default 1000) holding up to eight raw readings, AIN0 first; missing
+ * inputs read 0, lines starting with '#' are skipped and the script loops.
+ *
+ * -t turns on the UDP telemetry push to a collector such as telemetry_rx,
+ * with -m samples per datagram and a batch age limit of -i milliseconds.
+ *
+ * -f keeps the code flash, and with it the flash store, in a file, so the
+ * calibration, the last lease and the hourly history outlive the node.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <unistd.h>
+#include "main.h"
+#include "w7500_host.h"
+#include "w7500_posix.h"
+#include "telemetry.h"
+
+/* Private define ------------------------------------------------------------*/
+#define NODE_ADC_INPUTS    8
+#define NODE_SCRIPT_STEPS  4096
+#define NODE_WAVE_MS       60000
+
+/* Private variables ---------------------------------------------------------*/
+static uint16_t node_script[NODE_SCRIPT_STEPS][NODE_ADC_INPUTS];
+static uint32_t node_script_len;
+static uint32_t node_step_ms = 1000;
+static uint32_t node_noise = 1;
+
+/* External functions --------------------------------------------------------*/
+extern int firmware_main(void);
+
+/* Private functions ---------------------------------------------------------*/
+
+static uint16_t node_adc_script(uint32_t channel)
+{
+    uint32_t step = (Host_Millis() / node_step_ms) % node_script_len;
+
+    return channel < NODE_ADC_INPUTS ? node_script[step][channel] : 0;
+}
+
+static uint16_t node_adc_wave(uint32_t channel)
+{
+    uint32_t phase = (Host_Millis() + channel * (NODE_WAVE_MS / NODE_ADC_INPUTS)) % NODE_WAVE_MS;
+    uint32_t ramp = phase < NODE_WAVE_MS / 2 ? phase : NODE_WAVE_MS - phase;
+
+    node_noise = node_noise * 1103515245u + 12345u;
+    return (uint16_t) (1024 + ramp * 2048 / (NODE_WAVE_MS / 2) + ((node_noise >> 16) & 15));
+}
+
+static int node_load_script(const char* path)
+{
+    char line[256];
+    char* p;
+    char* end;
+    unsigned long v;
+    int i;
+    FILE* f = fopen(path, "r");
+
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    while (node_script_len < NODE_SCRIPT_STEPS && fgets(line, sizeof(line), f) != NULL) {
+        p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '#' || *p == '\n' || *p == '\0') continue;
+
+        for (i = 0; i < NODE_ADC_INPUTS; i++) {
+            v = strtoul(p, &end, 0);
+            if (end == p) break;
+            node_script[node_script_len][i] = (uint16_t) (v > 0xFFF ? 0xFFF : v);
+            p = end;
+        }
+        node_script_len++;
+    }
+    fclose(f);
+
+    if (node_script_len == 0) {
+        fprintf(stderr, "%s: no readings\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    const char* script = NULL;
+    const char* collector = NULL;
+    unsigned batch = TELEMETRY_BATCH;
+    unsigned long interval = TELEMETRY_INTERVAL_MS;
+    unsigned ip[4];
+    unsigned port;
+    uint8_t dest[4];
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:o:a:s:t:m:i:f:")) != -1) {
+        switch (opt)
+        {
+            case 'b':
+                Posix_SetBindAddress(optarg);
+                break;
+            case 'o':
+                Posix_SetPortOffset(atoi(optarg));
+                break;
+            case 'a':
+                script = optarg;
+                break;
+            case 's':
+                node_step_ms = strtoul(optarg, NULL, 0);
+                if (node_step_ms == 0) node_step_ms = 1;
+                break;
+            case 't':
+                collector = optarg;
+                break;
+            case 'm':
+                batch = (unsigned) strtoul(optarg, NULL, 0);
+                break;
+            case 'i':
+                interval = strtoul(optarg, NULL, 0);
+                break;
+            case 'f':
+                if (Host_FlashOpen(optarg) < 0) return 1;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-b bind-address] [-o port-offset] [-a adc-script] [-s step-ms] [-t collector-ip:port] [-m batch] [-i interval-ms] [-f flash-file]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    if (script != NULL) {
+        if (node_load_script(script) < 0) return 1;
+        Host_SetADCSource(node_adc_script);
+    }
+    else {
+        Host_SetADCSource(node_adc_wave);
+    }
+
+    if (collector != NULL) {
+        if (sscanf(collector, "%u.%u.%u.%u:%u", &ip[0], &ip[1], &ip[2], &ip[3], &port) != 5) {
+            fprintf(stderr, "%s: expected collector-ip:port\n", collector);
+            return 2;
+        }
+        dest[0] = (uint8_t) ip[0];
+        dest[1] = (uint8_t) ip[1];
+        dest[2] = (uint8_t) ip[2];
+        dest[3] = (uint8_t) ip[3];
+        Telemetry_Config(dest, (uint16_t) port, (uint16_t) batch, interval);
+    }
+
+    /* The firmware's UART log goes to stdout */
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    return firmware_main();
+}
@@ -0,0 +1,279 @@
+/**
+ ******************************************************************************
+ * @file    host/resp_bench.c
+ * @author  WIZnet
+ * @brief   Host-side benchmark of the HTTP reply path: counts the send()
+ *          calls, TCP segments and bytes the firmware emits per reply.
+ ******************************************************************************
+ * @attention
+ *
+ * Usage: resp_bench [-n requests] [-k requests-per-adc-change]
+ *                   [-r requests-per-connection] [-B]
+ *
+ * With -r 1 every request opens a new connection and asks for it to be
+ * closed; with -r N the requests are sent N at a time on kept-alive
+ * connections.
+ *
+ * -B measures the baseline instead: every request is answered the way the
+ * original firmware did, with the page sent in eight pieces around the ADC
+ * reading and the gauge value, then the connection is closed.
+ *
+ * Every send() issues one SEND command on the TOE, which puts at least one
+ * segment on the wire; segments are estimated as ceil(len / MSS) per call.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "main.h"
+#include "w7500_host.h"
+#include "w7500_sim.h"
+#include "web_server.h"
+#include "adc_sampler.h"
+
+/* Private define ------------------------------------------------------------*/
+#define BENCH_SOCK     HTTP_SOCK_START
+#define BENCH_MAX_POLL 64
+
+/* Private variables ---------------------------------------------------------*/
+static const char bench_request_keep[] =
+        "GET / HTTP/1.1\r\n"
+        "Host: 192.168.0.10\r\n"
+        "Connection: keep-alive\r\n"
+        "Upgrade-Insecure-Requests: 1\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0 Safari/537.36\r\n"
+        "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,*/*;q=0.8\r\n"
+        "Accept-Encoding: gzip, deflate\r\n"
+        "Accept-Language: en-US,en;q=0.9\r\n"
+        "\r\n";
+
+static const char bench_request_close[] =
+        "GET / HTTP/1.1\r\n"
+        "Host: 192.168.0.10\r\n"
+        "Connection: close\r\n"
+        "Upgrade-Insecure-Requests: 1\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0 Safari/537.36\r\n"
+        "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,*/*;q=0.8\r\n"
+        "Accept-Encoding: gzip, deflate\r\n"
+        "Accept-Language: en-US,en;q=0.9\r\n"
+        "\r\n";
+
+static unsigned long bench_sends;
+static unsigned long bench_segments;
+static unsigned long bench_bytes;
+static unsigned long bench_requests;
+static unsigned long bench_replies;
+static unsigned long bench_connections;
+static unsigned long bench_change_every = 1;
+
+/* Lengths of the fixed pieces of the original reply, in send() order */
+static const uint16_t bench_baseline_chunk[] = { 1401, 372, 11, 57, 32 };
+
+/* Private functions ---------------------------------------------------------*/
+
+static void bench_on_send(uint8_t sn, const uint8_t* buf, uint16_t len)
+{
+    (void) sn;
+    if (len >= 7 && memcmp(buf, "HTTP/1.", 7) == 0) bench_replies++;
+    bench_sends++;
+    bench_segments += (len + SIM_TCP_MSS - 1) / SIM_TCP_MSS;
+    bench_bytes += len;
+}
+
+static uint16_t bench_adc(uint32_t channel)
+{
+    (void) channel;
+    return (uint16_t) (100 + (bench_requests / bench_change_every) % 100);
+}
+
+static void bench_poll(void)
+{
+    WebServer_Run();
+}
+
+static int bench_wait_reply(void)
+{
+    int i;
+
+    for (i = 0; i < BENCH_MAX_POLL && bench_replies < bench_requests; i++) {
+        bench_poll();
+    }
+    return bench_replies == bench_requests ? 0 : -1;
+}
+
+static int bench_wait_state(uint8_t state)
+{
+    int i;
+
+    for (i = 0; i < BENCH_MAX_POLL; i++) {
+        if (getSn_SR(BENCH_SOCK) == state) return 0;
+        bench_poll();
+    }
+    return getSn_SR(BENCH_SOCK) == state ? 0 : -1;
+}
+
+/**
+  * @brief  Answers one request with the original firmware's send() sequence:
+  *         page head, ADC reading, style, gauge value, colour stop, gauge
+  *         value, gauge close and page tail, then disconnects.
+  * @param  sn: socket number
+  * @retval 0 on success, -1 if a send() failed
+  */
+static int bench_baseline_reply(uint8_t sn)
+{
+    /* Contents are irrelevant to the counts, bar the status line */
+    static uint8_t head[1401] = "HTTP/1.1 200 OK\r\n";
+    static uint8_t body[372];
+    uint8_t rx[1024];
+    char value_str[4];
+    char gauge_value_str[4];
+    uint16_t size;
+    int adc_value;
+
+    if ((size = getSn_RX_RSR(sn)) > sizeof(rx)) size = sizeof(rx);
+    if (recv(sn, rx, size) <= 0) return -1;
+
+    adc_value = bench_adc(0);
+    snprintf(value_str, sizeof(value_str), "%d", adc_value);
+    snprintf(gauge_value_str, sizeof(gauge_value_str), "%d", adc_value / 2);
+
+    if (send(sn, head, bench_baseline_chunk[0]) < 0) return -1;
+    if (send(sn, (uint8_t*) value_str, (uint16_t) strlen(value_str)) < 0) return -1;
+    if (send(sn, body, bench_baseline_chunk[1]) < 0) return -1;
+    if (send(sn, (uint8_t*) gauge_value_str, (uint16_t) strlen(gauge_value_str)) < 0) return -1;
+    if (send(sn, body, bench_baseline_chunk[2]) < 0) return -1;
+    if (send(sn, (uint8_t*) gauge_value_str, (uint16_t) strlen(gauge_value_str)) < 0) return -1;
+    if (send(sn, body, bench_baseline_chunk[3]) < 0) return -1;
+    if (send(sn, body, bench_baseline_chunk[4]) < 0) return -1;
+    disconnect(sn);
+    return 0;
+}
+
+/**
+  * @brief  Runs n requests, one connection each, against the baseline reply.
+  * @param  n: number of requests
+  * @param  peer: client address
+  * @retval 0 on success, -1 on failure
+  */
+static int bench_baseline(unsigned long n, const uint8_t* peer)
+{
+    unsigned long i;
+
+    for (i = 0; i < n; i++) {
+        socket(BENCH_SOCK, Sn_MR_TCP, HTTP_PORT, 0x00);
+        listen(BENCH_SOCK);
+        Sim_Connect(BENCH_SOCK, peer, (uint16_t) (40000 + bench_connections % 20000));
+        bench_connections++;
+
+        Sim_AdvanceMs(1000 / SAMPLER_RATE_HZ);
+        Sim_Feed(BENCH_SOCK, bench_request_close, (uint16_t) strlen(bench_request_close));
+        bench_requests++;
+        if (bench_baseline_reply(BENCH_SOCK) < 0) return -1;
+        close(BENCH_SOCK);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    static const uint8_t peer[4] = { 192, 168, 0, 100 };
+    unsigned long n = 1000;
+    unsigned long per_conn = 1;
+    unsigned long i;
+    unsigned long j;
+    const char* req;
+    struct timespec t0, t1;
+    double elapsed_ns;
+    int opt;
+    int baseline = 0;
+    int out_fd;
+    FILE* out;
+
+    while ((opt = getopt(argc, argv, "n:k:r:B")) != -1) {
+        switch (opt)
+        {
+            case 'n':
+                n = strtoul(optarg, NULL, 0);
+                break;
+            case 'k':
+                bench_change_every = strtoul(optarg, NULL, 0);
+                if (bench_change_every == 0) bench_change_every = 1;
+                break;
+            case 'r':
+                per_conn = strtoul(optarg, NULL, 0);
+                if (per_conn == 0) per_conn = 1;
+                break;
+            case 'B':
+                baseline = 1;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n requests] [-k requests-per-adc-change] [-r requests-per-connection] [-B]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    /* The firmware logs every request to stdout; keep the report separate. */
+    fflush(stdout);
+    out_fd = dup(STDOUT_FILENO);
+    out = fdopen(out_fd, "w");
+    freopen("/dev/null", "w", stdout);
+
+    Sim_Reset();
+    Sim_SetSendHook(bench_on_send);
+    Host_SetADCSource(bench_adc);
+    Sampler_Init();
+    DUALTIMER_Init(DUALTIMER0_0, &(DUALTIMER_InitTypDef) { .Timer_Load = GetSystemClock() / SAMPLER_RATE_HZ });
+    DUALTIMER_Cmd(DUALTIMER0_0, ENABLE);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (baseline) {
+        if (bench_baseline(n, peer) < 0) {
+            fprintf(out, "request %lu: send failed\n", bench_requests);
+            return 1;
+        }
+        n = 0;
+    } else {
+        WebServer_Init();
+    }
+    for (i = 0; i < n; ) {
+        if (bench_wait_state(SOCK_LISTEN) < 0) {
+            fprintf(out, "socket %d never reached LISTEN\n", BENCH_SOCK);
+            return 1;
+        }
+        Sim_Connect(BENCH_SOCK, peer, (uint16_t) (40000 + bench_connections % 20000));
+        bench_connections++;
+
+        for (j = 0; j < per_conn && i < n; j++, i++) {
+            /* One ADC scan period between requests */
+            Sim_AdvanceMs(1000 / SAMPLER_RATE_HZ);
+            req = (j + 1 == per_conn || i + 1 == n) ? bench_request_close : bench_request_keep;
+            Sim_Feed(BENCH_SOCK, req, (uint16_t) strlen(req));
+            bench_requests++;
+            if (bench_wait_reply() < 0) {
+                fprintf(out, "request %lu: no reply\n", i);
+                return 1;
+            }
+        }
+
+        if (bench_wait_state(SOCK_CLOSED) < 0) {
+            fprintf(out, "connection %lu was not closed\n", bench_connections);
+            return 1;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    elapsed_ns = (t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec);
+
+    fprintf(out, "replies            : %lu on %lu connections (ADC value changes every %lu)%s\n", bench_replies, bench_connections, bench_change_every,
+            baseline ? ", baseline per-chunk send path" : "");
+    fprintf(out, "send() calls/reply : %.2f\n", (double) bench_sends / bench_requests);
+    fprintf(out, "connections/reply  : %.2f\n", (double) bench_connections / bench_requests);
+    fprintf(out, "TCP segments/reply : %.2f\n", (double) bench_segments / bench_requests);
+    fprintf(out, "bytes/reply        : %.1f\n", (double) bench_bytes / bench_requests);
+    fprintf(out, "host time/reply    : %.0f ns\n", elapsed_ns / bench_requests);
+    fclose(out);
+    return 0;
+}
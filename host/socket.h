@@ -0,0 +1,50 @@
+/**
+ ******************************************************************************
+ * @file    host/socket.h
+ * @author  WIZnet
+ * @brief   Host (Linux) stand-in for the ioLibrary BSD-like socket API.
+ ******************************************************************************
+ */
+
+#ifndef __HOST_SOCKET_H
+#define __HOST_SOCKET_H
+
+#include <stdint.h>
+#include "wizchip_conf.h"
+
+/* Keep the ioLibrary names in the firmware sources from colliding with the
+ * host C library's BSD socket functions. */
+#define socket     wiz_socket
+#define close      wiz_close
+#define listen     wiz_listen
+#define disconnect wiz_disconnect
+#define send       wiz_send
+#define recv       wiz_recv
+#define sendto     wiz_sendto
+
+#define SOCK_OK   1
+#define SOCK_BUSY 0
+
+/* socket() flags */
+#define SF_IO_NONBLOCK 0x01
+
+#define SOCKERR_SOCKNUM    (-1)
+#define SOCKERR_SOCKOPT    (-2)
+#define SOCKERR_SOCKINIT   (-3)
+#define SOCKERR_SOCKCLOSED (-4)
+#define SOCKERR_SOCKMODE   (-5)
+#define SOCKERR_SOCKSTATUS (-7)
+#define SOCKERR_PORTZERO   (-11)
+#define SOCKERR_IPINVALID  (-12)
+#define SOCKERR_TIMEOUT    (-13)
+#define SOCKERR_DATALEN    (-14)
+
+int8_t socket(uint8_t sn, uint8_t protocol, uint16_t port, uint8_t flag);
+int8_t close(uint8_t sn);
+int8_t listen(uint8_t sn);
+int8_t disconnect(uint8_t sn);
+int32_t send(uint8_t sn, uint8_t* buf, uint16_t len);
+int32_t recv(uint8_t sn, uint8_t* buf, uint16_t len);
+int32_t sendto(uint8_t sn, uint8_t* buf, uint16_t len, uint8_t* addr, uint16_t port);
+
+#endif /* __HOST_SOCKET_H */
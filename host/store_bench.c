@@ -0,0 +1,345 @@
+/**
+ ******************************************************************************
+ * @file    host/store_bench.c
+ * @author  WIZnet
+ * @brief   Host-side benchmark and power-loss check of the flash store.
+ ******************************************************************************
+ * @attention
+ *
+ * Usage: store_bench [-n records] [-b records-per-sync] [-t trials]
+ *                    [-s seed]
+ *
+ * The first part writes -n records, mostly hourly rollups with a lease or
+ * calibration now and then, syncing every -b records, and reports the
+ * erases per page, the records per erase and the time of a boot scan of
+ * the full store. A boot of the full store must bring back every state and
+ * the newest rollups.
+ *
+ * The second part runs -t trials on a fresh store. Each queues a few
+ * random records and cuts the power at a random byte of the sync, then
+ * boots the store again and checks what came back:
+ *   - every state is the one last synced or one of those queued since;
+ *   - the rollups are in order, none is invented and none synced is
+ *     missing after the oldest one left;
+ *   - the store takes and syncs records again.
+ * It exits with status 1 on the first trial that fails a check.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "main.h"
+#include "w7500_host.h"
+#include "flash_store.h"
+#include "metrics.h"
+
+/* Private define ------------------------------------------------------------*/
+#define BENCH_KEYS       4                  /* Calibration keys, plus the lease */
+#define BENCH_STATES     (BENCH_KEYS + 1)
+#define BENCH_VALUES     8                  /* Most writes of a state between syncs */
+#define BENCH_ROLLUP_LEN 28
+#define BENCH_STATE_LEN  16
+#define BENCH_LOG_MAX    200000
+#define BENCH_SYNC_MAX   (STORE_QUEUE_SIZE / (BENCH_ROLLUP_LEN + 8))
+
+/* Rollup status */
+#define BENCH_UNWRITTEN  0
+#define BENCH_PENDING    1
+#define BENCH_SYNCED     2
+#define BENCH_LOST       3
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+    uint8_t has;                        /* A value was synced */
+    uint32_t synced;
+    uint8_t pending_num;
+    uint32_t pending[BENCH_VALUES];
+    uint8_t restored_has;
+    uint32_t restored;
+} Bench_State;
+
+/* Private variables ---------------------------------------------------------*/
+static Bench_State bench_state[BENCH_STATES];
+static uint8_t bench_log[BENCH_LOG_MAX];
+static uint32_t bench_log_next;
+static uint32_t bench_restored[BENCH_LOG_MAX];
+static uint32_t bench_restored_num;
+static uint32_t bench_value;
+static uint32_t bench_rand = 1;
+
+/* Private functions ---------------------------------------------------------*/
+
+static uint32_t bench_random(void)
+{
+    bench_rand = bench_rand * 1103515245u + 12345u;
+    return bench_rand >> 8;
+}
+
+static double bench_seconds(const struct timespec* t0, const struct timespec* t1)
+{
+    return (double) (t1->tv_sec - t0->tv_sec) + (double) (t1->tv_nsec - t0->tv_nsec) / 1e9;
+}
+
+static uint8_t bench_state_type(uint8_t s)
+{
+    return s < BENCH_KEYS ? STORE_REC_CALIBRATION : STORE_REC_LEASE;
+}
+
+static void bench_restore(uint8_t type, uint8_t key, const uint8_t* data, uint8_t len)
+{
+    uint32_t v;
+
+    memcpy(&v, data, sizeof(v));
+    if (type == STORE_REC_ROLLUP && len == BENCH_ROLLUP_LEN) {
+        if (bench_restored_num < BENCH_LOG_MAX) bench_restored[bench_restored_num++] = v;
+    }
+    else if (type == STORE_REC_CALIBRATION && key < BENCH_KEYS && len == BENCH_STATE_LEN) {
+        bench_state[key].restored_has = 1;
+        bench_state[key].restored = v;
+    }
+    else if (type == STORE_REC_LEASE && key == 0 && len == BENCH_STATE_LEN) {
+        bench_state[BENCH_KEYS].restored_has = 1;
+        bench_state[BENCH_KEYS].restored = v;
+    }
+}
+
+static void bench_boot(void)
+{
+    uint8_t s;
+
+    bench_restored_num = 0;
+    for (s = 0; s < BENCH_STATES; s++) bench_state[s].restored_has = 0;
+    Store_Init(bench_restore);
+}
+
+static void bench_erase(void)
+{
+    uint8_t p;
+
+    for (p = 0; p < STORE_PAGE_NUM; p++) Flash_EraseBlock(STORE_BASE + p * STORE_PAGE_SIZE);
+}
+
+/* Queues a random record and tracks it in the model */
+static int bench_write(uint32_t rollup_every)
+{
+    uint8_t data[BENCH_ROLLUP_LEN];
+    Bench_State* st;
+    uint8_t s;
+
+    memset(data, 0xA5, sizeof(data));
+    if (bench_random() % rollup_every != 0) {
+        if (bench_log_next >= BENCH_LOG_MAX) return -1;
+        memcpy(data, &bench_log_next, 4);
+        if (Store_Write(STORE_REC_ROLLUP, 2, data, BENCH_ROLLUP_LEN) < 0) return -1;
+        bench_log[bench_log_next++] = BENCH_PENDING;
+        return 0;
+    }
+
+    s = (uint8_t) (bench_random() % BENCH_STATES);
+    st = &bench_state[s];
+    if (st->pending_num == BENCH_VALUES) return -1;
+    bench_value++;
+    memcpy(data, &bench_value, 4);
+    if (Store_Write(bench_state_type(s), s < BENCH_KEYS ? s : 0, data, BENCH_STATE_LEN) < 0) return -1;
+    st->pending[st->pending_num++] = bench_value;
+    return 0;
+}
+
+/* Marks everything queued as synced */
+static void bench_synced(void)
+{
+    Bench_State* st;
+    uint32_t i;
+    uint8_t s;
+
+    for (s = 0; s < BENCH_STATES; s++) {
+        st = &bench_state[s];
+        if (st->pending_num > 0) {
+            st->has = 1;
+            st->synced = st->pending[st->pending_num - 1];
+            st->pending_num = 0;
+        }
+    }
+    for (i = bench_log_next; i > 0 && bench_log[i - 1] == BENCH_PENDING; i--) bench_log[i - 1] = BENCH_SYNCED;
+}
+
+/* Checks what a boot after a power cut brought back, then takes it as the
+ * synced state */
+static int bench_check(unsigned long trial)
+{
+    Bench_State* st;
+    uint32_t i;
+    uint32_t v;
+    uint32_t first;
+    uint8_t s;
+    uint8_t k;
+    uint8_t ok;
+
+    for (s = 0; s < BENCH_STATES; s++) {
+        st = &bench_state[s];
+        ok = (!st->restored_has && !st->has) || (st->restored_has && st->has && st->restored == st->synced);
+        for (k = 0; k < st->pending_num && !ok; k++) {
+            ok = st->restored_has && st->restored == st->pending[k];
+        }
+        if (!ok) {
+            printf("trial %lu: state %u restored as %lu, synced %lu\n", trial, s,
+                   st->restored_has ? (unsigned long) st->restored : 0ul, st->has ? (unsigned long) st->synced : 0ul);
+            return -1;
+        }
+        st->has = st->restored_has;
+        st->synced = st->restored;
+        st->pending_num = 0;
+    }
+
+    for (i = 0; i < bench_restored_num; i++) {
+        v = bench_restored[i];
+        if (v >= bench_log_next || bench_log[v] == BENCH_UNWRITTEN || bench_log[v] == BENCH_LOST) {
+            printf("trial %lu: rollup %lu restored but never synced\n", trial, (unsigned long) v);
+            return -1;
+        }
+        if (i > 0 && v <= bench_restored[i - 1]) {
+            printf("trial %lu: rollup %lu restored after %lu\n", trial, (unsigned long) v, (unsigned long) bench_restored[i - 1]);
+            return -1;
+        }
+        bench_log[v] = BENCH_SYNCED;
+    }
+
+    first = bench_restored_num ? bench_restored[0] : bench_log_next;
+    for (v = first, i = 0; v < bench_log_next; v++) {
+        if (bench_log[v] == BENCH_PENDING) {
+            bench_log[v] = BENCH_LOST;
+            continue;
+        }
+        if (bench_log[v] != BENCH_SYNCED) continue;
+        while (i < bench_restored_num && bench_restored[i] < v) i++;
+        if (i == bench_restored_num || bench_restored[i] != v) {
+            printf("trial %lu: synced rollup %lu missing\n", trial, (unsigned long) v);
+            return -1;
+        }
+    }
+    for (v = 0; v < first; v++) {
+        if (bench_log[v] == BENCH_PENDING) bench_log[v] = BENCH_LOST;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    struct timespec t0, t1;
+    unsigned long records = 20000;
+    unsigned long per_sync = 4;
+    unsigned long trials = 2000;
+    unsigned long cuts = 0;
+    unsigned long i;
+    uint32_t erases;
+    uint32_t min = 0xFFFFFFFF;
+    uint32_t max = 0;
+    uint32_t n;
+    uint32_t scans;
+    double write_s;
+    uint8_t p;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:b:t:s:")) != -1) {
+        switch (opt)
+        {
+            case 'n':
+                records = strtoul(optarg, NULL, 0);
+                break;
+            case 'b':
+                per_sync = strtoul(optarg, NULL, 0);
+                if (per_sync == 0) per_sync = 1;
+                break;
+            case 't':
+                trials = strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                bench_rand = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n records] [-b records-per-sync] [-t trials] [-s seed]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (records > BENCH_LOG_MAX / 2) records = BENCH_LOG_MAX / 2;
+    if (per_sync > BENCH_SYNC_MAX) per_sync = BENCH_SYNC_MAX;
+
+    /* Wear and throughput */
+    bench_boot();
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < records; i++) {
+        if (bench_write(100) < 0 || ((i + 1) % per_sync == 0 && Store_Sync() < 0)) {
+            printf("record %lu: write failed\n", i);
+            return 1;
+        }
+        if ((i + 1) % per_sync == 0) bench_synced();
+    }
+    Store_Sync();
+    bench_synced();
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    write_s = bench_seconds(&t0, &t1);
+
+    erases = metrics_counter[METRICS_FLASH_ERASES];
+    for (p = 0; p < STORE_PAGE_NUM; p++) {
+        n = Host_FlashEraseCount((STORE_BASE / FLASH_BLOCK_SIZE) + p);
+        if (n < min) min = n;
+        if (n > max) max = n;
+    }
+
+    /* A clean boot brings back every state and the newest rollups */
+    bench_boot();
+    if (bench_check(records) < 0) return 1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (scans = 0; scans < 100; scans++) bench_boot();
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    printf("store              : %u pages of %u bytes\n", STORE_PAGE_NUM, STORE_PAGE_SIZE);
+    printf("records            : %lu, %lu per sync\n", records, per_sync);
+    printf("erases             : %lu, %lu..%lu per page\n", (unsigned long) erases, (unsigned long) min, (unsigned long) max);
+    printf("records/erase      : %.1f\n", erases ? (double) records / erases : 0.0);
+    printf("hourly rollups     : each page erased every %.0f days\n", erases ? (double) records / erases * STORE_PAGE_NUM / 24 : 0.0);
+    printf("write+sync/record  : %.2f us\n", write_s * 1e6 / (double) records);
+    printf("boot scan          : %.1f us\n", bench_seconds(&t0, &t1) * 1e6 / scans);
+
+    /* Power loss */
+    bench_erase();
+    memset(bench_state, 0, sizeof(bench_state));
+    memset(bench_log, 0, sizeof(bench_log));
+    bench_log_next = 0;
+    bench_boot();
+
+    for (i = 0; i < trials; i++) {
+        n = 1 + bench_random() % BENCH_SYNC_MAX;
+        while (n--) bench_write(4);
+
+        Host_FlashPowerFail(bench_random() % 400);
+        if (Store_Sync() == 0) {
+            Host_FlashPowerOn();
+            bench_synced();
+            continue;
+        }
+        if (!Host_FlashPowerLost()) {
+            printf("trial %lu: sync failed without a power cut\n", i);
+            return 1;
+        }
+        cuts++;
+
+        Host_FlashPowerOn();
+        bench_boot();
+        if (bench_check(i) < 0) return 1;
+
+        /* The records queued again by the boot must go out */
+        if (Store_Sync() < 0) {
+            printf("trial %lu: store not writable after the cut\n", i);
+            return 1;
+        }
+    }
+
+    printf("power-loss trials  : %lu, %lu cut, all states old or new, rollups in order\n", trials, cuts);
+    return 0;
+}
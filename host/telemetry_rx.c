@@ -0,0 +1,173 @@
+/**
+ ******************************************************************************
+ * @file    host/telemetry_rx.c
+ * @author  WIZnet
+ * @brief   Minimal collector for the UDP telemetry push: prints the samples
+ *          and counts lost datagrams per node.
+ ******************************************************************************
+ * @attention
+ *
+ * Usage: telemetry_rx [-p port] [-q]
+ *
+ * Listens on 0.0.0.0:port (default 9100). Every datagram is printed with
+ * its samples, or, with -q, only counted. The per-node totals are printed
+ * when the receiver is interrupted.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+/* Private define ------------------------------------------------------------*/
+#define RX_MAX_NODES 256
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+    char mac[13];
+    unsigned long next_seq;
+    unsigned long datagrams;
+    unsigned long lost;
+    unsigned long samples;
+    unsigned long last_sample;
+    unsigned long sample_gaps;
+} RX_Node;
+
+/* Private variables ---------------------------------------------------------*/
+static RX_Node rx_node[RX_MAX_NODES];
+static int rx_node_count;
+static unsigned long rx_malformed;
+static volatile sig_atomic_t rx_stop;
+
+/* Private functions ---------------------------------------------------------*/
+
+static void rx_on_signal(int sig)
+{
+    (void) sig;
+    rx_stop = 1;
+}
+
+static RX_Node* rx_find(const char* mac)
+{
+    int i;
+
+    for (i = 0; i < rx_node_count; i++) {
+        if (strcmp(rx_node[i].mac, mac) == 0) return &rx_node[i];
+    }
+    if (rx_node_count == RX_MAX_NODES) return NULL;
+
+    memset(&rx_node[rx_node_count], 0, sizeof(RX_Node));
+    snprintf(rx_node[rx_node_count].mac, sizeof(rx_node[0].mac), "%s", mac);
+    return &rx_node[rx_node_count++];
+}
+
+static void rx_datagram(char* data, const struct sockaddr_in* from, int quiet)
+{
+    char mac[13];
+    unsigned long seq;
+    unsigned long sample;
+    unsigned count;
+    RX_Node* node;
+    char* line;
+    char* next;
+
+    if (sscanf(data, "SM1 %12s %lu %u", mac, &seq, &count) != 3 || (node = rx_find(mac)) == NULL) {
+        rx_malformed++;
+        return;
+    }
+
+    if (node->datagrams > 0 && seq > node->next_seq) node->lost += seq - node->next_seq;
+    node->next_seq = seq + 1;
+    node->datagrams++;
+
+    if (!quiet) printf("%s (%s) datagram %lu, %u samples\n", mac, inet_ntoa(from->sin_addr), seq, count);
+
+    line = strchr(data, '\n');
+    while (line != NULL && *++line != '\0') {
+        next = strchr(line, '\n');
+        if (next != NULL) *next = '\0';
+
+        sample = strtoul(line, NULL, 10);
+        if (node->samples > 0 && sample > node->last_sample + 1) node->sample_gaps += sample - node->last_sample - 1;
+        node->last_sample = sample;
+        node->samples++;
+        if (!quiet) printf("  %s\n", line);
+
+        line = next;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    struct sockaddr_in addr;
+    struct sockaddr_in from;
+    struct sigaction sa;
+    socklen_t from_len;
+    char buf[2048];
+    ssize_t n;
+    int port = 9100;
+    int quiet = 0;
+    int opt;
+    int fd;
+    int i;
+
+    while ((opt = getopt(argc, argv, "p:q")) != -1) {
+        switch (opt)
+        {
+            case 'p':
+                port = atoi(optarg);
+                break;
+            case 'q':
+                quiet = 1;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-p port] [-q]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t) port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (fd < 0 || bind(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0) {
+        perror("bind");
+        return 1;
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = rx_on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    while (!rx_stop) {
+        from_len = sizeof(from);
+        n = recvfrom(fd, buf, sizeof(buf) - 1, 0, (struct sockaddr*) &from, &from_len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("recvfrom");
+            return 1;
+        }
+        buf[n] = '\0';
+        rx_datagram(buf, &from, quiet);
+    }
+
+    printf("\n%-12s %10s %8s %10s %12s\n", "node", "datagrams", "lost", "samples", "sample gaps");
+    for (i = 0; i < rx_node_count; i++) {
+        printf("%-12s %10lu %8lu %10lu %12lu\n", rx_node[i].mac, rx_node[i].datagrams, rx_node[i].lost, rx_node[i].samples, rx_node[i].sample_gaps);
+    }
+    if (rx_malformed) printf("malformed datagrams: %lu\n", rx_malformed);
+    return 0;
+}
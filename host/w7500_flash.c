@@ -0,0 +1,140 @@
+/**
+ ******************************************************************************
+ * @file    host/w7500_flash.c
+ * @author  WIZnet
+ * @brief   Model of the W7500x code flash, standing in for flash_if.c on
+ *          the host.
+ ******************************************************************************
+ * @attention
+ *
+ * The flash is a RAM array of FLASH_SIZE bytes that starts erased. As on
+ * NOR flash an erase sets a whole block to 0xFF and programming can only
+ * clear bits, so a word written twice without an erase reads back as the
+ * AND of both.
+ *
+ * Host_FlashOpen() backs the array with a file, loaded at start and
+ * written through on every change, so a node keeps its store across runs.
+ *
+ * Host_FlashPowerFail() cuts the power after a number of bytes have been
+ * programmed, an erase counting as one: the program in flight stops at
+ * that byte, which keeps only some of its new zero bits, and an erase in
+ * flight leaves the first half of its block erased and the rest as it
+ * was. Until Host_FlashPowerOn() every erase and program fails and changes
+ * nothing.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include "main.h"
+#include "flash_if.h"
+#include "w7500_host.h"
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t host_flash[FLASH_SIZE] = { [0 ... FLASH_SIZE - 1] = 0xFF };
+static uint32_t host_flash_erases[FLASH_SIZE / FLASH_BLOCK_SIZE];
+static FILE* host_flash_file;
+static uint8_t host_flash_cut;          /* Power fail armed */
+static uint8_t host_flash_off;          /* Power lost */
+static uint32_t host_flash_budget;      /* Bytes left before the cut */
+static uint32_t host_flash_noise = 1;
+
+/* Private functions ---------------------------------------------------------*/
+
+static void host_flash_sync(uint32_t addr, uint32_t len)
+{
+    if (host_flash_file == NULL) return;
+
+    fseek(host_flash_file, (long) addr, SEEK_SET);
+    fwrite(host_flash + addr, 1, len, host_flash_file);
+    fflush(host_flash_file);
+}
+
+int Host_FlashOpen(const char* path)
+{
+    size_t n;
+
+    host_flash_file = fopen(path, "r+b");
+    if (host_flash_file == NULL) {
+        host_flash_file = fopen(path, "w+b");
+        if (host_flash_file == NULL) {
+            perror(path);
+            return -1;
+        }
+        host_flash_sync(0, FLASH_SIZE);
+        return 0;
+    }
+
+    n = fread(host_flash, 1, FLASH_SIZE, host_flash_file);
+    if (n < FLASH_SIZE) host_flash_sync((uint32_t) n, FLASH_SIZE - (uint32_t) n);
+    return 0;
+}
+
+void Host_FlashPowerFail(uint32_t after_bytes)
+{
+    host_flash_cut = 1;
+    host_flash_budget = after_bytes;
+}
+
+void Host_FlashPowerOn(void)
+{
+    host_flash_cut = 0;
+    host_flash_off = 0;
+}
+
+int Host_FlashPowerLost(void)
+{
+    return host_flash_off;
+}
+
+uint32_t Host_FlashEraseCount(uint32_t block)
+{
+    return block < FLASH_SIZE / FLASH_BLOCK_SIZE ? host_flash_erases[block] : 0;
+}
+
+int8_t Flash_EraseBlock(uint32_t addr)
+{
+    uint32_t len = FLASH_BLOCK_SIZE;
+
+    if (addr >= FLASH_SIZE || (addr & (FLASH_BLOCK_SIZE - 1)) != 0) return -1;
+    if (host_flash_off) return -1;
+
+    if (host_flash_cut && host_flash_budget-- == 0) {
+        host_flash_off = 1;
+        len /= 2;
+    }
+
+    memset(host_flash + addr, 0xFF, len);
+    host_flash_erases[addr / FLASH_BLOCK_SIZE]++;
+    host_flash_sync(addr, len);
+    return host_flash_off ? -1 : 0;
+}
+
+int8_t Flash_Program(uint32_t addr, const void* data, uint32_t len)
+{
+    const uint8_t* src = (const uint8_t*) data;
+    uint32_t i;
+
+    if (addr + len > FLASH_SIZE || ((addr | len) & 3) != 0) return -1;
+    if (host_flash_off) return -1;
+
+    for (i = 0; i < len; i++) {
+        if (host_flash_cut && host_flash_budget-- == 0) {
+            /* The byte in flight keeps some of its new zero bits */
+            host_flash_noise = host_flash_noise * 1103515245u + 12345u;
+            host_flash[addr + i] &= (uint8_t) (src[i] | (host_flash_noise >> 16));
+            host_flash_off = 1;
+            break;
+        }
+        host_flash[addr + i] &= src[i];
+    }
+
+    host_flash_sync(addr, i < len ? i + 1 : len);
+    return host_flash_off ? -1 : 0;
+}
+
+void Flash_Read(uint32_t addr, void* out, uint32_t len)
+{
+    memcpy(out, host_flash + addr, len);
+}
@@ -0,0 +1,45 @@
+/**
+ ******************************************************************************
+ * @file    host/w7500_host.h
+ * @author  WIZnet
+ * @brief   Peripheral model shared by the host socket backends: time base,
+ *          interrupt dispatch and the ADC source.
+ ******************************************************************************
+ * @attention
+ *
+ * Two interchangeable backends provide the WZTOE registers and socket API:
+ * w7500_sim.c keeps the sockets in memory and advances time only when told
+ * to, w7500_posix.c maps them onto non-blocking POSIX sockets and runs the
+ * time base from a real interval timer. Each backend defines
+ * Host_TickStart(), which SysTick_Config() calls, and Host_Sleep(), which
+ * waits for the next interrupt source for __WFI().
+ *
+ * w7500_flash.c models the code flash behind flash_if.h, with optional file
+ * backing and injected power loss.
+ *
+ ******************************************************************************
+ */
+
+#ifndef __HOST_W7500_HOST_H
+#define __HOST_W7500_HOST_H
+
+#include <stdint.h>
+
+typedef uint16_t (*Host_ADCSource)(uint32_t channel);
+
+void Host_SetADCSource(Host_ADCSource source);
+void Host_TickMs(void);
+uint32_t Host_Millis(void);
+
+/* Code flash model */
+int Host_FlashOpen(const char* path);
+void Host_FlashPowerFail(uint32_t after_bytes);
+void Host_FlashPowerOn(void);
+int Host_FlashPowerLost(void);
+uint32_t Host_FlashEraseCount(uint32_t block);
+
+/* Provided by the socket backend */
+void Host_TickStart(void);
+void Host_Sleep(void);
+
+#endif /* __HOST_W7500_HOST_H */
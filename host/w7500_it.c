@@ -0,0 +1,69 @@
+/**
+ ******************************************************************************
+ * @file    host/w7500_it.c
+ * @author  WIZnet
+ * @brief   Host counterpart of W7500x_it.c: the interrupt handlers the
+ *          host backends invoke as time advances.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "adc_sampler.h"
+#include "dhcp.h"
+#include "event_loop.h"
+#include "log.h"
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t dualtimer0_div;
+
+/* External functions --------------------------------------------------------*/
+extern void TimingDelay_Decrement(void);
+
+/**
+ * @brief  This function handles SysTick Handler.
+ * @param  None
+ * @retval None
+ */
+void SysTick_Handler(void)
+{
+    TimingDelay_Decrement();
+}
+
+/**
+ * @brief  This function handles DUALTIMER0 Handler.
+ * @param  None
+ * @retval None
+ */
+void DUALTIMER0_Handler(void)
+{
+    Sampler_TimerHandler();
+    Event_Post(EVENT_SAMPLE);
+
+    /* The DHCP client counts whole seconds */
+    if (++dualtimer0_div >= SAMPLER_RATE_HZ) {
+        dualtimer0_div = 0;
+        DHCP_time_handler();
+        Event_Post(EVENT_SECOND);
+    }
+}
+
+/**
+ * @brief  This function handles WZTOE Handler.
+ * @param  None
+ * @retval None
+ */
+void WZTOE_Handler(void)
+{
+    Event_SocketHandler();
+}
+
+/**
+ * @brief  This function handles UART2 Handler.
+ * @param  None
+ * @retval None
+ */
+void UART2_Handler(void)
+{
+    Log_UartHandler();
+}
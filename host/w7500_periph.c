@@ -0,0 +1,422 @@
+/**
+ ******************************************************************************
+ * @file    host/w7500_periph.c
+ * @author  WIZnet
+ * @brief   Model of the W7500x peripherals and DHCP client shared by the host
+ *          socket backends.
+ ******************************************************************************
+ * @attention
+ *
+ * Host_TickMs() stands for one millisecond of time: it raises the SysTick
+ * interrupt and, once per programmed period while the timer is enabled, the
+ * DUALTIMER0 interrupt. The backend decides where time comes from.
+ *
+ * The simple UART shifts out 11 bytes per millisecond, 115200 baud, to
+ * stdout and raises its TX interrupt after each.
+ *
+ * wizchip_init() keeps the buffer size of every socket; the backends size
+ * Sn_TX_FSR, Sn_RX_RSR and send() by them.
+ *
+ * PRIMASK blocks the timer signal. The WZTOE interrupt is raised from
+ * Sn_IR, Sn_IMR and SIMR whenever the firmware unmasks interrupts or wakes
+ * from __WFI(), the points at which the chip would take it at the latest.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include "main.h"
+#include "wizchip_conf.h"
+#include "dhcp.h"
+#include "w7500_host.h"
+
+/* Private variables ---------------------------------------------------------*/
+static GPIO_TypeDef gpiob = { 1 };
+static GPIO_TypeDef gpioc = { 2 };
+static UART_TypeDef uart1 = { 1 };
+static DUALTIMER_TypeDef dualtimer0_0 = { 0 };
+
+GPIO_TypeDef* const GPIOB = &gpiob;
+GPIO_TypeDef* const GPIOC = &gpioc;
+UART_TypeDef* const UART1 = &uart1;
+DUALTIMER_TypeDef* const DUALTIMER0_0 = &dualtimer0_0;
+
+static Host_ADCSource host_adc_source;
+static uint32_t host_adc_channel;
+static wiz_NetInfo host_netinfo;
+static volatile uint32_t host_ms;
+static uint32_t host_timer_load;
+static uint8_t host_timer_on;
+static uint32_t host_timer_elapsed_ms;
+static SysTick_Type host_systick;
+static volatile uint64_t host_tick_ns;
+static volatile uint32_t host_in_irq;
+static uint32_t host_primask;
+static uint8_t host_wztoe_on;
+static uint8_t host_simr;
+static uint8_t host_imr[_WIZCHIP_SOCK_NUM_] = { [0 ... _WIZCHIP_SOCK_NUM_ - 1] = 0xFF };
+
+/* Socket buffer sizes in KB, 2 KB each after reset */
+static uint8_t host_txbuf_kb[_WIZCHIP_SOCK_NUM_] = { [0 ... _WIZCHIP_SOCK_NUM_ - 1] = 2 };
+static uint8_t host_rxbuf_kb[_WIZCHIP_SOCK_NUM_] = { [0 ... _WIZCHIP_SOCK_NUM_ - 1] = 2 };
+
+extern void SysTick_Handler(void);
+extern void DUALTIMER0_Handler(void);
+extern void WZTOE_Handler(void);
+extern void UART2_Handler(void);
+
+/* Bytes the simple UART sends per millisecond */
+#define HOST_UART_BYTES_PER_MS 11
+
+static uint8_t host_uart_txi_on;
+static uint8_t host_uart_irq_on;
+static volatile uint8_t host_uart_txi;
+static volatile uint8_t host_uart_busy;
+static char host_uart_out[64];
+static volatile uint16_t host_uart_len;
+
+static uint64_t host_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+/* Completes the bytes the UART sends in a millisecond */
+static void host_uart_tick(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < HOST_UART_BYTES_PER_MS && host_uart_busy; i++) {
+        host_uart_busy = 0;
+        host_uart_txi = 1;
+        if (host_uart_txi_on && host_uart_irq_on) UART2_Handler();
+    }
+
+    if (host_uart_len > 0) {
+        if (write(STDOUT_FILENO, host_uart_out, host_uart_len) < 0) {
+            /* Nowhere to log to */
+        }
+        host_uart_len = 0;
+    }
+}
+
+/* Host control --------------------------------------------------------------*/
+
+void Host_SetADCSource(Host_ADCSource source)
+{
+    host_adc_source = source;
+}
+
+void Host_TickMs(void)
+{
+    uint32_t period_ms = (uint32_t) ((uint64_t) host_timer_load * 1000 / GetSystemClock());
+
+    host_in_irq++;
+    host_tick_ns = host_now_ns();
+    host_ms++;
+    SysTick_Handler();
+    if (host_timer_on && period_ms && ++host_timer_elapsed_ms >= period_ms) {
+        host_timer_elapsed_ms = 0;
+        DUALTIMER0_Handler();
+    }
+    host_uart_tick();
+    host_in_irq--;
+}
+
+uint32_t Host_Millis(void)
+{
+    return host_ms;
+}
+
+int8_t ctlnetwork(ctlnetwork_type cntype, void* arg)
+{
+    if (cntype == CN_SET_NETINFO) memcpy(&host_netinfo, arg, sizeof(host_netinfo));
+    else memcpy(arg, &host_netinfo, sizeof(host_netinfo));
+    return 0;
+}
+
+/* Refuses sizes the TOE has no setting for and more than its 16 KB of
+ * buffer memory per direction */
+static int host_bufsize_check(const uint8_t* size)
+{
+    uint8_t total = 0;
+    uint8_t sn;
+
+    for (sn = 0; sn < _WIZCHIP_SOCK_NUM_; sn++) {
+        if (size[sn] > 16 || (size[sn] & (size[sn] - 1)) != 0) return -1;
+        total += size[sn];
+    }
+    return total > 16 ? -1 : 0;
+}
+
+int8_t wizchip_init(uint8_t* txsize, uint8_t* rxsize)
+{
+    if ((txsize && host_bufsize_check(txsize) < 0) || (rxsize && host_bufsize_check(rxsize) < 0)) return -1;
+
+    if (txsize) memcpy(host_txbuf_kb, txsize, sizeof(host_txbuf_kb));
+    if (rxsize) memcpy(host_rxbuf_kb, rxsize, sizeof(host_rxbuf_kb));
+    return 0;
+}
+
+int8_t ctlwizchip(ctlwizchip_type cwtype, void* arg)
+{
+    uint8_t* size = (uint8_t*) arg;
+
+    if (cwtype != CW_INIT_WIZCHIP) return -1;
+    return wizchip_init(size, size ? size + _WIZCHIP_SOCK_NUM_ : 0);
+}
+
+uint8_t getSn_TXBUF_SIZE(uint8_t sn)
+{
+    return host_txbuf_kb[sn];
+}
+
+uint8_t getSn_RXBUF_SIZE(uint8_t sn)
+{
+    return host_rxbuf_kb[sn];
+}
+
+/* Interrupts ----------------------------------------------------------------*/
+
+static void host_signal_mask(int how)
+{
+    sigset_t set;
+
+    sigemptyset(&set);
+    sigaddset(&set, SIGALRM);
+    sigprocmask(how, &set, NULL);
+}
+
+/* Takes the WZTOE interrupt if it is pending and may be taken */
+static void host_wztoe_check(void)
+{
+    if (!host_wztoe_on || host_primask || host_in_irq) return;
+
+    if (getSIR() & host_simr) {
+        host_in_irq++;
+        WZTOE_Handler();
+        host_in_irq--;
+    }
+}
+
+void __disable_irq(void)
+{
+    if (host_in_irq) return;
+    host_signal_mask(SIG_BLOCK);
+    host_primask = 1;
+}
+
+void __enable_irq(void)
+{
+    if (host_in_irq) return;
+    host_primask = 0;
+    host_signal_mask(SIG_UNBLOCK);
+    host_wztoe_check();
+}
+
+uint32_t __get_PRIMASK(void)
+{
+    return host_primask || host_in_irq;
+}
+
+void __set_PRIMASK(uint32_t primask)
+{
+    if (primask) __disable_irq();
+    else __enable_irq();
+}
+
+void __WFI(void)
+{
+    Host_Sleep();
+    host_wztoe_check();
+}
+
+uint8_t getSIR(void)
+{
+    uint8_t sir = 0;
+    uint8_t sn;
+
+    for (sn = 0; sn < _WIZCHIP_SOCK_NUM_; sn++) {
+        if (getSn_IR(sn) & host_imr[sn]) sir |= (uint8_t) (1 << sn);
+    }
+    return sir;
+}
+
+uint8_t getSIMR(void)
+{
+    return host_simr;
+}
+
+void setSIMR(uint8_t simr)
+{
+    host_simr = simr;
+}
+
+uint8_t getSn_IMR(uint8_t sn)
+{
+    return host_imr[sn];
+}
+
+void setSn_IMR(uint8_t sn, uint8_t imr)
+{
+    host_imr[sn] = imr;
+}
+
+/* DHCP client ---------------------------------------------------------------*/
+
+/* The lease is granted HOST_DHCP_OFFER_S seconds of DHCP time after start,
+ * so the firmware runs without an address for a moment as on a real LAN */
+#define HOST_DHCP_OFFER_S 1
+
+static void (*host_dhcp_assign)(void);
+static volatile uint32_t host_dhcp_s;
+static uint8_t host_dhcp_leased;
+
+void DHCP_init(uint8_t s, uint8_t* buf)
+{
+    (void) s;
+    (void) buf;
+    host_dhcp_s = 0;
+    host_dhcp_leased = 0;
+}
+
+void reg_dhcp_cbfunc(void (*ip_assign)(void), void (*ip_update)(void), void (*ip_conflict)(void))
+{
+    (void) ip_update;
+    (void) ip_conflict;
+    host_dhcp_assign = ip_assign;
+}
+
+uint8_t DHCP_run(void)
+{
+    if (host_dhcp_leased) return DHCP_IP_LEASED;
+    if (host_dhcp_s < HOST_DHCP_OFFER_S) return DHCP_RUNNING;
+
+    host_dhcp_leased = 1;
+    if (host_dhcp_assign) host_dhcp_assign();
+    return DHCP_IP_ASSIGN;
+}
+
+void DHCP_stop(void)
+{
+    host_dhcp_leased = 0;
+}
+
+void DHCP_time_handler(void)
+{
+    host_dhcp_s++;
+}
+
+void getIPfromDHCP(uint8_t* ip)
+{
+    ip[0] = 127; ip[1] = 0; ip[2] = 0; ip[3] = 1;
+}
+
+void getGWfromDHCP(uint8_t* ip)
+{
+    memset(ip, 0, 4);
+}
+
+void getSNfromDHCP(uint8_t* ip)
+{
+    ip[0] = 255; ip[1] = 0; ip[2] = 0; ip[3] = 0;
+}
+
+void getDNSfromDHCP(uint8_t* ip)
+{
+    memset(ip, 0, 4);
+}
+
+uint32_t getDHCPLeasetime(void)
+{
+    return 86400;
+}
+
+/* Peripherals ---------------------------------------------------------------*/
+
+void SystemInit(void) { }
+uint32_t SysTick_Config(uint32_t ticks)
+{
+    host_systick.LOAD = ticks - 1;
+    host_systick.VAL = ticks - 1;
+    host_tick_ns = host_now_ns();
+    Host_TickStart();
+    return 0;
+}
+
+SysTick_Type* Host_SysTick(void)
+{
+    uint64_t elapsed = host_now_ns() - host_tick_ns;
+    uint64_t counted = elapsed * (host_systick.LOAD + 1) / 1000000u;
+
+    /* Counts down once per cycle from LOAD to 0 within a millisecond */
+    host_systick.VAL = counted > host_systick.LOAD ? 0 : (uint32_t) (host_systick.LOAD - counted);
+    return &host_systick;
+}
+uint32_t GetSystemClock(void) { return 48000000; }
+uint32_t GetSourceClock(void) { return 8000000; }
+void setTIC100US(uint32_t tic) { (void) tic; }
+
+void UART_StructInit(UART_InitTypeDef* UART_InitStruct) { UART_InitStruct->UART_BaudRate = 115200; }
+void UART_Init(UART_TypeDef* UARTx, UART_InitTypeDef* UART_InitStruct) { (void) UARTx; (void) UART_InitStruct; }
+void UART_Cmd(UART_TypeDef* UARTx, FunctionalState NewState) { (void) UARTx; (void) NewState; }
+void S_UART_Init(uint32_t baud) { (void) baud; }
+void S_UART_Cmd(FunctionalState NewState) { (void) NewState; }
+void UART_ITConfig(UART_TypeDef* UARTx, uint16_t UART_IT, FunctionalState NewState) { (void) UARTx; (void) UART_IT; (void) NewState; }
+ITStatus UART_GetITStatus(UART_TypeDef* UARTx, uint16_t UART_IT) { (void) UARTx; (void) UART_IT; return RESET; }
+void UART_ClearITPendingBit(UART_TypeDef* UARTx, uint16_t UART_IT) { (void) UARTx; (void) UART_IT; }
+void UART_SendData(UART_TypeDef* UARTx, uint16_t Data) { (void) UARTx; (void) Data; }
+
+void S_UART_ITConfig(uint16_t S_UART_IT, FunctionalState NewState)
+{
+    if (S_UART_IT & S_UART_CTRL_TXI) host_uart_txi_on = NewState == ENABLE;
+}
+
+ITStatus S_UART_GetITStatus(uint16_t S_UART_IT)
+{
+    return (S_UART_IT & S_UART_INTSTATUS_TXI) && host_uart_txi ? SET : RESET;
+}
+
+void S_UART_ClearITPendingBit(uint16_t S_UART_IT)
+{
+    if (S_UART_IT & S_UART_INTSTATUS_TXI) host_uart_txi = 0;
+}
+
+void S_UART_SendData(uint16_t Data)
+{
+    if (host_uart_len < sizeof(host_uart_out)) host_uart_out[host_uart_len++] = (char) Data;
+    host_uart_busy = 1;
+}
+
+void GPIO_Init(GPIO_TypeDef* GPIOx, GPIO_InitTypeDef* GPIO_InitStruct) { (void) GPIOx; (void) GPIO_InitStruct; }
+
+void DUALTIMER_Init(DUALTIMER_TypeDef* DUALTIMERn, DUALTIMER_InitTypDef* DUALTIMER_InitStruct) { (void) DUALTIMERn; host_timer_load = DUALTIMER_InitStruct->Timer_Load; }
+void DUALTIMER_ITConfig(DUALTIMER_TypeDef* DUALTIMERn, FunctionalState NewState) { (void) DUALTIMERn; (void) NewState; }
+void DUALTIMER_Cmd(DUALTIMER_TypeDef* DUALTIMERn, FunctionalState NewState) { (void) DUALTIMERn; host_timer_on = (NewState == ENABLE); }
+void NVIC_Init(NVIC_InitTypeDef* NVIC_InitStruct)
+{
+    if (NVIC_InitStruct->NVIC_IRQChannel == WZTOE_IRQn) host_wztoe_on = NVIC_InitStruct->NVIC_IRQChannelCmd == ENABLE;
+    if (NVIC_InitStruct->NVIC_IRQChannel == UART2_IRQn) host_uart_irq_on = NVIC_InitStruct->NVIC_IRQChannelCmd == ENABLE;
+}
+
+uint8_t PHY_Init(GPIO_TypeDef* GPIOx, uint16_t mdc, uint16_t mdio) { (void) GPIOx; (void) mdc; (void) mdio; return SET; }
+uint8_t PHY_GetLinkStatus(void) { return PHY_LINK_ON; }
+
+void ADC_Cmd(FunctionalState NewState) { (void) NewState; }
+
+void ADC_ChannelConfig(uint32_t ADC_Channel)
+{
+    host_adc_channel = ADC_Channel;
+}
+
+void ADC_StartOfConversion(void) { }
+
+uint16_t ADC_GetConversionValue(void)
+{
+    return host_adc_source ? host_adc_source(host_adc_channel) : 0;
+}
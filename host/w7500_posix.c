@@ -0,0 +1,457 @@
+/**
+ ******************************************************************************
+ * @file    host/w7500_posix.c
+ * @author  WIZnet
+ * @brief   W7500x TOE sockets and time base on top of POSIX, so the firmware
+ *          serves real clients from a Linux host.
+ ******************************************************************************
+ * @attention
+ *
+ * Each TOE socket maps onto at most one non-blocking host socket. A TCP
+ * socket in LISTEN shares one listening host socket per port with the other
+ * TOE sockets listening on that port and takes over the next connection the
+ * kernel has queued when its state is polled. The kernel keeps queueing
+ * connections while every TOE socket is busy, where the chip would refuse
+ * them.
+ *
+ * The register reads are computed from the host socket when polled:
+ * Sn_RX_RSR from the readable byte count, Sn_TX_FSR from the unsent bytes
+ * in the send queue against the socket's TX buffer size, and CLOSE_WAIT
+ * from a zero-length read. send() and disconnect() follow the ioLibrary:
+ * they block unless the socket was opened with SF_IO_NONBLOCK, in which
+ * case send() takes nothing that does not fit in the TX free size and
+ * returns SOCK_BUSY instead. A SEND completes as soon as the kernel has the
+ * data, so SENDOK is set by send() itself; the next send() takes it.
+ * Connections get TCP_NODELAY and a 1460 byte MSS, so every send() goes
+ * out as the segments the chip would have produced.
+ *
+ * SysTick and DUALTIMER0 are driven by a 1 ms SIGALRM interval timer; the
+ * handlers run in signal context, as they run in interrupt context on the
+ * chip. __WFI() waits in ppoll() on the host sockets that can raise a
+ * socket interrupt, with the timer signal let through.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <linux/sockios.h>
+#include <linux/tcp.h>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include "main.h"
+#include "wizchip_conf.h"
+#include "w7500_host.h"
+#include "w7500_posix.h"
+
+/* The ioLibrary names are defined here as wiz_*; the host calls below need
+ * the C library's. */
+#undef socket
+#undef close
+#undef listen
+#undef disconnect
+#undef send
+#undef recv
+#undef sendto
+
+/* Private define ------------------------------------------------------------*/
+#define POSIX_LISTEN_BACKLOG 16
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+    uint8_t sr;
+    uint8_t ir;
+    uint8_t mr;
+    uint8_t flag;
+    uint8_t sending;                /* SEND issued, SENDOK not taken yet */
+    uint16_t port;
+    int fd;
+    uint8_t dip[4];
+    uint16_t dport;
+} PosixSocket;
+
+typedef struct
+{
+    uint16_t port;
+    int fd;
+} PosixListener;
+
+/* Private variables ---------------------------------------------------------*/
+static PosixSocket posix_sock[_WIZCHIP_SOCK_NUM_] = { [0 ... _WIZCHIP_SOCK_NUM_ - 1] = { .fd = -1 } };
+static PosixListener posix_listener[_WIZCHIP_SOCK_NUM_];
+static uint8_t posix_listener_count;
+static const char* posix_bind_addr = "127.0.0.1";
+static int posix_port_offset = POSIX_PORT_OFFSET_DEFAULT;
+
+/* Private functions ---------------------------------------------------------*/
+
+static void posix_release(PosixSocket* s)
+{
+    if (s->fd >= 0) close(s->fd);
+    s->fd = -1;
+    s->sr = SOCK_CLOSED;
+}
+
+static int posix_listener_fd(uint16_t port)
+{
+    struct sockaddr_in addr;
+    int one = 1;
+    int mss = POSIX_TCP_MSS;
+    int fd;
+    uint8_t i;
+
+    for (i = 0; i < posix_listener_count; i++) {
+        if (posix_listener[i].port == port) return posix_listener[i].fd;
+    }
+    if (posix_listener_count == _WIZCHIP_SOCK_NUM_) return -1;
+
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t) (port + posix_port_offset));
+    inet_pton(AF_INET, posix_bind_addr, &addr.sin_addr);
+
+    /* The MSS set on the listener is inherited by accepted connections */
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(fd, IPPROTO_TCP, TCP_MAXSEG, &mss, sizeof(mss));
+    if (bind(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0 || listen(fd, POSIX_LISTEN_BACKLOG) < 0) {
+        fprintf(stderr, "w7500_posix: cannot listen on %s:%u: %s\n", posix_bind_addr, port + posix_port_offset, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    posix_listener[posix_listener_count].port = port;
+    posix_listener[posix_listener_count].fd = fd;
+    posix_listener_count++;
+    return fd;
+}
+
+/* Brings the modelled registers of one socket up to date with its host socket */
+static void posix_poll(uint8_t sn)
+{
+    PosixSocket* s = &posix_sock[sn];
+    struct sockaddr_in peer;
+    socklen_t peer_len = sizeof(peer);
+    int one = 1;
+    int avail = 0;
+    int fd;
+    char c;
+    ssize_t r;
+
+    if (s->sr == SOCK_LISTEN) {
+        fd = accept4(posix_listener_fd(s->port), (struct sockaddr*) &peer, &peer_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        s->fd = fd;
+        s->sr = SOCK_ESTABLISHED;
+        s->ir |= Sn_IR_CON;
+        memcpy(s->dip, &peer.sin_addr, 4);
+        s->dport = ntohs(peer.sin_port);
+    }
+
+    if (s->sr != SOCK_ESTABLISHED) return;
+
+    if (ioctl(s->fd, FIONREAD, &avail) == 0 && avail > 0) {
+        s->ir |= Sn_IR_RECV;
+        return;
+    }
+
+    r = recv(s->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (r == 0) {
+        s->sr = SOCK_CLOSE_WAIT;
+        s->ir |= Sn_IR_DISCON;
+    }
+    else if (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        /* Reset by the peer */
+        posix_release(s);
+        s->ir |= Sn_IR_DISCON;
+    }
+}
+
+static void posix_alarm(int sig)
+{
+    int saved_errno = errno;
+
+    (void) sig;
+    Host_TickMs();
+    errno = saved_errno;
+}
+
+/* Host control --------------------------------------------------------------*/
+
+void Posix_SetBindAddress(const char* addr)
+{
+    posix_bind_addr = addr;
+}
+
+void Posix_SetPortOffset(int offset)
+{
+    posix_port_offset = offset;
+}
+
+void Host_TickStart(void)
+{
+    struct sigaction sa;
+    struct itimerval it;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = posix_alarm;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGALRM, &sa, NULL);
+
+    it.it_interval.tv_sec = 0;
+    it.it_interval.tv_usec = 1000;
+    it.it_value = it.it_interval;
+    setitimer(ITIMER_REAL, &it, NULL);
+}
+
+/* Sleeps until a host socket that can raise Sn_IR is ready or a signal is
+ * taken; the timer signal is let through even while PRIMASK blocks it */
+void Host_Sleep(void)
+{
+    struct pollfd pfd[_WIZCHIP_SOCK_NUM_];
+    sigset_t mask;
+    nfds_t n = 0;
+    uint8_t sn;
+
+    for (sn = 0; sn < _WIZCHIP_SOCK_NUM_; sn++) {
+        if (posix_sock[sn].sr == SOCK_LISTEN) {
+            pfd[n].fd = posix_listener_fd(posix_sock[sn].port);
+            pfd[n++].events = POLLIN;
+        }
+        else if (posix_sock[sn].fd >= 0) {
+            pfd[n].fd = posix_sock[sn].fd;
+            pfd[n++].events = POLLIN;
+        }
+    }
+
+    sigemptyset(&mask);
+    ppoll(pfd, n, NULL, &mask);
+}
+
+/* WZTOE registers -----------------------------------------------------------*/
+
+uint8_t getSn_SR(uint8_t sn)
+{
+    posix_poll(sn);
+    return posix_sock[sn].sr;
+}
+
+uint8_t getSn_IR(uint8_t sn)
+{
+    posix_poll(sn);
+    return posix_sock[sn].ir;
+}
+
+void setSn_IR(uint8_t sn, uint8_t ir)
+{
+    posix_sock[sn].ir &= (uint8_t) ~ir;
+}
+
+void getSn_DIPR(uint8_t sn, uint8_t* dipr)
+{
+    memcpy(dipr, posix_sock[sn].dip, 4);
+}
+
+uint16_t getSn_DPORT(uint8_t sn)
+{
+    return posix_sock[sn].dport;
+}
+
+uint16_t getSn_RX_RSR(uint8_t sn)
+{
+    int avail = 0;
+
+    if (posix_sock[sn].fd < 0 || ioctl(posix_sock[sn].fd, FIONREAD, &avail) < 0) return 0;
+    return (uint16_t) (avail > getSn_RxMAX(sn) ? getSn_RxMAX(sn) : avail);
+}
+
+uint16_t getSn_TX_FSR(uint8_t sn)
+{
+    int queued = 0;
+
+    if (posix_sock[sn].fd < 0) return getSn_TxMAX(sn);
+    ioctl(posix_sock[sn].fd, SIOCOUTQNSD, &queued);
+    return (uint16_t) (queued >= getSn_TxMAX(sn) ? 0 : getSn_TxMAX(sn) - queued);
+}
+
+/* Socket API ----------------------------------------------------------------*/
+
+int8_t wiz_socket(uint8_t sn, uint8_t protocol, uint16_t port, uint8_t flag)
+{
+    PosixSocket* s = &posix_sock[sn];
+    struct sockaddr_in addr;
+
+    if (sn >= _WIZCHIP_SOCK_NUM_) return SOCKERR_SOCKNUM;
+    if (protocol != Sn_MR_TCP && protocol != Sn_MR_UDP) return SOCKERR_SOCKMODE;
+
+    posix_release(s);
+    s->ir = 0;
+    s->mr = protocol;
+    s->flag = flag;
+    s->sending = 0;
+    s->port = port;
+
+    if (protocol == Sn_MR_TCP) {
+        s->sr = SOCK_INIT;
+        return sn;
+    }
+
+    s->fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (s->fd < 0) return SOCKERR_SOCKINIT;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t) (port + posix_port_offset));
+    inet_pton(AF_INET, posix_bind_addr, &addr.sin_addr);
+    if (bind(s->fd, (struct sockaddr*) &addr, sizeof(addr)) < 0) {
+        fprintf(stderr, "w7500_posix: cannot bind UDP %s:%u: %s\n", posix_bind_addr, port + posix_port_offset, strerror(errno));
+        posix_release(s);
+        return SOCKERR_SOCKINIT;
+    }
+    s->sr = SOCK_UDP;
+    return sn;
+}
+
+int8_t wiz_close(uint8_t sn)
+{
+    posix_release(&posix_sock[sn]);
+    posix_sock[sn].ir = 0;
+    posix_sock[sn].sending = 0;
+    return SOCK_OK;
+}
+
+int8_t wiz_listen(uint8_t sn)
+{
+    PosixSocket* s = &posix_sock[sn];
+
+    if (s->sr != SOCK_INIT) return SOCKERR_SOCKINIT;
+    if (posix_listener_fd(s->port) < 0) {
+        posix_release(s);
+        return SOCKERR_SOCKCLOSED;
+    }
+    s->sr = SOCK_LISTEN;
+    return SOCK_OK;
+}
+
+int8_t wiz_disconnect(uint8_t sn)
+{
+    PosixSocket* s = &posix_sock[sn];
+    char drain[256];
+
+    if (s->fd < 0) return SOCKERR_SOCKCLOSED;
+
+    /* Send the FIN, then discard what the peer sent unread so closing does
+     * not turn into a reset that could cut off the reply in flight. */
+    shutdown(s->fd, SHUT_WR);
+    while (recv(s->fd, drain, sizeof(drain), MSG_DONTWAIT) > 0)
+        ;
+    posix_release(s);
+    s->sending = 0;
+
+    /* A non-blocking disconnect() leaves the socket closing */
+    return (s->flag & SF_IO_NONBLOCK) ? SOCK_BUSY : SOCK_OK;
+}
+
+int32_t wiz_send(uint8_t sn, uint8_t* buf, uint16_t len)
+{
+    PosixSocket* s = &posix_sock[sn];
+    struct pollfd pfd;
+    uint16_t done = 0;
+    ssize_t r;
+
+    if (s->sr != SOCK_ESTABLISHED && s->sr != SOCK_CLOSE_WAIT) return SOCKERR_SOCKSTATUS;
+    if (len == 0) return SOCKERR_DATALEN;
+
+    /* The next SEND waits for the SENDOK of the last */
+    if (s->sending) {
+        if (!(s->ir & Sn_IR_SENDOK)) return SOCK_BUSY;
+        s->ir &= (uint8_t) ~Sn_IR_SENDOK;
+        s->sending = 0;
+    }
+
+    if (len > getSn_TxMAX(sn)) len = getSn_TxMAX(sn);
+    if ((s->flag & SF_IO_NONBLOCK) && len > getSn_TX_FSR(sn)) return SOCK_BUSY;
+
+    while (done < len) {
+        r = send(s->fd, buf + done, len - done, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (r > 0) {
+            done += (uint16_t) r;
+            continue;
+        }
+        if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            pfd.fd = s->fd;
+            pfd.events = POLLOUT;
+            poll(&pfd, 1, 100);
+            continue;
+        }
+        if (r < 0 && errno == EINTR) continue;
+
+        posix_release(s);
+        return SOCKERR_SOCKCLOSED;
+    }
+
+    s->sending = 1;
+    s->ir |= Sn_IR_SENDOK;
+    return len;
+}
+
+int32_t wiz_sendto(uint8_t sn, uint8_t* buf, uint16_t len, uint8_t* addr, uint16_t port)
+{
+    PosixSocket* s = &posix_sock[sn];
+    struct sockaddr_in to;
+    struct pollfd pfd;
+    ssize_t r;
+
+    if (s->sr != SOCK_UDP) return SOCKERR_SOCKSTATUS;
+    if (port == 0) return SOCKERR_PORTZERO;
+    if (len == 0) return SOCKERR_DATALEN;
+    if (len > getSn_TxMAX(sn)) len = getSn_TxMAX(sn);
+
+    /* Destinations are used as given; only local ports are offset */
+    memset(&to, 0, sizeof(to));
+    to.sin_family = AF_INET;
+    to.sin_port = htons(port);
+    memcpy(&to.sin_addr, addr, 4);
+
+    while ((r = sendto(s->fd, buf, len, MSG_DONTWAIT, (struct sockaddr*) &to, sizeof(to))) < 0) {
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) return SOCKERR_TIMEOUT;
+        if (s->flag & SF_IO_NONBLOCK) return SOCK_BUSY;
+
+        pfd.fd = s->fd;
+        pfd.events = POLLOUT;
+        poll(&pfd, 1, 100);
+    }
+
+    s->ir |= Sn_IR_SENDOK;
+    return len;
+}
+
+int32_t wiz_recv(uint8_t sn, uint8_t* buf, uint16_t len)
+{
+    PosixSocket* s = &posix_sock[sn];
+    ssize_t r;
+
+    if (s->fd < 0) return SOCKERR_SOCKSTATUS;
+    if (len > getSn_RxMAX(sn)) len = getSn_RxMAX(sn);
+
+    r = recv(s->fd, buf, len, MSG_DONTWAIT);
+    if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return SOCK_BUSY;
+    if (r <= 0) return SOCK_BUSY;
+    if (getSn_RX_RSR(sn) == 0) s->ir &= (uint8_t) ~Sn_IR_RECV;
+    return (int32_t) r;
+}
@@ -0,0 +1,23 @@
+/**
+ ******************************************************************************
+ * @file    host/w7500_posix.h
+ * @author  WIZnet
+ * @brief   W7500x TOE sockets backed by non-blocking POSIX sockets, used to
+ *          run the firmware as a real server on a Linux host.
+ ******************************************************************************
+ */
+
+#ifndef __HOST_W7500_POSIX_H
+#define __HOST_W7500_POSIX_H
+
+#include <stdint.h>
+
+/* Segment size forced on accepted connections, as on a 1500 byte MTU link. */
+#define POSIX_TCP_MSS 1460
+/* Added to every firmware port so the host needs no privileges: 80 -> 8080 */
+#define POSIX_PORT_OFFSET_DEFAULT 8000
+
+void Posix_SetBindAddress(const char* addr);
+void Posix_SetPortOffset(int offset);
+
+#endif /* __HOST_W7500_POSIX_H */
@@ -0,0 +1,233 @@
+/**
+ ******************************************************************************
+ * @file    host/w7500_sim.c
+ * @author  WIZnet
+ * @brief   In-memory model of the W7500x TOE sockets, sufficient to run the
+ *          firmware's server logic deterministically on a host.
+ ******************************************************************************
+ * @attention
+ *
+ * The socket model follows the ioLibrary semantics the firmware relies on:
+ * send() is clamped to the socket TX buffer size and issues one SEND command
+ * per call, which completes at once and sets SENDOK for the next send() to
+ * take, recv() drains at most the requested length, and disconnect()
+ * completes the FIN handshake immediately. The peer is assumed to ACK
+ * instantly, so the TX free size is always the full buffer.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "wizchip_conf.h"
+#include "w7500_host.h"
+#include "w7500_sim.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+    uint8_t sr;
+    uint8_t ir;
+    uint8_t mr;
+    uint8_t sending;
+    uint16_t port;
+    uint8_t dip[4];
+    uint16_t dport;
+    uint8_t rx[SIM_SOCK_BUF_SIZE];
+    uint16_t rx_len;
+} SimSocket;
+
+/* Private variables ---------------------------------------------------------*/
+static SimSocket sim_sock[_WIZCHIP_SOCK_NUM_];
+static Sim_SendHook sim_send_hook;
+
+/* Simulator control ---------------------------------------------------------*/
+
+void Sim_Reset(void)
+{
+    memset(sim_sock, 0, sizeof(sim_sock));
+}
+
+int Sim_Connect(uint8_t sn, const uint8_t* peer_ip, uint16_t peer_port)
+{
+    SimSocket* s = &sim_sock[sn];
+
+    if (s->sr != SOCK_LISTEN) return -1;
+
+    s->sr = SOCK_ESTABLISHED;
+    s->ir |= Sn_IR_CON;
+    memcpy(s->dip, peer_ip, 4);
+    s->dport = peer_port;
+    s->rx_len = 0;
+    return 0;
+}
+
+int Sim_Feed(uint8_t sn, const void* data, uint16_t len)
+{
+    SimSocket* s = &sim_sock[sn];
+
+    if (s->sr != SOCK_ESTABLISHED) return -1;
+    if (len > getSn_RxMAX(sn) - s->rx_len) len = (uint16_t) (getSn_RxMAX(sn) - s->rx_len);
+
+    memcpy(s->rx + s->rx_len, data, len);
+    s->rx_len += len;
+    s->ir |= Sn_IR_RECV;
+    return len;
+}
+
+void Sim_PeerClose(uint8_t sn)
+{
+    if (sim_sock[sn].sr == SOCK_ESTABLISHED) {
+        sim_sock[sn].sr = SOCK_CLOSE_WAIT;
+        sim_sock[sn].ir |= Sn_IR_DISCON;
+    }
+}
+
+void Sim_SetSendHook(Sim_SendHook hook)
+{
+    sim_send_hook = hook;
+}
+
+void Sim_AdvanceMs(uint32_t ms)
+{
+    while (ms--) {
+        Host_TickMs();
+    }
+}
+
+/* Simulated time only advances through Sim_AdvanceMs(). */
+void Host_TickStart(void)
+{
+}
+
+/* Sleeping lasts until the next tick. */
+void Host_Sleep(void)
+{
+    Host_TickMs();
+}
+
+/* WZTOE registers -----------------------------------------------------------*/
+
+uint8_t getSn_SR(uint8_t sn)
+{
+    return sim_sock[sn].sr;
+}
+
+uint8_t getSn_IR(uint8_t sn)
+{
+    return sim_sock[sn].ir;
+}
+
+void setSn_IR(uint8_t sn, uint8_t ir)
+{
+    sim_sock[sn].ir &= (uint8_t) ~ir;
+}
+
+void getSn_DIPR(uint8_t sn, uint8_t* dipr)
+{
+    memcpy(dipr, sim_sock[sn].dip, 4);
+}
+
+uint16_t getSn_DPORT(uint8_t sn)
+{
+    return sim_sock[sn].dport;
+}
+
+uint16_t getSn_RX_RSR(uint8_t sn)
+{
+    return sim_sock[sn].rx_len;
+}
+
+uint16_t getSn_TX_FSR(uint8_t sn)
+{
+    return getSn_TxMAX(sn);
+}
+
+/* Socket API ----------------------------------------------------------------*/
+
+int8_t socket(uint8_t sn, uint8_t protocol, uint16_t port, uint8_t flag)
+{
+    SimSocket* s = &sim_sock[sn];
+
+    (void) flag;
+    if (sn >= _WIZCHIP_SOCK_NUM_) return SOCKERR_SOCKNUM;
+
+    memset(s, 0, sizeof(*s));
+    s->mr = protocol;
+    s->port = port;
+    s->sr = (protocol == Sn_MR_TCP) ? SOCK_INIT : SOCK_UDP;
+    return sn;
+}
+
+int8_t close(uint8_t sn)
+{
+    sim_sock[sn].sr = SOCK_CLOSED;
+    sim_sock[sn].ir = 0;
+    sim_sock[sn].sending = 0;
+    sim_sock[sn].rx_len = 0;
+    return SOCK_OK;
+}
+
+int8_t listen(uint8_t sn)
+{
+    if (sim_sock[sn].sr != SOCK_INIT) return SOCKERR_SOCKINIT;
+    sim_sock[sn].sr = SOCK_LISTEN;
+    return SOCK_OK;
+}
+
+int8_t disconnect(uint8_t sn)
+{
+    sim_sock[sn].sr = SOCK_CLOSED;
+    sim_sock[sn].sending = 0;
+    sim_sock[sn].rx_len = 0;
+    return SOCK_OK;
+}
+
+int32_t send(uint8_t sn, uint8_t* buf, uint16_t len)
+{
+    SimSocket* s = &sim_sock[sn];
+
+    if (s->sr != SOCK_ESTABLISHED && s->sr != SOCK_CLOSE_WAIT) return SOCKERR_SOCKSTATUS;
+    if (len == 0) return SOCKERR_DATALEN;
+
+    /* The next SEND waits for the SENDOK of the last */
+    if (s->sending) {
+        if (!(s->ir & Sn_IR_SENDOK)) return SOCK_BUSY;
+        s->ir &= (uint8_t) ~Sn_IR_SENDOK;
+        s->sending = 0;
+    }
+    if (len > getSn_TxMAX(sn)) len = getSn_TxMAX(sn);
+
+    if (sim_send_hook) sim_send_hook(sn, buf, len);
+    s->sending = 1;
+    s->ir |= Sn_IR_SENDOK;
+    return len;
+}
+
+int32_t sendto(uint8_t sn, uint8_t* buf, uint16_t len, uint8_t* addr, uint16_t port)
+{
+    SimSocket* s = &sim_sock[sn];
+
+    (void) addr;
+    if (s->sr != SOCK_UDP) return SOCKERR_SOCKSTATUS;
+    if (port == 0) return SOCKERR_PORTZERO;
+    if (len == 0) return SOCKERR_DATALEN;
+    if (len > getSn_TxMAX(sn)) len = getSn_TxMAX(sn);
+
+    if (sim_send_hook) sim_send_hook(sn, buf, len);
+    return len;
+}
+
+int32_t recv(uint8_t sn, uint8_t* buf, uint16_t len)
+{
+    SimSocket* s = &sim_sock[sn];
+
+    if (len > s->rx_len) len = s->rx_len;
+    if (len == 0) return SOCK_BUSY;
+
+    memcpy(buf, s->rx, len);
+    memmove(s->rx, s->rx + len, s->rx_len - len);
+    s->rx_len -= len;
+    if (s->rx_len == 0) s->ir &= (uint8_t) ~Sn_IR_RECV;
+    return len;
+}
@@ -0,0 +1,30 @@
+/**
+ ******************************************************************************
+ * @file    host/w7500_sim.h
+ * @author  WIZnet
+ * @brief   In-memory model of the W7500x TOE sockets used to drive
+ *          the firmware's server logic from host-side benchmarks.
+ ******************************************************************************
+ */
+
+#ifndef __HOST_W7500_SIM_H
+#define __HOST_W7500_SIM_H
+
+#include <stdint.h>
+
+/* Largest modelled socket buffer; each socket uses the size wizchip_init()
+ * gave it, 2 KB by default. */
+#define SIM_SOCK_BUF_SIZE 16384
+/* Payload bytes carried by one TCP segment on a 1500 byte MTU link. */
+#define SIM_TCP_MSS 1460
+
+typedef void (*Sim_SendHook)(uint8_t sn, const uint8_t* buf, uint16_t len);
+
+void Sim_Reset(void);
+int Sim_Connect(uint8_t sn, const uint8_t* peer_ip, uint16_t peer_port);
+int Sim_Feed(uint8_t sn, const void* data, uint16_t len);
+void Sim_PeerClose(uint8_t sn);
+void Sim_SetSendHook(Sim_SendHook hook);
+void Sim_AdvanceMs(uint32_t ms);
+
+#endif /* __HOST_W7500_SIM_H */
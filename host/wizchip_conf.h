@@ -0,0 +1,93 @@
+/**
+ ******************************************************************************
+ * @file    host/wizchip_conf.h
+ * @author  WIZnet
+ * @brief   Host (Linux) stand-in for the ioLibrary wizchip_conf.h and the
+ *          W7500x WZTOE register accessors.
+ ******************************************************************************
+ */
+
+#ifndef __HOST_WIZCHIP_CONF_H
+#define __HOST_WIZCHIP_CONF_H
+
+#include <stdint.h>
+
+#define _WIZCHIP_SOCK_NUM_ 8
+
+/* Sn_MR values */
+#define Sn_MR_CLOSE 0x00
+#define Sn_MR_TCP   0x01
+#define Sn_MR_UDP   0x02
+
+/* Sn_IR values */
+#define Sn_IR_CON     0x01
+#define Sn_IR_DISCON  0x02
+#define Sn_IR_RECV    0x04
+#define Sn_IR_TIMEOUT 0x08
+#define Sn_IR_SENDOK  0x10
+
+/* Sn_SR values */
+#define SOCK_CLOSED      0x00
+#define SOCK_INIT        0x13
+#define SOCK_LISTEN      0x14
+#define SOCK_SYNSENT     0x15
+#define SOCK_SYNRECV     0x16
+#define SOCK_ESTABLISHED 0x17
+#define SOCK_FIN_WAIT    0x18
+#define SOCK_CLOSING     0x1A
+#define SOCK_TIME_WAIT   0x1B
+#define SOCK_CLOSE_WAIT  0x1C
+#define SOCK_LAST_ACK    0x1D
+#define SOCK_UDP         0x22
+
+typedef enum
+{
+    NETINFO_STATIC = 1,
+    NETINFO_DHCP
+} dhcp_mode;
+
+typedef struct wiz_NetInfo_t
+{
+    uint8_t mac[6];
+    uint8_t ip[4];
+    uint8_t sn[4];
+    uint8_t gw[4];
+    uint8_t dns[4];
+    dhcp_mode dhcp;
+} wiz_NetInfo;
+
+typedef enum
+{
+    CN_SET_NETINFO,
+    CN_GET_NETINFO
+} ctlnetwork_type;
+
+typedef enum
+{
+    CW_INIT_WIZCHIP
+} ctlwizchip_type;
+
+int8_t ctlnetwork(ctlnetwork_type cntype, void* arg);
+int8_t ctlwizchip(ctlwizchip_type cwtype, void* arg);
+int8_t wizchip_init(uint8_t* txsize, uint8_t* rxsize);
+
+uint8_t getSIR(void);
+uint8_t getSIMR(void);
+void setSIMR(uint8_t simr);
+uint8_t getSn_SR(uint8_t sn);
+uint8_t getSn_IR(uint8_t sn);
+uint8_t getSn_IMR(uint8_t sn);
+void setSn_IMR(uint8_t sn, uint8_t imr);
+void setSn_IR(uint8_t sn, uint8_t ir);
+void getSn_DIPR(uint8_t sn, uint8_t* dipr);
+uint16_t getSn_DPORT(uint8_t sn);
+uint16_t getSn_RX_RSR(uint8_t sn);
+uint16_t getSn_TX_FSR(uint8_t sn);
+uint8_t getSn_TXBUF_SIZE(uint8_t sn);
+uint8_t getSn_RXBUF_SIZE(uint8_t sn);
+
+/* Socket buffer sizes in bytes */
+#define getSn_TxMAX(sn) (((uint16_t) getSn_TXBUF_SIZE(sn)) << 10)
+#define getSn_RxMAX(sn) (((uint16_t) getSn_RXBUF_SIZE(sn)) << 10)
+
+#endif /* __HOST_WIZCHIP_CONF_H */
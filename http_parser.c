@@ -0,0 +1,409 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/http_parser.c
+ * @author  WIZnet
+ * @brief   Incremental HTTP/1.x request parser working in place on a
+ *          connection's RX buffer
+ ******************************************************************************
+ * @attention
+ *
+ * The parser is fed the whole RX buffer on every call and resumes scanning
+ * where it stopped, so a request may arrive split across any number of
+ * recv() calls. Nothing is copied out: the request line stays at the front
+ * of the buffer and the request target is kept as offsets into it. Header
+ * lines are reduced to flags as soon as they are complete, only the short
+ * If-None-Match value is copied, which lets HTTP_Compact() reclaim their
+ * space when the buffer runs full. Bytes after the end of a request belong
+ * to the next, pipelined, request and are moved to the front of the buffer
+ * by HTTP_Consume().
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "http_parser.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define HTTP_STATE_REQLINE 0
+#define HTTP_STATE_HEADERS 1
+#define HTTP_STATE_BODY    2
+#define HTTP_STATE_DONE    3
+
+/* Private macro -------------------------------------------------------------*/
+#define HTTP_IS_OWS(c)   ((c) == ' ' || (c) == '\t')
+#define HTTP_TOLOWER(c)  (((c) >= 'A' && (c) <= 'Z') ? (c) + ('a' - 'A') : (c))
+
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Compares a buffer range with a string, ignoring case.
+ * @param  s: Start of the range.
+ * @param  n: Length of the range.
+ * @param  lit: NUL-terminated lower case string.
+ * @retval 1 if equal, 0 otherwise.
+ */
+static uint8_t HTTP_IEqual(const uint8_t* s, uint16_t n, const char* lit)
+{
+    uint16_t i;
+
+    for (i = 0; i < n; i++) {
+        if (lit[i] == '\0' || HTTP_TOLOWER(s[i]) != lit[i]) return 0;
+    }
+    return lit[n] == '\0';
+}
+
+/**
+ * @brief  Tells whether a content coding's parameters carry a zero q-value.
+ * @param  buf: RX buffer.
+ * @param  p: Offset of the parameters after the coding name.
+ * @param  end: End of the list element.
+ * @retval 1 if q=0, 0 otherwise.
+ */
+static uint8_t HTTP_QZero(const uint8_t* buf, uint16_t p, uint16_t end)
+{
+    for (; p < end; p++) {
+        if (HTTP_TOLOWER(buf[p]) == 'q' && p + 1 < end && buf[p + 1] == '=') {
+            p += 2;
+            if (p >= end || buf[p] != '0') return 0;
+            for (p++; p < end && !HTTP_IS_OWS(buf[p]) && buf[p] != ';'; p++) {
+                if (buf[p] != '.' && buf[p] != '0') return 0;
+            }
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief  Parses the request line "METHOD SP target SP HTTP/1.x".
+ * @param  req: Request being parsed.
+ * @param  buf: RX buffer.
+ * @param  start: Offset of the line.
+ * @param  end: Offset of the line terminator.
+ * @retval 0 on success, -1 if the line is malformed.
+ */
+static int8_t HTTP_ParseRequestLine(HTTP_Request* req, const uint8_t* buf, uint16_t start, uint16_t end)
+{
+    uint16_t p = start;
+    uint16_t target;
+
+    while (p < end && buf[p] != ' ') p++;
+    if (p == end) return -1;
+
+    if (p - start == 3 && memcmp(buf + start, "GET", 3) == 0) req->method = HTTP_METHOD_GET;
+    else if (p - start == 4 && memcmp(buf + start, "HEAD", 4) == 0) req->method = HTTP_METHOD_HEAD;
+    else if (p - start == 4 && memcmp(buf + start, "POST", 4) == 0) req->method = HTTP_METHOD_POST;
+    else req->method = HTTP_METHOD_UNKNOWN;
+
+    target = ++p;
+    if (target >= end || buf[target] != '/') return -1;
+    while (p < end && buf[p] != ' ') p++;
+    if (p == end) return -1;
+
+    req->path = target;
+    req->path_len = p - target;
+    for (target = req->path; target < p; target++) {
+        if (buf[target] == '?') {
+            req->path_len = target - req->path;
+            req->query = target + 1;
+            req->query_len = p - req->query;
+            break;
+        }
+    }
+
+    p++;
+    if (end - p != 8 || memcmp(buf + p, "HTTP/1.", 7) != 0) return -1;
+    if (buf[p + 7] == '1') req->flags |= HTTP_REQ_HTTP11;
+    else if (buf[p + 7] != '0') return -1;
+
+    return 0;
+}
+
+/**
+ * @brief  Parses one header line and records the fields the server uses.
+ * @param  req: Request being parsed.
+ * @param  buf: RX buffer.
+ * @param  start: Offset of the line.
+ * @param  end: Offset of the line terminator.
+ * @retval 0 on success, -1 if the header is malformed or unsupported.
+ */
+static int8_t HTTP_ParseHeader(HTTP_Request* req, const uint8_t* buf, uint16_t start, uint16_t end)
+{
+    uint16_t colon = start;
+    uint16_t v;
+    uint16_t t;
+    uint32_t n;
+
+    while (colon < end && buf[colon] != ':') colon++;
+    if (colon == end || colon == start) return -1;
+
+    v = colon + 1;
+    while (v < end && HTTP_IS_OWS(buf[v])) v++;
+    while (end > v && HTTP_IS_OWS(buf[end - 1])) end--;
+
+    if (HTTP_IEqual(buf + start, colon - start, "connection")) {
+        while (v < end) {
+            while (v < end && (HTTP_IS_OWS(buf[v]) || buf[v] == ',')) v++;
+            t = v;
+            while (t < end && buf[t] != ',' && !HTTP_IS_OWS(buf[t])) t++;
+            if (HTTP_IEqual(buf + v, t - v, "close")) req->flags |= HTTP_REQ_CONN_CLOSE;
+            else if (HTTP_IEqual(buf + v, t - v, "keep-alive")) req->flags |= HTTP_REQ_CONN_KEEP;
+            v = t;
+        }
+    }
+    else if (HTTP_IEqual(buf + start, colon - start, "accept-encoding")) {
+        while (v < end) {
+            while (v < end && (HTTP_IS_OWS(buf[v]) || buf[v] == ',')) v++;
+            t = v;
+            while (t < end && buf[t] != ',' && buf[t] != ';' && !HTTP_IS_OWS(buf[t])) t++;
+            if (HTTP_IEqual(buf + v, t - v, "gzip")) {
+                v = t;
+                while (t < end && buf[t] != ',') t++;
+                if (!HTTP_QZero(buf, v, t)) req->flags |= HTTP_REQ_GZIP;
+            }
+            while (t < end && buf[t] != ',') t++;
+            v = t;
+        }
+    }
+    else if (HTTP_IEqual(buf + start, colon - start, "if-none-match")) {
+        req->flags |= HTTP_REQ_INM;
+        req->etag_len = (end - v <= HTTP_ETAG_MAX) ? (uint8_t) (end - v) : 0;
+        memcpy(req->etag, buf + v, req->etag_len);
+    }
+    else if (HTTP_IEqual(buf + start, colon - start, "content-length")) {
+        if (v == end) return -1;
+        for (n = 0; v < end; v++) {
+            if (buf[v] < '0' || buf[v] > '9' || n > 0x0FFFFFFF) return -1;
+            n = n * 10 + (buf[v] - '0');
+        }
+        req->body_left = n;
+    }
+    else if (HTTP_IEqual(buf + start, colon - start, "transfer-encoding")) {
+        /* Chunked request bodies are not supported */
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  Resets a request to parse a new one from the start of the buffer.
+ * @param  req: Request to reset.
+ * @retval None
+ */
+void HTTP_ParserInit(HTTP_Request* req)
+{
+    memset(req, 0, sizeof(*req));
+}
+
+/**
+ * @brief  Continues parsing a request.
+ * @param  req: Request being parsed.
+ * @param  buf: RX buffer holding the request from offset 0.
+ * @param  len: Number of valid bytes in buf.
+ * @retval HTTP_PARSE_COMPLETE when the request including its body has been
+ *         received, HTTP_PARSE_INCOMPLETE if more data is needed,
+ *         HTTP_PARSE_ERROR if the request is malformed.
+ */
+int8_t HTTP_Parse(HTTP_Request* req, uint8_t* buf, uint16_t len)
+{
+    uint16_t eol;
+    uint32_t avail;
+
+    while (req->state != HTTP_STATE_DONE) {
+        if (req->state == HTTP_STATE_BODY) {
+            avail = len - req->pos;
+            if (avail > req->body_left) avail = req->body_left;
+            req->pos += avail;
+            req->line = req->pos;
+            req->body_left -= avail;
+            if (req->body_left) return HTTP_PARSE_INCOMPLETE;
+
+            req->state = HTTP_STATE_DONE;
+            break;
+        }
+
+        while (req->pos < len && buf[req->pos] != '\n') req->pos++;
+        if (req->pos >= len) return HTTP_PARSE_INCOMPLETE;
+
+        eol = req->pos++;
+        if (eol > req->line && buf[eol - 1] == '\r') eol--;
+
+        if (req->state == HTTP_STATE_REQLINE) {
+            /* Empty lines ahead of a request line are ignored */
+            if (eol != req->line) {
+                if (HTTP_ParseRequestLine(req, buf, req->line, eol) < 0) return HTTP_PARSE_ERROR;
+                req->hdr_start = req->pos;
+                req->state = HTTP_STATE_HEADERS;
+            }
+        }
+        else if (eol == req->line) {
+            req->state = req->body_left ? HTTP_STATE_BODY : HTTP_STATE_DONE;
+        }
+        else if (HTTP_ParseHeader(req, buf, req->line, eol) < 0) {
+            return HTTP_PARSE_ERROR;
+        }
+
+        req->line = req->pos;
+    }
+
+    return HTTP_PARSE_COMPLETE;
+}
+
+/**
+ * @brief  Drops the already parsed header lines and body bytes of an
+ *         incomplete request to make room in the buffer.
+ * @param  req: Request being parsed.
+ * @param  buf: RX buffer.
+ * @param  len: Number of valid bytes in buf.
+ * @retval New number of valid bytes in buf.
+ */
+uint16_t HTTP_Compact(HTTP_Request* req, uint8_t* buf, uint16_t len)
+{
+    uint16_t to = (req->state == HTTP_STATE_REQLINE) ? 0 : req->hdr_start;
+    uint16_t drop = req->line - to;
+
+    if (drop == 0) return len;
+
+    memmove(buf + to, buf + req->line, len - req->line);
+    req->line -= drop;
+    req->pos -= drop;
+
+    return len - drop;
+}
+
+/**
+ * @brief  Removes a completed request from the buffer and resets the parser
+ *         for the next, possibly already received, request.
+ * @param  req: Completed request.
+ * @param  buf: RX buffer.
+ * @param  len: Number of valid bytes in buf.
+ * @retval Number of bytes left in buf.
+ */
+uint16_t HTTP_Consume(HTTP_Request* req, uint8_t* buf, uint16_t len)
+{
+    uint16_t rest = len - req->pos;
+
+    memmove(buf, buf + req->pos, rest);
+    HTTP_ParserInit(req);
+
+    return rest;
+}
+
+/**
+ * @brief  Tells whether the connection may stay open after the response.
+ * @note   Responses carry no Connection header, so only HTTP/1.1 clients,
+ *         which default to persistent connections, are kept open.
+ * @param  req: Completed request.
+ * @retval 1 to keep the connection open, 0 to close it.
+ */
+uint8_t HTTP_KeepAlive(const HTTP_Request* req)
+{
+    return (req->flags & HTTP_REQ_HTTP11) && !(req->flags & HTTP_REQ_CONN_CLOSE);
+}
+
+/**
+ * @brief  Compares the request path, without query, with a string.
+ * @param  req: Parsed request.
+ * @param  buf: RX buffer.
+ * @param  path: NUL-terminated path.
+ * @retval 1 if equal, 0 otherwise.
+ */
+uint8_t HTTP_PathIs(const HTTP_Request* req, const uint8_t* buf, const char* path)
+{
+    return strlen(path) == req->path_len && memcmp(buf + req->path, path, req->path_len) == 0;
+}
+
+/**
+ * @brief  Looks up a parameter of the request's query string.
+ * @note   The value is returned as sent, without percent-decoding.
+ * @param  req: Parsed request.
+ * @param  buf: RX buffer.
+ * @param  name: NUL-terminated parameter name.
+ * @param  value: Receives the start of the value in buf.
+ * @retval Length of the value, or -1 if the parameter is absent.
+ */
+int16_t HTTP_QueryParam(const HTTP_Request* req, const uint8_t* buf, const char* name, const uint8_t** value)
+{
+    uint16_t len = strlen(name);
+    const uint8_t* p = buf + req->query;
+    const uint8_t* end = p + req->query_len;
+    const uint8_t* amp;
+
+    if (req->query == 0) return -1;
+
+    while (p < end) {
+        for (amp = p; amp < end && *amp != '&'; amp++)
+            ;
+        if (amp - p > len && memcmp(p, name, len) == 0 && p[len] == '=') {
+            *value = p + len + 1;
+            return (int16_t) (amp - *value);
+        }
+        if (amp - p == len && memcmp(p, name, len) == 0) {
+            *value = amp;
+            return 0;
+        }
+        p = amp + 1;
+    }
+    return -1;
+}
+
+/**
+ * @brief  Reads a decimal query parameter.
+ * @param  req: Parsed request.
+ * @param  buf: RX buffer.
+ * @param  name: NUL-terminated parameter name.
+ * @param  value: Receives the number; left unchanged if not present.
+ * @retval 1 if the parameter holds a number, 0 if it is absent, -1 if it
+ *         is not a number.
+ */
+int8_t HTTP_QueryUint(const HTTP_Request* req, const uint8_t* buf, const char* name, uint32_t* value)
+{
+    const uint8_t* v;
+    int16_t len;
+    uint32_t n = 0;
+    int16_t i;
+
+    if ((len = HTTP_QueryParam(req, buf, name, &v)) < 0) return 0;
+    if (len == 0 || len > 10) return -1;
+
+    for (i = 0; i < len; i++) {
+        if (v[i] < '0' || v[i] > '9') return -1;
+        if (n > (0xFFFFFFFFu - (v[i] - '0')) / 10) return -1;
+        n = n * 10 + (v[i] - '0');
+    }
+    *value = n;
+    return 1;
+}
+
+/**
+ * @brief  Checks an entity tag against the request's If-None-Match list.
+ * @note   Uses the weak comparison: a W/ prefix is ignored.
+ * @param  req: Parsed request.
+ * @param  etag: Quoted entity tag of the current representation.
+ * @retval 1 if the list holds the tag or "*", 0 otherwise.
+ */
+uint8_t HTTP_ETagMatch(const HTTP_Request* req, const char* etag)
+{
+    uint16_t len = strlen(etag);
+    uint16_t v = 0;
+    uint16_t t;
+
+    while (v < req->etag_len) {
+        while (v < req->etag_len && (HTTP_IS_OWS(req->etag[v]) || req->etag[v] == ',')) v++;
+        if (v + 2 <= req->etag_len && req->etag[v] == 'W' && req->etag[v + 1] == '/') v += 2;
+        t = v;
+        while (t < req->etag_len && req->etag[t] != ',' && !HTTP_IS_OWS(req->etag[t])) t++;
+
+        if (t - v == 1 && req->etag[v] == '*') return 1;
+        if (t - v == len && memcmp(req->etag + v, etag, len) == 0) return 1;
+        v = t;
+    }
+    return 0;
+}
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
@@ -0,0 +1,73 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/http_parser.h
+ * @author  WIZnet
+ * @brief   Header for http_parser.c module
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __HTTP_PARSER_H
+#define __HTTP_PARSER_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/* HTTP_Parse() results */
+#define HTTP_PARSE_INCOMPLETE 0
+#define HTTP_PARSE_COMPLETE   1
+#define HTTP_PARSE_ERROR      (-1)
+
+/* Request methods */
+#define HTTP_METHOD_UNKNOWN 0
+#define HTTP_METHOD_GET     1
+#define HTTP_METHOD_HEAD    2
+#define HTTP_METHOD_POST    3
+
+/* Request flags */
+#define HTTP_REQ_HTTP11     0x01    /* HTTP/1.1 request line */
+#define HTTP_REQ_CONN_CLOSE 0x02    /* Connection: close */
+#define HTTP_REQ_CONN_KEEP  0x04    /* Connection: keep-alive */
+#define HTTP_REQ_GZIP       0x08    /* Accept-Encoding allows gzip */
+#define HTTP_REQ_INM        0x10    /* If-None-Match present */
+
+/* Longest If-None-Match value kept; longer lists never match */
+#ifndef HTTP_ETAG_MAX
+#define HTTP_ETAG_MAX 48
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+/* Parser state of one request. Offsets index the connection's RX buffer;
+ * the request line stays in place until the request has been consumed. */
+typedef struct
+{
+    uint8_t state;
+    uint8_t method;
+    uint8_t flags;
+    uint16_t pos;           /* Next byte to scan */
+    uint16_t line;          /* Start of the line being parsed */
+    uint16_t hdr_start;     /* First byte after the request line */
+    uint16_t path;          /* Request target, without the query */
+    uint16_t path_len;
+    uint16_t query;         /* Query string after '?', 0 if none */
+    uint16_t query_len;
+    uint32_t body_left;     /* Body bytes still to be skipped */
+    uint8_t etag_len;
+    char etag[HTTP_ETAG_MAX];   /* If-None-Match value */
+} HTTP_Request;
+
+/* Exported functions ------------------------------------------------------- */
+void HTTP_ParserInit(HTTP_Request* req);
+int8_t HTTP_Parse(HTTP_Request* req, uint8_t* buf, uint16_t len);
+uint16_t HTTP_Compact(HTTP_Request* req, uint8_t* buf, uint16_t len);
+uint16_t HTTP_Consume(HTTP_Request* req, uint8_t* buf, uint16_t len);
+uint8_t HTTP_KeepAlive(const HTTP_Request* req);
+uint8_t HTTP_PathIs(const HTTP_Request* req, const uint8_t* buf, const char* path);
+uint8_t HTTP_ETagMatch(const HTTP_Request* req, const char* etag);
+int16_t HTTP_QueryParam(const HTTP_Request* req, const uint8_t* buf, const char* name, const uint8_t** value);
+int8_t HTTP_QueryUint(const HTTP_Request* req, const uint8_t* buf, const char* name, uint32_t* value);
+
+#endif /* __HTTP_PARSER_H */
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
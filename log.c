@@ -0,0 +1,192 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/log.c
+ * @author  WIZnet
+ * @brief   Deferred UART logging through a ring buffer drained by the UART
+ *          TX interrupt
+ ******************************************************************************
+ * @attention
+ *
+ * A message is formatted on the caller's stack and copied into the ring as
+ * a whole line, or dropped and counted when the ring cannot take it, so
+ * logging never waits for the UART. The ring has a single producer, the
+ * main loop, and a single consumer, the TX interrupt, which each own one
+ * index; Log_Printf() must not be called from interrupt handlers.
+ *
+ * The first byte is written by the producer when the transmitter is idle;
+ * every TX interrupt then sends the next one until the ring is empty.
+ *
+ * Log_UartHandler() must be called from the handler of the log UART in
+ * W7500x_it.c: UART1_Handler() with USE_WIZWIKI_W7500_EVAL, UART2_Handler()
+ * for the simple UART otherwise.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdarg.h>
+#include <stdio.h>
+#include "main.h"
+#include "log.h"
+
+/* Private define ------------------------------------------------------------*/
+#if (LOG_BUF_SIZE & (LOG_BUF_SIZE - 1)) != 0 || LOG_BUF_SIZE > 32768
+#error "LOG_BUF_SIZE must be a power of two up to 32768"
+#endif
+
+#if LOG_LINE_MAX < 8 || LOG_LINE_MAX > LOG_BUF_SIZE
+#error "LOG_LINE_MAX out of range"
+#endif
+
+#define LOG_MASK (LOG_BUF_SIZE - 1)
+
+/* Private macro -------------------------------------------------------------*/
+#define LOG_BARRIER() __asm volatile ("" ::: "memory")
+
+#if defined (USE_WIZWIKI_W7500_EVAL)
+#define LOG_UART_SEND(c)        UART_SendData(UART1, (c))
+#define LOG_UART_TX_PENDING()   (UART_GetITStatus(UART1, UART_IT_FLAG_TXI) == SET)
+#define LOG_UART_TX_CLEAR()     UART_ClearITPendingBit(UART1, UART_IT_FLAG_TXI)
+#else
+#define LOG_UART_SEND(c)        S_UART_SendData(c)
+#define LOG_UART_TX_PENDING()   (S_UART_GetITStatus(S_UART_INTSTATUS_TXI) == SET)
+#define LOG_UART_TX_CLEAR()     S_UART_ClearITPendingBit(S_UART_INTSTATUS_TXI)
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t log_buf[LOG_BUF_SIZE];
+static __IO uint16_t log_head;          /* Written by the producer only */
+static __IO uint16_t log_tail;          /* Written by the consumer only */
+static __IO uint8_t log_tx_busy;        /* A byte is on its way out */
+static uint8_t log_level = LOG_LEVEL;
+static uint32_t log_dropped;
+
+/* Fails to compile if LOG_RAM_SIZE no longer covers the state above */
+typedef char log_ram_check[(sizeof(log_buf) + sizeof(log_head) + sizeof(log_tail) + sizeof(log_tx_busy)
+        + sizeof(log_level) + sizeof(log_dropped) <= LOG_RAM_SIZE) ? 1 : -1];
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Starts the transmitter if it is idle and there is data to send.
+ * @param  None
+ * @retval None
+ */
+static void Log_Kick(void)
+{
+    if (log_tx_busy) return;
+
+    __disable_irq();
+    if (!log_tx_busy && log_tail != log_head) {
+        log_tx_busy = 1;
+        LOG_UART_SEND(log_buf[log_tail & LOG_MASK]);
+        log_tail++;
+    }
+    __enable_irq();
+}
+
+/**
+ * @brief  Empties the ring.
+ * @note   Called after UART_Config(), before the first message.
+ * @param  None
+ * @retval None
+ */
+void Log_Init(void)
+{
+    log_head = 0;
+    log_tail = 0;
+    log_tx_busy = 0;
+    log_dropped = 0;
+}
+
+/**
+ * @brief  Sets the runtime log level.
+ * @param  level: One of LOG_LEVEL_*; levels above LOG_LEVEL stay silent.
+ * @retval None
+ */
+void Log_SetLevel(uint8_t level)
+{
+    log_level = level;
+}
+
+/**
+ * @brief  Returns the runtime log level.
+ * @param  None
+ * @retval One of LOG_LEVEL_*.
+ */
+uint8_t Log_GetLevel(void)
+{
+    return log_level;
+}
+
+/**
+ * @brief  Queues one line for the UART.
+ * @note   Use the LOG_* macros, which compile out levels above LOG_LEVEL.
+ *         The line ending is added here.
+ * @param  level: One of LOG_LEVEL_*.
+ * @param  fmt: printf format.
+ * @retval None
+ */
+void Log_Printf(uint8_t level, const char* fmt, ...)
+{
+    char line[LOG_LINE_MAX];
+    va_list ap;
+    uint16_t head;
+    uint16_t i;
+    int n;
+
+    if (level > log_level) return;
+
+    va_start(ap, fmt);
+    n = vsnprintf(line, LOG_LINE_MAX - 2, fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+    if (n > LOG_LINE_MAX - 3) n = LOG_LINE_MAX - 3;
+    line[n++] = '\r';
+    line[n++] = '\n';
+
+    head = log_head;
+    if ((uint16_t) n > LOG_BUF_SIZE - (uint16_t) (head - log_tail)) {
+        log_dropped++;
+        return;
+    }
+
+    for (i = 0; i < (uint16_t) n; i++) {
+        log_buf[(head + i) & LOG_MASK] = (uint8_t) line[i];
+    }
+    LOG_BARRIER();
+    log_head = (uint16_t) (head + n);
+
+    Log_Kick();
+}
+
+/**
+ * @brief  Sends the next byte of the ring when the UART has sent the last.
+ * @param  None
+ * @retval None
+ */
+void Log_UartHandler(void)
+{
+    if (!LOG_UART_TX_PENDING()) return;
+    LOG_UART_TX_CLEAR();
+
+    if (log_tail == log_head) {
+        log_tx_busy = 0;
+        return;
+    }
+
+    LOG_UART_SEND(log_buf[log_tail & LOG_MASK]);
+    log_tail++;
+}
+
+/**
+ * @brief  Returns the number of messages dropped on a full ring.
+ * @param  None
+ * @retval Dropped messages since boot.
+ */
+uint32_t Log_GetDropped(void)
+{
+    return log_dropped;
+}
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
@@ -0,0 +1,74 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/log.h
+ * @author  WIZnet
+ * @brief   Header for log.c module
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __LOG_H
+#define __LOG_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+/* Messages above LOG_LEVEL are compiled out; the runtime level, which
+ * starts at LOG_LEVEL, filters the rest */
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+/* Ring buffer the UART drains, a power of two */
+#ifndef LOG_BUF_SIZE
+#define LOG_BUF_SIZE 1024
+#endif
+
+/* SRAM of the ring and its indices */
+#define LOG_RAM_SIZE (LOG_BUF_SIZE + 16)
+
+/* Longest message; longer ones are cut */
+#ifndef LOG_LINE_MAX
+#define LOG_LINE_MAX 96
+#endif
+
+/* Exported macro ------------------------------------------------------------*/
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...)  Log_Printf(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...)  ((void) 0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...)   Log_Printf(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...)   ((void) 0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...)   Log_Printf(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...)   ((void) 0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...)  Log_Printf(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...)  ((void) 0)
+#endif
+
+/* Exported functions ------------------------------------------------------- */
+void Log_Init(void);
+void Log_SetLevel(uint8_t level);
+uint8_t Log_GetLevel(void);
+void Log_Printf(uint8_t level, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+void Log_UartHandler(void);
+uint32_t Log_GetDropped(void);
+
+#endif /* __LOG_H */
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
@@ -27,6 +27,19 @@
 #include "main.h"
 #include "wizchip_conf.h"
 #include "dhcp.h"
+#include "socket.h"
+#include "web_server.h"
+#include "adc_sampler.h"
+#include "history.h"
+#include "moisture.h"
+#include "flash_store.h"
+#include "telemetry.h"
+#include "modbus.h"
+#include "arena.h"
+#include "tick.h"
+#include "event_loop.h"
+#include "metrics.h"
+#include "log.h"
 
 /** @addtogroup W7500x_StdPeriph_Examples
  * @{
@@ -38,26 +51,136 @@
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
-#define DATA_BUF_SIZE 2048
+/* Fast boot: serve at once on the address of the last lease, or on the
+ * fallback address if there is none, while DHCP runs in the background */
+#ifndef NET_FAST_BOOT
+#define NET_FAST_BOOT 0
+#endif
+
+/* Static configuration used while DHCP has not leased an address, after
+ * DHCP has given up or, with NET_FAST_BOOT, until the first lease */
+#ifndef NET_FALLBACK
+#define NET_FALLBACK 1
+#endif
+#ifndef NET_FALLBACK_IP
+#define NET_FALLBACK_IP { 192, 168, 0, 10 }
+#endif
+#ifndef NET_FALLBACK_GW
+#define NET_FALLBACK_GW { 192, 168, 0, 1 }
+#endif
+#ifndef NET_FALLBACK_SN
+#define NET_FALLBACK_SN { 255, 255, 255, 0 }
+#endif
+#ifndef NET_FALLBACK_DNS
+#define NET_FALLBACK_DNS { 8, 8, 8, 8 }
+#endif
+
+/* Storage attribute of the last lease. Placing it in a RAM section the
+ * startup code does not clear keeps it across a warm reset. */
+#ifndef NET_NOINIT
+#define NET_NOINIT
+#endif
+
+#define NET_LEASE_MAGIC 0x4C534531  /* "LSE1" */
+
+/* TOE buffer memory per socket in KB, each 0, 1, 2, 4, 8 or 16, out of
+ * 16 KB per direction. The DHCP and telemetry sockets get what their
+ * datagrams need, the Modbus socket what a few pipelined frames need, and
+ * the HTTP sockets the rest of the TX memory, see Network_Buffers();
+ * sockets with no role get none. */
+#define NET_BUF_TOTAL_KB 16
+#ifndef NET_DHCP_TXBUF_KB
+#define NET_DHCP_TXBUF_KB 1
+#endif
+#ifndef NET_DHCP_RXBUF_KB
+#define NET_DHCP_RXBUF_KB 1
+#endif
+#ifndef NET_TELEMETRY_TXBUF_KB
+#define NET_TELEMETRY_TXBUF_KB 1
+#endif
+#ifndef NET_TELEMETRY_RXBUF_KB
+#define NET_TELEMETRY_RXBUF_KB 1
+#endif
+#ifndef NET_MODBUS_TXBUF_KB
+#define NET_MODBUS_TXBUF_KB 1
+#endif
+#ifndef NET_MODBUS_RXBUF_KB
+#define NET_MODBUS_RXBUF_KB 1
+#endif
+#ifndef NET_HTTP_RXBUF_KB
+#define NET_HTTP_RXBUF_KB 2
+#endif
+
+/* The DHCP client reads a whole datagram into its arena slice */
+#if (NET_DHCP_RXBUF_KB * 1024) > ARENA_DHCP_SIZE
+#error "DHCP socket RX buffer larger than its arena slice"
+#endif
+
+/* Every HTTP socket must take a whole piece of a long reply */
+#if (NET_DHCP_TXBUF_KB + NET_TELEMETRY_TXBUF_KB + NET_MODBUS_TXBUF_KB + HTTP_SOCK_COUNT * ((HTTP_TX_BUF_SIZE + 1023) / 1024)) > NET_BUF_TOTAL_KB
+#error "Not enough TX buffer memory for HTTP_TX_BUF_SIZE on every HTTP socket"
+#endif
+#if (NET_DHCP_RXBUF_KB + NET_TELEMETRY_RXBUF_KB + NET_MODBUS_RXBUF_KB + HTTP_SOCK_COUNT * NET_HTTP_RXBUF_KB) > NET_BUF_TOTAL_KB
+#error "RX buffer sizes exceed the TOE buffer memory"
+#endif
+
+/* Events of the HTTP socket pool */
+#define EVENT_HTTP_SOCKS (((1UL << HTTP_SOCK_COUNT) - 1) << HTTP_SOCK_START)
 
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 static __IO uint32_t TimingDelay;
-uint8_t test_buf[DATA_BUF_SIZE];
+static __IO uint32_t TickCount;
 wiz_NetInfo gWIZNETINFO;
 
+static uint8_t net_leased;                  /* DHCP holds a lease */
+static uint8_t net_configured;              /* An address is in use */
+static uint8_t net_lease_warm;              /* The lease survived a warm reset */
+
+/* Last leased configuration */
+static NET_NOINIT struct
+{
+    uint32_t magic;
+    uint8_t ip[4];
+    uint8_t gw[4];
+    uint8_t sn[4];
+    uint8_t dns[4];
+    uint32_t check;
+} net_lease;
+
 /* Private function prototypes -----------------------------------------------*/
 static void UART_Config(void);
 static void GPIO_Config(void);
 static void DUALTIMER_Config(void);
+static void WZTOE_Config(void);
+static void Network_Buffers(void);
 static void Network_Config(void);
+static void Network_Print(void);
+static void Network_Apply(const uint8_t* ip, const uint8_t* gw, const uint8_t* sn, const uint8_t* dns);
+static void Network_Fallback(void);
+#if NET_FAST_BOOT
+static void Network_FastBoot(void);
+#endif
+static void Network_Run(void);
+static uint32_t Network_LeaseCheck(void);
+static void Network_SaveLease(void);
+static void Storage_Restore(uint8_t type, uint8_t key, const uint8_t* data, uint8_t len);
 void dhcp_assign(void);
 void dhcp_update(void);
 void dhcp_conflict(void);
-int32_t WebServer(uint8_t sn, uint8_t* buf, uint16_t port);
 void delay(__IO uint32_t milliseconds);
 void TimingDelay_Decrement(void);
 
+/* Main loop tasks and the events they run on */
+static const Event_Task task_table[] = {
+    { Network_Run, EVENT_SOCKET(0) | EVENT_SECOND },
+    { WebServer_Run, EVENT_HTTP_SOCKS | EVENT_SAMPLE },
+    { History_Update, EVENT_SAMPLE },
+    { Telemetry_Run, EVENT_SOCKET(TELEMETRY_SOCK) | EVENT_SAMPLE },
+    { Modbus_Run, EVENT_SOCKET(MODBUS_SOCK) | EVENT_SAMPLE },
+    { Store_Run, EVENT_SECOND },
+};
+
 /* Private functions ---------------------------------------------------------*/
 
 /**
@@ -67,11 +190,11 @@ void TimingDelay_Decrement(void);
  */
 int main(void)
 {
-    uint32_t ret;
-    uint8_t dhcp_retry = 0;
-
     SystemInit();
 
+    /* Working buffers, painted for the high-water marks */
+    Arena_Init();
+
     /* SysTick_Config */
     SysTick_Config((GetSystemClock() / 1000));
 
@@ -80,81 +203,88 @@ int main(void)
 
     UART_Config();
     GPIO_Config();
+    Sampler_Init();
+    History_Init();
+
+    /* Lease, calibration and hourly history from the flash store */
+    net_lease_warm = (net_lease.magic == NET_LEASE_MAGIC && net_lease.check == Network_LeaseCheck());
+    Store_Init(Storage_Restore);
+
     DUALTIMER_Config();
 
-    printf("W7500x Standard Peripheral Library version : %d.%d.%d\r\n", __W7500X_STDPERIPH_VERSION_MAIN, __W7500X_STDPERIPH_VERSION_SUB1, __W7500X_STDPERIPH_VERSION_SUB2);
+    LOG_INFO("W7500x Standard Peripheral Library version : %d.%d.%d", __W7500X_STDPERIPH_VERSION_MAIN, __W7500X_STDPERIPH_VERSION_SUB1, __W7500X_STDPERIPH_VERSION_SUB2);
 
-    printf("SourceClock : %d\r\n", (int) GetSourceClock());
-    printf("SystemClock : %d\r\n", (int) GetSystemClock());
+    LOG_INFO("SourceClock : %d", (int) GetSourceClock());
+    LOG_INFO("SystemClock : %d", (int) GetSystemClock());
 
     /* Initialize PHY */
 #ifdef W7500
-    printf("PHY Init : %s\r\n", PHY_Init(GPIOB, GPIO_Pin_15, GPIO_Pin_14) == SET ? "Success" : "Fail");
+    LOG_INFO("PHY Init : %s", PHY_Init(GPIOB, GPIO_Pin_15, GPIO_Pin_14) == SET ? "Success" : "Fail");
 #elif defined (W7500P)
-    printf("PHY Init : %s\r\n", PHY_Init(GPIOB, GPIO_Pin_14, GPIO_Pin_15) == SET ? "Success" : "Fail");
+    LOG_INFO("PHY Init : %s", PHY_Init(GPIOB, GPIO_Pin_14, GPIO_Pin_15) == SET ? "Success" : "Fail");
 #endif
 
     /* Check Link */
-    printf("Link : %s\r\n", PHY_GetLinkStatus() == PHY_LINK_ON ? "On" : "Off");
+    LOG_INFO("Link : %s", PHY_GetLinkStatus() == PHY_LINK_ON ? "On" : "Off");
+
+    /* Socket buffer memory, before any socket is opened */
+    Network_Buffers();
 
     /* Network information setting before DHCP operation. Set only MAC. */
     Network_Config();
 
-    /* DHCP Process */
-    DHCP_init(0, test_buf);
+    /* DHCP runs in the background from the main loop */
+    DHCP_init(0, arena.dhcp);
     reg_dhcp_cbfunc(dhcp_assign, dhcp_update, dhcp_conflict);
     if (gWIZNETINFO.dhcp == NETINFO_DHCP) {       // DHCP
-        printf("Start DHCP\r\n");
-        while (1) {
-            ret = DHCP_run();
-
-            if (ret == DHCP_IP_LEASED) {
-                printf("DHCP Success\r\n");
-                break;
-            }
-            else if (ret == DHCP_FAILED) {
-                dhcp_retry++;
-            }
-
-            if (dhcp_retry > 3) {
-                printf("DHCP Fail\r\n");
-                break;
-            }
-        }
+        LOG_INFO("Start DHCP");
+#if NET_FAST_BOOT
+        Network_FastBoot();
+#endif
     }
 
-    /* Network information setting after DHCP operation.
-     * Displays the network information allocated by DHCP. */
-    Network_Config();
+    LOG_INFO("System Loop Start");
 
-    printf("System Loop Start\r\n");
+    WebServer_Init();
+    Modbus_Init();
+    WZTOE_Config();
+    Arena_Report();
 
-    while (1) {
-        WebServer(1, test_buf, 80);
-    }
+    Event_Run(task_table, sizeof(task_table) / sizeof(task_table[0]));
 	
 	return 0;
 }
 
 /**
  * @brief  Configures the UART Peripheral.
- * @note
+ * @note   Log output is sent from the TX interrupt, see log.c.
  * @param  None
  * @retval None
  */
 static void UART_Config(void)
 {
     UART_InitTypeDef UART_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
 
     UART_StructInit(&UART_InitStructure);
+    Log_Init();
 
 #if defined (USE_WIZWIKI_W7500_EVAL)
     UART_Init(UART1, &UART_InitStructure);
+    UART_ITConfig(UART1, UART_IT_FLAG_TXI, ENABLE);
     UART_Cmd(UART1, ENABLE);
+    NVIC_InitStructure.NVIC_IRQChannel = UART1_IRQn;
 #else
     S_UART_Init(115200);
+    S_UART_ITConfig(S_UART_CTRL_TXI, ENABLE);
     S_UART_Cmd(ENABLE);
+    NVIC_InitStructure.NVIC_IRQChannel = UART2_IRQn;
 #endif
+
+    /* The TX interrupt drains the log ring */
+    NVIC_InitStructure.NVIC_IRQChannelPriority = 0x3;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
 }
 
 /**
@@ -176,7 +306,10 @@ static void GPIO_Config(void)
 
 /**
  * @brief  Configures the DUALTIMER Peripheral.
- * @note
+ * @note   DUALTIMER0 paces the background ADC scans. DUALTIMER0_Handler()
+ *         in W7500x_it.c posts EVENT_SAMPLE after every scan and, on every
+ *         SAMPLER_RATE_HZ-th interrupt, calls DHCP_time_handler(), the
+ *         DHCP client's 1 s time base, and posts EVENT_SECOND.
  * @param  None
  * @retval None
  */
@@ -185,7 +318,7 @@ static void DUALTIMER_Config(void)
     DUALTIMER_InitTypDef DUALTIMER_InitStructure;
     NVIC_InitTypeDef NVIC_InitStructure;
 
-    DUALTIMER_InitStructure.Timer_Load = GetSystemClock() / 1; //1s
+    DUALTIMER_InitStructure.Timer_Load = GetSystemClock() / SAMPLER_RATE_HZ; //ADC scan period
     DUALTIMER_InitStructure.Timer_Prescaler = DUALTIMER_Prescaler_1;
     DUALTIMER_InitStructure.Timer_Wrapping = DUALTIMER_Periodic;
     DUALTIMER_InitStructure.Timer_Repetition = DUALTIMER_Wrapping;
@@ -202,6 +335,73 @@ static void DUALTIMER_Config(void)
     DUALTIMER_Cmd(DUALTIMER0_0, ENABLE);
 }
 
+/**
+ * @brief  Configures the WZTOE socket interrupt.
+ * @note   WZTOE_Handler() in W7500x_it.c must call Event_SocketHandler().
+ * @param  None
+ * @retval None
+ */
+static void WZTOE_Config(void)
+{
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    Event_Init();
+
+    NVIC_InitStructure.NVIC_IRQChannel = WZTOE_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPriority = 0x1;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
+/**
+ * @brief  Sets the TOE buffer memory of every socket.
+ * @note   The TX memory the DHCP, telemetry and Modbus sockets leave goes
+ *         to the HTTP sockets, the same power of two to each and twice that
+ *         to the first ones while memory is left. A larger TX buffer takes a reply
+ *         in fewer SEND commands and holds more of it for a slow client.
+ * @param  None
+ * @retval None
+ */
+static void Network_Buffers(void)
+{
+    uint8_t memsize[2][_WIZCHIP_SOCK_NUM_];
+    uint8_t left = NET_BUF_TOTAL_KB - NET_DHCP_TXBUF_KB - NET_TELEMETRY_TXBUF_KB - NET_MODBUS_TXBUF_KB;
+    uint8_t kb = NET_BUF_TOTAL_KB;
+    uint8_t sn;
+
+    memset(memsize, 0, sizeof(memsize));
+    memsize[0][0] = NET_DHCP_TXBUF_KB;
+    memsize[1][0] = NET_DHCP_RXBUF_KB;
+    memsize[0][TELEMETRY_SOCK] = NET_TELEMETRY_TXBUF_KB;
+    memsize[1][TELEMETRY_SOCK] = NET_TELEMETRY_RXBUF_KB;
+    memsize[0][MODBUS_SOCK] = NET_MODBUS_TXBUF_KB;
+    memsize[1][MODBUS_SOCK] = NET_MODBUS_RXBUF_KB;
+
+    while (kb * HTTP_SOCK_COUNT > left) {
+        kb >>= 1;
+    }
+    left -= (uint8_t) (kb * HTTP_SOCK_COUNT);
+
+    for (sn = HTTP_SOCK_START; sn < HTTP_SOCK_START + HTTP_SOCK_COUNT; sn++) {
+        memsize[0][sn] = kb;
+        if (left >= kb) {
+            memsize[0][sn] = (uint8_t) (2 * kb);
+            left -= kb;
+        }
+        memsize[1][sn] = NET_HTTP_RXBUF_KB;
+    }
+
+    if (ctlwizchip(CW_INIT_WIZCHIP, (void*) memsize) < 0) {
+        LOG_ERROR("Socket buffer sizes refused, 2 KB each");
+        return;
+    }
+
+    LOG_INFO("Socket TX buffers [KB]: %u %u %u %u %u %u %u %u", memsize[0][0], memsize[0][1], memsize[0][2], memsize[0][3],
+            memsize[0][4], memsize[0][5], memsize[0][6], memsize[0][7]);
+    LOG_INFO("Socket RX buffers [KB]: %u %u %u %u %u %u %u %u", memsize[1][0], memsize[1][1], memsize[1][2], memsize[1][3],
+            memsize[1][4], memsize[1][5], memsize[1][6], memsize[1][7]);
+}
+
 /**
  * @brief  Configures the Network Information.
  * @note
@@ -217,310 +417,258 @@ static void Network_Config(void)
 
     ctlnetwork(CN_SET_NETINFO, (void*) &gWIZNETINFO);
 
-    printf("MAC: %02X:%02X:%02X:%02X:%02X:%02X\r\n", gWIZNETINFO.mac[0], gWIZNETINFO.mac[1], gWIZNETINFO.mac[2], gWIZNETINFO.mac[3], gWIZNETINFO.mac[4], gWIZNETINFO.mac[5]);
-    printf("IP: %d.%d.%d.%d\r\n", gWIZNETINFO.ip[0], gWIZNETINFO.ip[1], gWIZNETINFO.ip[2], gWIZNETINFO.ip[3]);
-    printf("GW: %d.%d.%d.%d\r\n", gWIZNETINFO.gw[0], gWIZNETINFO.gw[1], gWIZNETINFO.gw[2], gWIZNETINFO.gw[3]);
-    printf("SN: %d.%d.%d.%d\r\n", gWIZNETINFO.sn[0], gWIZNETINFO.sn[1], gWIZNETINFO.sn[2], gWIZNETINFO.sn[3]);
-    printf("DNS: %d.%d.%d.%d\r\n", gWIZNETINFO.dns[0], gWIZNETINFO.dns[1], gWIZNETINFO.dns[2], gWIZNETINFO.dns[3]);
+    LOG_INFO("MAC: %02X:%02X:%02X:%02X:%02X:%02X", gWIZNETINFO.mac[0], gWIZNETINFO.mac[1], gWIZNETINFO.mac[2], gWIZNETINFO.mac[3], gWIZNETINFO.mac[4], gWIZNETINFO.mac[5]);
 }
 
 /**
- * @brief  The call back function of ip assign.
- * @note
+ * @brief  Displays the network information in use.
  * @param  None
  * @retval None
  */
-void dhcp_assign(void)
+static void Network_Print(void)
 {
-    getIPfromDHCP(gWIZNETINFO.ip);
-    getGWfromDHCP(gWIZNETINFO.gw);
-    getSNfromDHCP(gWIZNETINFO.sn);
-    getDNSfromDHCP(gWIZNETINFO.dns);
+    LOG_INFO("IP: %d.%d.%d.%d", gWIZNETINFO.ip[0], gWIZNETINFO.ip[1], gWIZNETINFO.ip[2], gWIZNETINFO.ip[3]);
+    LOG_INFO("GW: %d.%d.%d.%d", gWIZNETINFO.gw[0], gWIZNETINFO.gw[1], gWIZNETINFO.gw[2], gWIZNETINFO.gw[3]);
+    LOG_INFO("SN: %d.%d.%d.%d", gWIZNETINFO.sn[0], gWIZNETINFO.sn[1], gWIZNETINFO.sn[2], gWIZNETINFO.sn[3]);
+    LOG_INFO("DNS: %d.%d.%d.%d", gWIZNETINFO.dns[0], gWIZNETINFO.dns[1], gWIZNETINFO.dns[2], gWIZNETINFO.dns[3]);
+}
 
+/**
+ * @brief  Puts an address configuration into use.
+ * @note   Connections on a previous address cannot survive the change, so
+ *         every socket but the DHCP client's is closed; their owners open
+ *         them again on the new address.
+ * @param  ip: IP address.
+ * @param  gw: Gateway address.
+ * @param  sn: Subnet mask.
+ * @param  dns: DNS server address.
+ * @retval None
+ */
+static void Network_Apply(const uint8_t* ip, const uint8_t* gw, const uint8_t* sn, const uint8_t* dns)
+{
+    uint8_t changed = memcmp(gWIZNETINFO.ip, ip, 4) != 0;
+    uint8_t s;
+
+    memcpy(gWIZNETINFO.ip, ip, 4);
+    memcpy(gWIZNETINFO.gw, gw, 4);
+    memcpy(gWIZNETINFO.sn, sn, 4);
+    memcpy(gWIZNETINFO.dns, dns, 4);
     ctlnetwork(CN_SET_NETINFO, (void*) &gWIZNETINFO);
+
+    if (changed && net_configured) {
+        for (s = 1; s < _WIZCHIP_SOCK_NUM_; s++) {
+            close(s);
+        }
+    }
+    net_configured = 1;
+
+    Network_Print();
 }
 
 /**
- * @brief  The call back function of ip update.
- * @note
+ * @brief  Falls back to the static address configuration.
  * @param  None
  * @retval None
  */
-void dhcp_update(void)
+static void Network_Fallback(void)
 {
-    ;
+#if NET_FALLBACK
+    static const uint8_t ip[4] = NET_FALLBACK_IP;
+    static const uint8_t gw[4] = NET_FALLBACK_GW;
+    static const uint8_t sn[4] = NET_FALLBACK_SN;
+    static const uint8_t dns[4] = NET_FALLBACK_DNS;
+
+    LOG_INFO("Using fallback address");
+    Network_Apply(ip, gw, sn, dns);
+#endif
 }
 
+#if NET_FAST_BOOT
 /**
- * @brief  The call back function of ip conflict.
- * @note
+ * @brief  Starts on the last leased address, or on the fallback address.
+ * @note   The address is only used until DHCP has leased one, which
+ *         replaces it if it differs.
  * @param  None
  * @retval None
  */
-void dhcp_conflict(void)
+static void Network_FastBoot(void)
 {
-    ;
+    if (net_lease.magic == NET_LEASE_MAGIC && net_lease.check == Network_LeaseCheck()) {
+        LOG_INFO("Fast boot on last lease");
+        Network_Apply(net_lease.ip, net_lease.gw, net_lease.sn, net_lease.dns);
+    }
+    else {
+        Network_Fallback();
+    }
 }
+#endif
 
 /**
- * @brief  WebServer example function.
- * @note
- * @param  sn: Socket number to use.
- * @param  buf: The buffer the socket will use.
- * @param  port: Socket port number to use.
- * @retval Success or Fail of configuration functions
+ * @brief  Runs the DHCP client for one pass of the main loop.
+ * @note   The client obtains, renews and, when renewal fails, rediscovers
+ *         the lease on its own; the callbacks put every new address into
+ *         use. When it gives up before any address is in use, the fallback
+ *         configuration is applied and discovery continues.
+ * @param  None
+ * @retval None
  */
-int32_t WebServer(uint8_t sn, uint8_t* buf, uint16_t port)
+static void Network_Run(void)
 {
-    uint8_t i;
-    uint8_t adcChannelOffset = 2;
-    int32_t ret;
-    uint16_t size = 0;
-    uint8_t destip[4];
-    uint16_t destport;
-    uint8_t adc_buf[128] = { '\0', };
-
-    switch (getSn_SR(sn))
-    {
-        case SOCK_ESTABLISHED:
-
-            if (getSn_IR(sn) & Sn_IR_CON) {
-
-                getSn_DIPR(sn, destip);
-                destport = getSn_DPORT(sn);
-                printf("%d:Connected - %d.%d.%d.%d : %d\r\n", sn, destip[0], destip[1], destip[2], destip[3], destport);
+    if (gWIZNETINFO.dhcp != NETINFO_DHCP) return;
 
-                setSn_IR(sn, Sn_IR_CON);
+    switch (DHCP_run())
+    {
+        case DHCP_IP_ASSIGN:
+        case DHCP_IP_CHANGED:
+        case DHCP_IP_LEASED:
+            if (!net_leased) {
+                METRICS_ADD(METRICS_DHCP_LEASES, 1);
+                LOG_INFO("DHCP Success, lease %lu s", (unsigned long) getDHCPLeasetime());
+                net_leased = 1;
             }
-
-            if ((size = getSn_RX_RSR(sn)) > 0) {
-                if (size > DATA_BUF_SIZE) size = DATA_BUF_SIZE;
-                ret = recv(sn, buf, size);
-                if (ret <= 0) return ret;
-                printf("%s", buf);
-                             
-                // Read the ADC value (mock example here)
-                adcChannelOffset = 2;
-                ADC_ChannelConfig(i+adcChannelOffset);
-                ADC_StartOfConversion();
-                int adc_value = ADC_GetConversionValue();
-                ADC_Cmd(DISABLE);
-
-                ret = send(sn, "HTTP/1.1 200 OK\r\n"
-                        "Content-Type: text/html\r\n"
-                        "Connection: close\r\n"
-                        "Refresh: 5\r\n"
-                        "\r\n"
-                        "<!DOCTYPE HTML>\r\n"
-                        "<html>\r\n"
-                        "<head>\r\n"
-                        "    <meta charset=\"UTF-8\">\r\n"
-                        "    <meta http-equiv=\"refresh\" content=\"5\">\r\n"
-                        "    <title>Wiznet W7500x Web Server</title>\r\n"
-                        "    <style>\r\n"
-                        "        body {\r\n"
-                        "            font-family: Arial, sans-serif;\r\n"
-                        "            margin: 0;\r\n"
-                        "            padding: 0;\r\n"
-                        "            display: flex;\r\n"
-                        "            justify-content: center;\r\n"
-                        "            align-items: center;\r\n"
-                        "            height: 100vh;\r\n"
-                        "            background-color: #f4f4f9;\r\n"
-                        "        }\r\n"
-                        "        .container {\r\n"
-                        "            text-align: center;\r\n"
-                        "            background: #fff;\r\n"
-                        "            padding: 20px;\r\n"
-                        "            border-radius: 10px;\r\n"
-                        "            box-shadow: 0 4px 8px rgba(0,0,0,0.1);\r\n"
-                        "        }\r\n"
-                        "        h1 {\r\n"
-                        "            color: #333;\r\n"
-                        "        }\r\n"
-                        "        .gauge {\r\n"
-                        "            width: 200px;\r\n"
-                        "            height: 200px;\r\n"
-                        "            border-radius: 50%;\r\n"
-                        "            background: conic-gradient(#4caf50 0% 50%, #f44336 50% 100%);\r\n"
-                        "            position: relative;\r\n"
-                        "            margin: 20px auto;\r\n"
-                        "        }\r\n"
-                        "        .gauge:before {\r\n"
-                        "            content: '';\r\n"
-                        "            width: 160px;\r\n"
-                        "            height: 160px;\r\n"
-                        "            background: #fff;\r\n"
-                        "            border-radius: 50%;\r\n"
-                        "            position: absolute;\r\n"
-                        "            top: 50%;\r\n"
-                        "            left: 50%;\r\n"
-                        "            transform: translate(-50%, -50%);\r\n"
-                        "        }\r\n"
-                        "        .gauge:after {\r\n"
-                        "            content: '", sizeof("HTTP/1.1 200 OK\r\n"
-                        "Content-Type: text/html\r\n"
-                        "Connection: close\r\n"
-                        "Refresh: 5\r\n"
-                        "\r\n"
-                        "<!DOCTYPE HTML>\r\n"
-                        "<html>\r\n"
-                        "<head>\r\n"
-                        "    <meta charset=\"UTF-8\">\r\n"
-                        "    <meta http-equiv=\"refresh\" content=\"5\">\r\n"
-                        "    <title>Wiznet W7500x Web Server</title>\r\n"
-                        "    <style>\r\n"
-                        "        body {\r\n"
-                        "            font-family: Arial, sans-serif;\r\n"
-                        "            margin: 0;\r\n"
-                        "            padding: 0;\r\n"
-                        "            display: flex;\r\n"
-                        "            justify-content: center;\r\n"
-                        "            align-items: center;\r\n"
-                        "            height: 100vh;\r\n"
-                        "            background-color: #f4f4f9;\r\n"
-                        "        }\r\n"
-                        "        .container {\r\n"
-                        "            text-align: center;\r\n"
-                        "            background: #fff;\r\n"
-                        "            padding: 20px;\r\n"
-                        "            border-radius: 10px;\r\n"
-                        "            box-shadow: 0 4px 8px rgba(0,0,0,0.1);\r\n"
-                        "        }\r\n"
-                        "        h1 {\r\n"
-                        "            color: #333;\r\n"
-                        "        }\r\n"
-                        "        .gauge {\r\n"
-                        "            width: 200px;\r\n"
-                        "            height: 200px;\r\n"
-                        "            border-radius: 50%;\r\n"
-                        "            background: conic-gradient(#4caf50 0% 50%, #f44336 50% 100%);\r\n"
-                        "            position: relative;\r\n"
-                        "            margin: 20px auto;\r\n"
-                        "        }\r\n"
-                        "        .gauge:before {\r\n"
-                        "            content: '';\r\n"
-                        "            width: 160px;\r\n"
-                        "            height: 160px;\r\n"
-                        "            background: #fff;\r\n"
-                        "            border-radius: 50%;\r\n"
-                        "            position: absolute;\r\n"
-                        "            top: 50%;\r\n"
-                        "            left: 50%;\r\n"
-                        "            transform: translate(-50%, -50%);\r\n"
-                        "        }\r\n"
-                        "        .gauge:after {\r\n"
-                        "            content: '") - 1);
-                if (ret < 0) {
-                    close(sn);
-                    return ret;
-                }
-
-                char value_str[4];
-                snprintf(value_str, sizeof(value_str), "%d", adc_value);
-                ret = send(sn, value_str, strlen(value_str));
-                if (ret < 0) {
-                    close(sn);
-                    return ret;
-                }
-
-                ret = send(sn, "';\r\n"
-                        "            font-size: 2em;\r\n"
-                        "            color: #333;\r\n"
-                        "            position: absolute;\r\n"
-                        "            top: 50%;\r\n"
-                        "            left: 50%;\r\n"
-                        "            transform: translate(-50%, -50%);\r\n"
-                        "        }\r\n"
-                        "    </style>\r\n"
-                        "</head>\r\n"
-                        "<body>\r\n"
-                        "    <div class=\"container\">\r\n"
-                        "        <h1>Wiznet W7500x Web Server</h1>\r\n"
-                        "        <div class=\"gauge\" style=\"background: conic-gradient(#4caf50 0% ", sizeof("';\r\n"
-                        "            font-size: 2em;\r\n"
-                        "            color: #333;\r\n"
-                        "            position: absolute;\r\n"
-                        "            top: 50%;\r\n"
-                        "            left: 50%;\r\n"
-                        "            transform: translate(-50%, -50%);\r\n"
-                        "        }\r\n"
-                        "    </style>\r\n"
-                        "</head>\r\n"
-                        "<body>\r\n"
-                        "    <div class=\"container\">\r\n"
-                        "        <h1>Wiznet W7500x Web Server</h1>\r\n"
-                        "        <div class=\"gauge\" style=\"background: conic-gradient(#4caf50 0% ") - 1);
-                if (ret < 0) {
-                    close(sn);
-                    return ret;
-                }
-
-                char gauge_value_str[4];
-                snprintf(gauge_value_str, sizeof(gauge_value_str), "%d", adc_value / 2);
-                ret = send(sn, gauge_value_str, strlen(gauge_value_str));
-                if (ret < 0) {
-                    close(sn);
-                    return ret;
-                }
-
-                ret = send(sn, "%, #f44336 ", sizeof("%, #f44336 ") - 1);
-                if (ret < 0) {
-                    close(sn);
-                    return ret;
-                }
-
-                ret = send(sn, gauge_value_str, strlen(gauge_value_str));
-                if (ret < 0) {
-                    close(sn);
-                    return ret;
-                }
-
-                ret = send(sn, "% 100%);\">\r\n"
-                        "        </div>\r\n"
-                        "        <p>Analog input 1 is ", sizeof("% 100%);\">\r\n"
-                        "        </div>\r\n"
-                        "        <p>Analog input 1 is ") - 1);
-                if (ret < 0) {
-                    close(sn);
-                    return ret;
-                }
-
-   
-
-                ret = send(sn, "</p>\r\n</div>\r\n</body>\r\n</html>\r\n", sizeof("</p>\r\n</div>\r\n</body>\r\n</html>\r\n") - 1);
-                if (ret < 0) {
-                    close(sn);
-                    return ret;
-                }
-
-                disconnect(sn);
+            break;
+        case DHCP_FAILED:
+            METRICS_ADD(METRICS_DHCP_FAILURES, 1);
+            if (net_leased) {
+                LOG_WARN("DHCP renewal failed");
+                net_leased = 0;
+            }
+            else if (!net_configured) {
+                LOG_WARN("DHCP Fail");
+                Network_Fallback();
             }
-
             break;
-        case SOCK_CLOSE_WAIT:
-
-            if ((ret = disconnect(sn)) != SOCK_OK) return ret;
-
-            printf("%d:Socket Closed\r\n", sn);
-
+        default:
             break;
-        case SOCK_INIT:
+    }
+}
 
-            printf("%d:Listen, Web server, port [%d]\r\n", sn, port);
+/**
+ * @brief  Computes the check word of the stored lease.
+ * @param  None
+ * @retval Check word.
+ */
+static uint32_t Network_LeaseCheck(void)
+{
+    const uint8_t* p = net_lease.ip;
+    uint32_t check = NET_LEASE_MAGIC;
+    uint8_t i;
 
-            if ((ret = listen(sn)) != SOCK_OK) return ret;
+    for (i = 0; i < 16; i++) {
+        check = (check << 5) + (check >> 27) + p[i];
+    }
+    return check;
+}
 
-            break;
-        case SOCK_CLOSED:
+/**
+ * @brief  Remembers the configuration in use as the last lease.
+ * @param  None
+ * @retval None
+ */
+static void Network_SaveLease(void)
+{
+    uint8_t changed = (net_lease.magic != NET_LEASE_MAGIC || memcmp(net_lease.ip, gWIZNETINFO.ip, 4) != 0
+                       || memcmp(net_lease.gw, gWIZNETINFO.gw, 4) != 0 || memcmp(net_lease.sn, gWIZNETINFO.sn, 4) != 0
+                       || memcmp(net_lease.dns, gWIZNETINFO.dns, 4) != 0);
+
+    memcpy(net_lease.ip, gWIZNETINFO.ip, 4);
+    memcpy(net_lease.gw, gWIZNETINFO.gw, 4);
+    memcpy(net_lease.sn, gWIZNETINFO.sn, 4);
+    memcpy(net_lease.dns, gWIZNETINFO.dns, 4);
+    net_lease.magic = NET_LEASE_MAGIC;
+    net_lease.check = Network_LeaseCheck();
+
+    /* A renewal of the same lease costs no flash */
+    if (changed) Store_Write(STORE_REC_LEASE, 0, net_lease.ip, 16);
+}
 
-            if ((ret = socket(sn, Sn_MR_TCP, port, 0x00)) != sn) return ret;
+/**
+ * @brief  Takes back a record of the flash store at boot.
+ * @note   A lease kept in RAM across a warm reset is newer than any in
+ *         flash, which may still have been waiting in the store's queue.
+ * @param  type: Record type, one of STORE_REC_*.
+ * @param  key: Record key.
+ * @param  data: Payload.
+ * @param  len: Length of the payload.
+ * @retval None
+ */
+static void Storage_Restore(uint8_t type, uint8_t key, const uint8_t* data, uint8_t len)
+{
+    Moisture_Point points[MOISTURE_CAL_POINTS_MAX];
 
+    switch (type)
+    {
+        case STORE_REC_LEASE:
+            if (len == 16 && !net_lease_warm) {
+                memcpy(net_lease.ip, data, 16);
+                net_lease.magic = NET_LEASE_MAGIC;
+                net_lease.check = Network_LeaseCheck();
+            }
+            break;
+        case STORE_REC_CALIBRATION:
+            if (len > 0 && len <= sizeof(points) && len % sizeof(Moisture_Point) == 0) {
+                memcpy(points, data, len);
+                Moisture_SetCalibration(key, points, (uint8_t) (len / sizeof(Moisture_Point)));
+            }
+            break;
+        case STORE_REC_ROLLUP:
+            if (key == HISTORY_TIER_HOUR) History_Restore(data, len);
             break;
         default:
             break;
     }
-    return 1;
+}
+
+/**
+ * @brief  The call back function of ip assign.
+ * @note   Puts the leased address into use and remembers it for a fast
+ *         boot.
+ * @param  None
+ * @retval None
+ */
+void dhcp_assign(void)
+{
+    uint8_t ip[4], gw[4], sn[4], dns[4];
+
+    getIPfromDHCP(ip);
+    getGWfromDHCP(gw);
+    getSNfromDHCP(sn);
+    getDNSfromDHCP(dns);
+
+    Network_Apply(ip, gw, sn, dns);
+    Network_SaveLease();
+}
+
+/**
+ * @brief  The call back function of ip update.
+ * @note   The renewed lease carries another address; it replaces the old
+ *         one without a reboot.
+ * @param  None
+ * @retval None
+ */
+void dhcp_update(void)
+{
+    METRICS_ADD(METRICS_DHCP_CHANGES, 1);
+    LOG_INFO("DHCP address changed");
+    dhcp_assign();
+}
+
+/**
+ * @brief  The call back function of ip conflict.
+ * @note   Another host answered for the offered address. It is dropped and
+ *         the DHCP client declines it and starts over.
+ * @param  None
+ * @retval None
+ */
+void dhcp_conflict(void)
+{
+    static const uint8_t zero[4] = { 0, 0, 0, 0 };
+
+    METRICS_ADD(METRICS_DHCP_CONFLICTS, 1);
+    LOG_WARN("DHCP address conflict");
+    net_leased = 0;
+    Network_Apply(zero, zero, zero, zero);
+    net_configured = 0;
 }
 
 /**
@@ -532,17 +680,32 @@ void delay(__IO uint32_t milliseconds)
 {
     TimingDelay = milliseconds;
 
+    /* SysTick wakes the core every millisecond */
     while (TimingDelay != 0)
-        ;
+        __WFI();
+}
+
+/**
+ * @brief  Returns the milliseconds elapsed since SysTick was started.
+ * @param  None
+ * @retval Millisecond tick, wraps after about 49 days.
+ */
+uint32_t Tick_GetMs(void)
+{
+    return TickCount;
 }
 
 /**
  * @brief  Decrements the TimingDelay variable.
+ * @note   Called every millisecond from SysTick_Handler(); also advances
+ *         the millisecond tick.
  * @param  None
  * @retval None
  */
 void TimingDelay_Decrement(void)
 {
+    TickCount++;
+
     if (TimingDelay != 0x00) {
         TimingDelay--;
     }
@@ -0,0 +1,311 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/metrics.c
+ * @author  WIZnet
+ * @brief   Counters and cycle-count histograms of the hot paths, exported in
+ *          the Prometheus text format
+ ******************************************************************************
+ * @attention
+ *
+ * Cycle counts are taken from SysTick: the millisecond tick times the
+ * reload value plus the cycles already counted down in the current
+ * millisecond. There is no cycle counter on the Cortex-M0, and this costs a
+ * couple of register reads and a multiply. Spans up to about 89 s at 48 MHz
+ * are measured exactly.
+ *
+ * Recording a span updates its phase's count, sum, maximum and one of
+ * METRICS_BUCKET_NUM + 1 histogram buckets, found in at most
+ * METRICS_BUCKET_NUM compares. The document is rendered line by line from a
+ * snapshot taken when it is opened, so its length is known before it is
+ * sent.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "main.h"
+#include "metrics.h"
+#include "tick.h"
+#include "event_loop.h"
+#include "arena.h"
+#include "log.h"
+
+#if METRICS_ENABLE
+
+/* Private define ------------------------------------------------------------*/
+#define METRICS_LINE_MAX 96
+
+/* Lines of the document: one per counter and gauge, the histogram type
+ * line, every phase's buckets, sum and count, the maximum type line and
+ * every phase's maximum, then a type line and one line per arena region
+ * for the region sizes and again for their high-water marks */
+#define METRICS_GAUGE_NUM   4
+#define METRICS_HIST_LINES  (METRICS_BUCKET_NUM + 3)
+#define METRICS_ITEM_HIST   (METRICS_COUNTER_NUM + METRICS_GAUGE_NUM)
+#define METRICS_ITEM_MAX    (METRICS_ITEM_HIST + 1 + METRICS_PHASE_NUM * METRICS_HIST_LINES)
+#define METRICS_ITEM_ARENA  (METRICS_ITEM_MAX + 1 + METRICS_PHASE_NUM)
+#define METRICS_ITEM_NUM    (METRICS_ITEM_ARENA + 2 * (1 + ARENA_REGION_NUM))
+
+/* Private variables ---------------------------------------------------------*/
+uint32_t metrics_counter[METRICS_COUNTER_NUM];
+static Metrics_Phase metrics_phase[METRICS_PHASE_NUM];
+
+static const char* const metrics_counter_name[METRICS_COUNTER_NUM] = {
+    "connections",
+    "close_wait",
+    "requests",
+    "rx_bytes",
+    "tx_bytes",
+    "send_errors",
+    "dhcp_leases",
+    "dhcp_changes",
+    "dhcp_conflicts",
+    "dhcp_failures",
+    "send_waits",
+    "send_timeouts",
+    "not_modified",
+    "flash_records",
+    "flash_erases",
+    "modbus_requests",
+    "modbus_exceptions",
+    "http_accepted",
+    "http_shed",
+    "http_rate_limited",
+};
+
+static const char* const metrics_phase_name[METRICS_PHASE_NUM] = {
+    "recv",
+    "adc",
+    "render",
+    "send",
+    "disconnect",
+    "request",
+    "modbus",
+};
+
+/* Snapshot the document is rendered from */
+static uint32_t metrics_snap_counter[METRICS_COUNTER_NUM];
+static Metrics_Phase metrics_snap_phase[METRICS_PHASE_NUM];
+static uint32_t metrics_snap_uptime;
+static uint32_t metrics_snap_sleeps;
+static uint32_t metrics_snap_log_dropped;
+static uint16_t metrics_snap_arena[ARENA_REGION_NUM];
+
+/* Fails to compile if METRICS_RAM_SIZE no longer covers the state above */
+typedef char metrics_ram_check[(sizeof(metrics_counter) + sizeof(metrics_phase) + sizeof(metrics_snap_counter) + sizeof(metrics_snap_phase)
+        + sizeof(metrics_snap_uptime) + sizeof(metrics_snap_sleeps) + sizeof(metrics_snap_log_dropped) + sizeof(metrics_snap_arena) <= METRICS_RAM_SIZE) ? 1 : -1];
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Renders one line, or a type line and its sample, of the document.
+ * @param  item: Line number, below METRICS_ITEM_NUM.
+ * @param  out: Output buffer of METRICS_LINE_MAX bytes.
+ * @retval Length of the line.
+ */
+static uint16_t Metrics_Line(uint16_t item, char* out)
+{
+    const Metrics_Phase* p;
+    char region[ARENA_NAME_MAX];
+    uint32_t cumulative;
+    uint8_t phase;
+    uint8_t line;
+    uint8_t b;
+    int n;
+
+    if (item < METRICS_COUNTER_NUM) {
+        n = snprintf(out, METRICS_LINE_MAX, "# TYPE wiz_%s_total counter\nwiz_%s_total %lu\n",
+                metrics_counter_name[item], metrics_counter_name[item], (unsigned long) metrics_snap_counter[item]);
+    }
+    else if (item == METRICS_COUNTER_NUM) {
+        n = snprintf(out, METRICS_LINE_MAX, "# TYPE wiz_uptime_seconds gauge\nwiz_uptime_seconds %lu.%03u\n",
+                (unsigned long) (metrics_snap_uptime / 1000), (unsigned) (metrics_snap_uptime % 1000));
+    }
+    else if (item == METRICS_COUNTER_NUM + 1) {
+        n = snprintf(out, METRICS_LINE_MAX, "# TYPE wiz_cpu_hz gauge\nwiz_cpu_hz %lu\n", (unsigned long) GetSystemClock());
+    }
+    else if (item == METRICS_COUNTER_NUM + 2) {
+        n = snprintf(out, METRICS_LINE_MAX, "# TYPE wiz_sleeps_total counter\nwiz_sleeps_total %lu\n", (unsigned long) metrics_snap_sleeps);
+    }
+    else if (item == METRICS_COUNTER_NUM + 3) {
+        n = snprintf(out, METRICS_LINE_MAX, "# TYPE wiz_log_dropped_total counter\nwiz_log_dropped_total %lu\n", (unsigned long) metrics_snap_log_dropped);
+    }
+    else if (item == METRICS_ITEM_HIST) {
+        n = snprintf(out, METRICS_LINE_MAX, "# TYPE wiz_phase_cycles histogram\n");
+    }
+    else if (item < METRICS_ITEM_MAX) {
+        phase = (uint8_t) ((item - METRICS_ITEM_HIST - 1) / METRICS_HIST_LINES);
+        line = (uint8_t) ((item - METRICS_ITEM_HIST - 1) % METRICS_HIST_LINES);
+        p = &metrics_snap_phase[phase];
+
+        if (line <= METRICS_BUCKET_NUM) {
+            cumulative = 0;
+            for (b = 0; b <= line; b++) {
+                cumulative += p->bucket[b];
+            }
+            if (line < METRICS_BUCKET_NUM) {
+                n = snprintf(out, METRICS_LINE_MAX, "wiz_phase_cycles_bucket{phase=\"%s\",le=\"%lu\"} %lu\n",
+                        metrics_phase_name[phase], (unsigned long) METRICS_BUCKET_FIRST << (2 * line), (unsigned long) cumulative);
+            }
+            else {
+                n = snprintf(out, METRICS_LINE_MAX, "wiz_phase_cycles_bucket{phase=\"%s\",le=\"+Inf\"} %lu\n",
+                        metrics_phase_name[phase], (unsigned long) cumulative);
+            }
+        }
+        else if (line == METRICS_BUCKET_NUM + 1) {
+            n = snprintf(out, METRICS_LINE_MAX, "wiz_phase_cycles_sum{phase=\"%s\"} %llu\n",
+                    metrics_phase_name[phase], (unsigned long long) p->sum);
+        }
+        else {
+            n = snprintf(out, METRICS_LINE_MAX, "wiz_phase_cycles_count{phase=\"%s\"} %lu\n",
+                    metrics_phase_name[phase], (unsigned long) p->count);
+        }
+    }
+    else if (item == METRICS_ITEM_MAX) {
+        n = snprintf(out, METRICS_LINE_MAX, "# TYPE wiz_phase_cycles_max gauge\n");
+    }
+    else if (item < METRICS_ITEM_ARENA) {
+        phase = (uint8_t) (item - METRICS_ITEM_MAX - 1);
+        n = snprintf(out, METRICS_LINE_MAX, "wiz_phase_cycles_max{phase=\"%s\"} %lu\n",
+                metrics_phase_name[phase], (unsigned long) metrics_snap_phase[phase].max);
+    }
+    else if (item == METRICS_ITEM_ARENA) {
+        n = snprintf(out, METRICS_LINE_MAX, "# TYPE wiz_arena_size_bytes gauge\n");
+    }
+    else if (item <= METRICS_ITEM_ARENA + ARENA_REGION_NUM) {
+        line = (uint8_t) (item - METRICS_ITEM_ARENA - 1);
+        Arena_RegionName(line, region);
+        n = snprintf(out, METRICS_LINE_MAX, "wiz_arena_size_bytes{region=\"%s\"} %u\n", region, Arena_RegionSize(line));
+    }
+    else if (item == METRICS_ITEM_ARENA + 1 + ARENA_REGION_NUM) {
+        n = snprintf(out, METRICS_LINE_MAX, "# TYPE wiz_arena_high_water_bytes gauge\n");
+    }
+    else {
+        line = (uint8_t) (item - METRICS_ITEM_ARENA - 2 - ARENA_REGION_NUM);
+        Arena_RegionName(line, region);
+        n = snprintf(out, METRICS_LINE_MAX, "wiz_arena_high_water_bytes{region=\"%s\"} %u\n", region, metrics_snap_arena[line]);
+    }
+
+    if (n < 0) return 0;
+    return (uint16_t) (n >= METRICS_LINE_MAX ? METRICS_LINE_MAX - 1 : n);
+}
+
+/**
+ * @brief  Returns the CPU cycle count.
+ * @note   Wraps around; only differences are meaningful.
+ * @param  None
+ * @retval Cycles since SysTick was started.
+ */
+uint32_t Metrics_Cycles(void)
+{
+    uint32_t ms;
+    uint32_t val;
+    uint32_t load = SysTick->LOAD;
+
+    /* Re-read when the millisecond tick moved during the read */
+    do {
+        ms = Tick_GetMs();
+        val = SysTick->VAL;
+    } while (ms != Tick_GetMs());
+
+    return ms * (load + 1) + (load - val);
+}
+
+/**
+ * @brief  Records the duration of one pass through a phase.
+ * @note   May be called from interrupt handlers for phases timed only
+ *         there.
+ * @param  phase: One of METRICS_PHASE_*.
+ * @param  cycles: Duration in CPU cycles.
+ * @retval None
+ */
+void Metrics_Record(uint8_t phase, uint32_t cycles)
+{
+    Metrics_Phase* p = &metrics_phase[phase];
+    uint32_t bound = METRICS_BUCKET_FIRST;
+    uint8_t b = 0;
+
+    /* SysTick reloaded while its interrupt was held off */
+    if ((int32_t) cycles < 0) cycles = 0;
+
+    while (b < METRICS_BUCKET_NUM && cycles > bound) {
+        bound <<= 2;
+        b++;
+    }
+
+    p->bucket[b]++;
+    p->count++;
+    p->sum += cycles;
+    if (cycles > p->max) p->max = cycles;
+}
+
+/**
+ * @brief  Takes a snapshot of the metrics and positions a cursor on the
+ *         start of the document.
+ * @param  cur: Cursor to set up.
+ * @retval None
+ */
+void Metrics_Open(Metrics_Cursor* cur)
+{
+    uint8_t region;
+
+    __disable_irq();
+    memcpy(metrics_snap_counter, metrics_counter, sizeof(metrics_snap_counter));
+    memcpy(metrics_snap_phase, metrics_phase, sizeof(metrics_snap_phase));
+    __enable_irq();
+
+    metrics_snap_uptime = Tick_GetMs();
+    metrics_snap_sleeps = Event_GetSleeps();
+    metrics_snap_log_dropped = Log_GetDropped();
+    for (region = 0; region < ARENA_REGION_NUM; region++) {
+        metrics_snap_arena[region] = Arena_HighWater(region);
+    }
+    cur->item = 0;
+}
+
+/**
+ * @brief  Renders as many whole lines as fit, starting at the cursor.
+ * @param  cur: Read cursor, advanced past the lines rendered.
+ * @param  out: Output buffer.
+ * @param  size: Size of the output buffer, at least METRICS_LINE_MAX.
+ * @retval Number of bytes rendered, 0 when the cursor is at its end.
+ */
+uint16_t Metrics_Read(Metrics_Cursor* cur, uint8_t* out, uint16_t size)
+{
+    char line[METRICS_LINE_MAX];
+    uint16_t len = 0;
+    uint16_t n;
+
+    while (cur->item < METRICS_ITEM_NUM) {
+        n = Metrics_Line(cur->item, line);
+        if (len + n > size) break;
+        memcpy(out + len, line, n);
+        len += n;
+        cur->item++;
+    }
+    return len;
+}
+
+/**
+ * @brief  Returns the number of bytes Metrics_Read() will render from a
+ *         freshly opened cursor.
+ * @param  cur: Read cursor.
+ * @retval Length of the whole document.
+ */
+uint32_t Metrics_Length(const Metrics_Cursor* cur)
+{
+    char line[METRICS_LINE_MAX];
+    uint32_t len = 0;
+    uint16_t item;
+
+    for (item = cur->item; item < METRICS_ITEM_NUM; item++) {
+        len += Metrics_Line(item, line);
+    }
+    return len;
+}
+
+#endif /* METRICS_ENABLE */
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
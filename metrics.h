@@ -0,0 +1,107 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/metrics.h
+ * @author  WIZnet
+ * @brief   Header for metrics.c module
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __METRICS_H
+#define __METRICS_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/* 0 compiles the instrumentation and /metrics out */
+#ifndef METRICS_ENABLE
+#define METRICS_ENABLE 1
+#endif
+
+/* Counters */
+#define METRICS_CONNECTIONS     0
+#define METRICS_CLOSE_WAIT      1
+#define METRICS_REQUESTS        2
+#define METRICS_BYTES_IN        3
+#define METRICS_BYTES_OUT       4
+#define METRICS_SEND_ERRORS     5
+#define METRICS_DHCP_LEASES     6
+#define METRICS_DHCP_CHANGES    7
+#define METRICS_DHCP_CONFLICTS  8
+#define METRICS_DHCP_FAILURES   9
+#define METRICS_SEND_WAITS      10
+#define METRICS_SEND_TIMEOUTS   11
+#define METRICS_NOT_MODIFIED    12
+#define METRICS_FLASH_RECORDS   13
+#define METRICS_FLASH_ERASES    14
+#define METRICS_MODBUS_REQUESTS 15
+#define METRICS_MODBUS_EXCEPTIONS 16
+#define METRICS_HTTP_ACCEPTED   17
+#define METRICS_HTTP_SHED       18
+#define METRICS_HTTP_RATE_LIMITED 19
+#define METRICS_COUNTER_NUM     20
+
+/* Timed phases */
+#define METRICS_PHASE_RECV          0   /* recv() of request data */
+#define METRICS_PHASE_ADC           1   /* ADC scan and filtering, in the timer interrupt */
+#define METRICS_PHASE_RENDER        2   /* Snapshot read and reply assembly */
+#define METRICS_PHASE_SEND          3   /* One send() */
+#define METRICS_PHASE_DISCONNECT    4   /* disconnect() */
+#define METRICS_PHASE_REQUEST       5   /* Whole request, parse to reply */
+#define METRICS_PHASE_MODBUS        6   /* One Modbus request, frame to reply */
+#define METRICS_PHASE_NUM           7
+
+/* Histogram buckets: upper bounds in CPU cycles, each four times the one
+ * before; a last bucket takes everything above */
+#define METRICS_BUCKET_FIRST    1024
+#define METRICS_BUCKET_NUM      7
+
+/* SRAM of the counters and phases, their snapshot and the snapshot's
+ * other values */
+#if METRICS_ENABLE
+#define METRICS_RAM_SIZE (2 * (4 * METRICS_COUNTER_NUM + METRICS_PHASE_NUM * (16 + 4 * (METRICS_BUCKET_NUM + 1))) + 32)
+#else
+#define METRICS_RAM_SIZE 0
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t count;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t bucket[METRICS_BUCKET_NUM + 1];
+} Metrics_Phase;
+
+typedef struct
+{
+    uint16_t item;                          /* Next line to render */
+} Metrics_Cursor;
+
+/* Exported variables --------------------------------------------------------*/
+extern uint32_t metrics_counter[METRICS_COUNTER_NUM];
+
+/* Exported macro ------------------------------------------------------------*/
+#if METRICS_ENABLE
+#define METRICS_ADD(counter, n)         (metrics_counter[counter] += (uint32_t) (n))
+#define METRICS_TIMER(t)                uint32_t t
+#define METRICS_START(t)                ((t) = Metrics_Cycles())
+#define METRICS_STOP(phase, t)          Metrics_Record(phase, Metrics_Cycles() - (t))
+#else
+#define METRICS_ADD(counter, n)         ((void) 0)
+#define METRICS_TIMER(t)                uint32_t t = 0
+#define METRICS_START(t)                ((void) (t))
+#define METRICS_STOP(phase, t)          ((void) (t))
+#endif
+
+/* Exported functions ------------------------------------------------------- */
+uint32_t Metrics_Cycles(void);
+void Metrics_Record(uint8_t phase, uint32_t cycles);
+void Metrics_Open(Metrics_Cursor* cur);
+uint16_t Metrics_Read(Metrics_Cursor* cur, uint8_t* out, uint16_t size);
+uint32_t Metrics_Length(const Metrics_Cursor* cur);
+
+#endif /* __METRICS_H */
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
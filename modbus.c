@@ -0,0 +1,472 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/modbus.c
+ * @author  WIZnet
+ * @brief   Modbus/TCP server for SCADA polling of the readings
+ ******************************************************************************
+ * @attention
+ *
+ * One client at a time is served on MODBUS_SOCK, port 502, and the
+ * connection is kept between polls. Every frame is an MBAP header
+ *
+ *   transaction id, protocol id 0, length of what follows, unit id
+ *
+ * and a PDU; replies repeat the transaction and unit ids, and the unit id
+ * is not checked. Requests need not wait for their replies: every whole
+ * frame in the RX buffer is answered in one pass, from one read of the
+ * sample snapshot, and the replies go out together, in order.
+ *
+ * Supported are Read Holding Registers (3), Read Input Registers (4),
+ * Write Single Register (6) and Write Multiple Registers (16); see
+ * modbus.h for the register map. A frame with another protocol id or a
+ * length out of range closes the connection, as the stream cannot be
+ * resynchronised.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "wizchip_conf.h"
+#include "socket.h"
+#include "modbus.h"
+#include "web_server.h"
+#include "telemetry.h"
+#include "flash_store.h"
+#include "arena.h"
+#include "event_loop.h"
+#include "tick.h"
+#include "log.h"
+
+/* Private define ------------------------------------------------------------*/
+#define MODBUS_MBAP_SIZE    7
+#define MODBUS_ADU_MAX      260             /* MBAP and the longest PDU */
+#define MODBUS_READ_MAX     125             /* Registers per read */
+#define MODBUS_WRITE_MAX    123             /* Registers per write */
+
+#if MODBUS_RX_BUF_SIZE < MODBUS_ADU_MAX || MODBUS_TX_BUF_SIZE < MODBUS_ADU_MAX
+#error "Modbus buffers must take a whole frame"
+#endif
+
+#if (MODBUS_SOCK >= HTTP_SOCK_START) && (MODBUS_SOCK < HTTP_SOCK_START + HTTP_SOCK_COUNT)
+#error "MODBUS_SOCK is part of the HTTP socket pool"
+#endif
+#if MODBUS_SOCK == TELEMETRY_SOCK || MODBUS_SOCK == 0
+#error "MODBUS_SOCK is taken"
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define MODBUS_U16(p)       ((uint16_t) (((p)[0] << 8) | (p)[1]))
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t* const modbus_rx = arena.modbus_rx;      /* MODBUS_RX_BUF_SIZE bytes */
+static uint16_t modbus_rx_len;
+static uint8_t* const modbus_tx = arena.modbus_tx;      /* MODBUS_TX_BUF_SIZE bytes */
+static uint16_t modbus_tx_len;
+static uint32_t modbus_last_active;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Writes a 16-bit value big-endian.
+ * @param  p: Output.
+ * @param  v: Value.
+ * @retval None
+ */
+static void Modbus_Put16(uint8_t* p, uint16_t v)
+{
+    p[0] = (uint8_t) (v >> 8);
+    p[1] = (uint8_t) v;
+}
+
+/**
+ * @brief  Reads an input register.
+ * @param  snap: Snapshot the readings come from.
+ * @param  addr: Register address.
+ * @retval Register value.
+ */
+static uint16_t Modbus_Input(const Sampler_Snapshot* snap, uint16_t addr)
+{
+    uint32_t v;
+    uint16_t word;
+
+    if (addr < MODBUS_IR_COUNTS) return snap->moisture[addr - MODBUS_IR_MOISTURE];
+    if (addr < MODBUS_IR_SEQ) return snap->value[addr - MODBUS_IR_COUNTS];
+    if (addr == MODBUS_IR_CAL_ID) return Moisture_GetCalibrationId();
+
+    if (addr < MODBUS_IR_TICK) {
+        v = snap->seq;
+        word = addr - MODBUS_IR_SEQ;
+    }
+    else if (addr < MODBUS_IR_CAL_ID) {
+        v = snap->tick;
+        word = addr - MODBUS_IR_TICK;
+    }
+    else {
+#if METRICS_ENABLE
+        v = metrics_counter[(addr - MODBUS_IR_COUNTERS) / 2];
+#else
+        v = 0;
+#endif
+        word = (addr - MODBUS_IR_COUNTERS) & 1;
+    }
+    return (word == 0) ? (uint16_t) (v >> 16) : (uint16_t) v;
+}
+
+/**
+ * @brief  Lays the calibration of a channel out as holding registers.
+ * @param  ch: Channel.
+ * @param  regs: Output, MODBUS_HR_CAL_REGS registers.
+ * @retval None
+ */
+static void Modbus_Calibration(uint8_t ch, uint16_t* regs)
+{
+    Moisture_Point points[MOISTURE_CAL_POINTS_MAX];
+    uint8_t n = Moisture_GetCalibration(ch, points);
+    uint8_t i;
+
+    memset(regs, 0, MODBUS_HR_CAL_REGS * sizeof(*regs));
+    regs[0] = n;
+    for (i = 0; i < n; i++) {
+        regs[1 + 2 * i] = points[i].counts;
+        regs[2 + 2 * i] = points[i].moisture;
+    }
+}
+
+/**
+ * @brief  Answers a read of input or holding registers.
+ * @param  fc: Function code.
+ * @param  pdu: Request PDU after the function code.
+ * @param  len: Length of the request PDU after the function code.
+ * @param  snap: Snapshot the readings come from.
+ * @param  out: Reply PDU after the function code.
+ * @retval Length of the reply after the function code, or the negated
+ *         exception code.
+ */
+static int16_t Modbus_Read(uint8_t fc, const uint8_t* pdu, uint16_t len, const Sampler_Snapshot* snap, uint8_t* out)
+{
+    uint16_t regs[MODBUS_HR_CAL_REGS];
+    uint16_t addr;
+    uint16_t count;
+    uint16_t num = (fc == MODBUS_FC_READ_INPUT) ? MODBUS_IR_NUM : MODBUS_HR_NUM;
+    uint16_t i;
+    int16_t ch = -1;
+
+    if (len != 4) return -MODBUS_EX_ILLEGAL_VALUE;
+    addr = MODBUS_U16(pdu);
+    count = MODBUS_U16(pdu + 2);
+    if (count == 0 || count > MODBUS_READ_MAX) return -MODBUS_EX_ILLEGAL_VALUE;
+    if ((uint32_t) addr + count > num) return -MODBUS_EX_ILLEGAL_ADDRESS;
+
+    out[0] = (uint8_t) (2 * count);
+    for (i = 0; i < count; i++, addr++) {
+        if (fc == MODBUS_FC_READ_INPUT) {
+            Modbus_Put16(out + 1 + 2 * i, Modbus_Input(snap, addr));
+            continue;
+        }
+        if (addr / MODBUS_HR_CAL_REGS != ch) {
+            ch = addr / MODBUS_HR_CAL_REGS;
+            Modbus_Calibration((uint8_t) ch, regs);
+        }
+        Modbus_Put16(out + 1 + 2 * i, regs[addr % MODBUS_HR_CAL_REGS]);
+    }
+    return (int16_t) (1 + 2 * count);
+}
+
+/**
+ * @brief  Writes holding registers, replacing the calibration of a channel.
+ * @note   The new curve is also queued for the flash store.
+ * @param  addr: First register.
+ * @param  count: Number of registers.
+ * @param  values: Values, big-endian.
+ * @retval 0 on success, or the negated exception code.
+ */
+static int16_t Modbus_Write(uint16_t addr, uint16_t count, const uint8_t* values)
+{
+    Moisture_Point points[MOISTURE_CAL_POINTS_MAX];
+    uint16_t regs[MODBUS_HR_CAL_REGS];
+    uint8_t ch = (uint8_t) (addr / MODBUS_HR_CAL_REGS);
+    uint16_t first = addr % MODBUS_HR_CAL_REGS;
+    uint16_t i;
+
+    if ((uint32_t) addr + count > MODBUS_HR_NUM || first + count > MODBUS_HR_CAL_REGS) return -MODBUS_EX_ILLEGAL_ADDRESS;
+
+    Modbus_Calibration(ch, regs);
+    for (i = 0; i < count; i++) {
+        regs[first + i] = MODBUS_U16(values + 2 * i);
+    }
+
+    if (regs[0] > MOISTURE_CAL_POINTS_MAX) return -MODBUS_EX_ILLEGAL_VALUE;
+    for (i = 0; i < regs[0]; i++) {
+        points[i].counts = regs[1 + 2 * i];
+        points[i].moisture = regs[2 + 2 * i];
+    }
+    if (Moisture_SetCalibration(ch, points, (uint8_t) regs[0]) < 0) return -MODBUS_EX_ILLEGAL_VALUE;
+
+    LOG_INFO("Calibration of channel %u set over Modbus", ch);
+    Store_Write(STORE_REC_CALIBRATION, ch, points, (uint8_t) (regs[0] * sizeof(Moisture_Point)));
+    return 0;
+}
+
+/**
+ * @brief  Answers one request PDU.
+ * @param  pdu: Request PDU.
+ * @param  len: Length of the request PDU, at least 1.
+ * @param  snap: Snapshot the readings come from.
+ * @param  out: Reply PDU, room for the longest.
+ * @retval Length of the reply PDU.
+ */
+static uint16_t Modbus_Handle(const uint8_t* pdu, uint16_t len, const Sampler_Snapshot* snap, uint8_t* out)
+{
+    uint8_t fc = pdu[0];
+    uint16_t count;
+    int16_t ret;
+
+    switch (fc)
+    {
+        case MODBUS_FC_READ_HOLDING:
+        case MODBUS_FC_READ_INPUT:
+            ret = Modbus_Read(fc, pdu + 1, len - 1, snap, out + 1);
+            break;
+        case MODBUS_FC_WRITE_SINGLE:
+            ret = (len == 5) ? Modbus_Write(MODBUS_U16(pdu + 1), 1, pdu + 3) : -MODBUS_EX_ILLEGAL_VALUE;
+            if (ret == 0) {
+                memcpy(out + 1, pdu + 1, 4);
+                ret = 4;
+            }
+            break;
+        case MODBUS_FC_WRITE_MULTIPLE:
+            count = (len >= 6) ? MODBUS_U16(pdu + 3) : 0;
+            if (count == 0 || count > MODBUS_WRITE_MAX || pdu[5] != 2 * count || len != 6 + 2 * count) {
+                ret = -MODBUS_EX_ILLEGAL_VALUE;
+            }
+            else {
+                ret = Modbus_Write(MODBUS_U16(pdu + 1), count, pdu + 6);
+            }
+            if (ret == 0) {
+                memcpy(out + 1, pdu + 1, 4);
+                ret = 4;
+            }
+            break;
+        default:
+            ret = -MODBUS_EX_ILLEGAL_FUNCTION;
+            break;
+    }
+
+    if (ret < 0) {
+        METRICS_ADD(METRICS_MODBUS_EXCEPTIONS, 1);
+        out[0] = (uint8_t) (fc | 0x80);
+        out[1] = (uint8_t) -ret;
+        return 2;
+    }
+    out[0] = fc;
+    return (uint16_t) (1 + ret);
+}
+
+/**
+ * @brief  Answers every whole request frame in the RX buffer that the TX
+ *         buffer has room for.
+ * @param  None
+ * @retval 0 on success, -1 if a frame is malformed.
+ */
+static int8_t Modbus_Process(void)
+{
+    Sampler_Snapshot snap;
+    uint8_t* req = modbus_rx;
+    uint8_t* rsp;
+    uint16_t left = modbus_rx_len;
+    uint16_t len;
+    uint16_t pdu_len;
+    uint8_t read = 0;
+    METRICS_TIMER(t);
+
+    while (left >= MODBUS_MBAP_SIZE && modbus_tx_len + MODBUS_ADU_MAX <= MODBUS_TX_BUF_SIZE) {
+        len = MODBUS_U16(req + 4);
+        if (MODBUS_U16(req + 2) != 0 || len < 2 || len > MODBUS_ADU_MAX - 6) return -1;
+        if (left < 6 + len) break;
+
+        METRICS_START(t);
+        if (!read) {
+            Sampler_Read(&snap);
+            read = 1;
+        }
+
+        rsp = modbus_tx + modbus_tx_len;
+        memcpy(rsp, req, 4);
+        rsp[6] = req[6];
+        pdu_len = Modbus_Handle(req + MODBUS_MBAP_SIZE, len - 1, &snap, rsp + MODBUS_MBAP_SIZE);
+        Modbus_Put16(rsp + 4, (uint16_t) (pdu_len + 1));
+        modbus_tx_len += MODBUS_MBAP_SIZE + pdu_len;
+        METRICS_STOP(METRICS_PHASE_MODBUS, t);
+        METRICS_ADD(METRICS_MODBUS_REQUESTS, 1);
+
+        req += 6 + len;
+        left -= 6 + len;
+    }
+
+    if (left < modbus_rx_len) {
+        memmove(modbus_rx, req, left);
+        modbus_rx_len = left;
+        modbus_last_active = Tick_GetMs();
+    }
+    return 0;
+}
+
+/**
+ * @brief  Sends as much of the queued replies as the socket takes.
+ * @param  None
+ * @retval 0 on success, a negative socket error otherwise.
+ */
+static int32_t Modbus_Flush(void)
+{
+    uint16_t room;
+    int32_t ret;
+
+    while (modbus_tx_len > 0 && (room = getSn_TX_FSR(MODBUS_SOCK)) > 0) {
+        ret = send(MODBUS_SOCK, modbus_tx, (modbus_tx_len < room) ? modbus_tx_len : room);
+        if (ret < 0) {
+            METRICS_ADD(METRICS_SEND_ERRORS, 1);
+            close(MODBUS_SOCK);
+            modbus_tx_len = 0;
+            return ret;
+        }
+        if (ret == SOCK_BUSY) break;
+
+        METRICS_ADD(METRICS_BYTES_OUT, ret);
+        modbus_tx_len -= (uint16_t) ret;
+        memmove(modbus_tx, modbus_tx + ret, modbus_tx_len);
+    }
+    return 0;
+}
+
+/**
+ * @brief  Serves the connection: takes in requests and answers them.
+ * @param  None
+ * @retval 0 on success, a negative socket error otherwise.
+ */
+static int32_t Modbus_Serve(void)
+{
+    uint16_t size;
+    int32_t ret;
+
+    if ((ret = Modbus_Flush()) < 0) return ret;
+
+    size = getSn_RX_RSR(MODBUS_SOCK);
+    if (size > MODBUS_RX_BUF_SIZE - modbus_rx_len) size = MODBUS_RX_BUF_SIZE - modbus_rx_len;
+    if (size > 0) {
+        if ((ret = recv(MODBUS_SOCK, modbus_rx + modbus_rx_len, size)) < 0) return ret;
+        if (ret > 0) {
+            METRICS_ADD(METRICS_BYTES_IN, ret);
+            modbus_rx_len += (uint16_t) ret;
+        }
+    }
+
+    if (Modbus_Process() < 0) {
+        LOG_WARN("%d:Modbus frame error", MODBUS_SOCK);
+        modbus_rx_len = 0;
+        disconnect(MODBUS_SOCK);
+        return 0;
+    }
+
+    return Modbus_Flush();
+}
+
+/**
+ * @brief  Tells whether a whole request frame is buffered and can be
+ *         answered.
+ * @note   A frame still arriving is announced by the socket interrupt
+ *         when the rest of it comes in.
+ * @param  None
+ * @retval 1 if Modbus_Process() has a request to answer, 0 otherwise.
+ */
+static uint8_t Modbus_Pending(void)
+{
+    return modbus_rx_len >= MODBUS_MBAP_SIZE && modbus_rx_len >= 6 + MODBUS_U16(modbus_rx + 4)
+            && modbus_tx_len + MODBUS_ADU_MAX <= MODBUS_TX_BUF_SIZE;
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Clears the connection state.
+ * @param  None
+ * @retval None
+ */
+void Modbus_Init(void)
+{
+    modbus_rx_len = 0;
+    modbus_tx_len = 0;
+}
+
+/**
+ * @brief  Runs the Modbus/TCP server socket.
+ * @note   Called from the main loop on events of MODBUS_SOCK and on every
+ *         sample, which paces the idle timeout and replies waiting for TX
+ *         memory that no SENDOK interrupt will announce. Data left in the
+ *         socket, or a whole request left in the RX buffer, posts the
+ *         socket event again; a partial frame waits for its interrupt.
+ * @param  None
+ * @retval None
+ */
+void Modbus_Run(void)
+{
+    uint8_t sr = getSn_SR(MODBUS_SOCK);
+    uint8_t ip[4];
+
+    switch (sr)
+    {
+        case SOCK_ESTABLISHED:
+
+            if (getSn_IR(MODBUS_SOCK) & Sn_IR_CON) {
+                getSn_DIPR(MODBUS_SOCK, ip);
+                LOG_INFO("%d:Modbus connected - %d.%d.%d.%d : %d", MODBUS_SOCK, ip[0], ip[1], ip[2], ip[3], getSn_DPORT(MODBUS_SOCK));
+                modbus_rx_len = 0;
+                modbus_tx_len = 0;
+                modbus_last_active = Tick_GetMs();
+                METRICS_ADD(METRICS_CONNECTIONS, 1);
+                setSn_IR(MODBUS_SOCK, Sn_IR_CON);
+            }
+
+            if (Modbus_Serve() < 0) break;
+
+            if (modbus_tx_len == 0 && TICK_REACHED(Tick_GetMs(), modbus_last_active + MODBUS_IDLE_TIMEOUT_MS)) {
+                LOG_INFO("%d:Modbus idle timeout", MODBUS_SOCK);
+                disconnect(MODBUS_SOCK);
+            }
+            break;
+        case SOCK_CLOSE_WAIT:
+
+            METRICS_ADD(METRICS_CLOSE_WAIT, 1);
+            disconnect(MODBUS_SOCK);
+            break;
+        case SOCK_INIT:
+
+            LOG_INFO("%d:Listen, Modbus/TCP, port [%d]", MODBUS_SOCK, MODBUS_PORT);
+            listen(MODBUS_SOCK);
+            break;
+        case SOCK_CLOSED:
+
+            modbus_rx_len = 0;
+            modbus_tx_len = 0;
+            socket(MODBUS_SOCK, Sn_MR_TCP, MODBUS_PORT, SF_IO_NONBLOCK);
+            break;
+        default:
+            break;
+    }
+
+    sr = getSn_SR(MODBUS_SOCK);
+    if (modbus_tx_len > 0 && sr == SOCK_ESTABLISHED) {
+        /* SENDOK still set means no SEND is in progress */
+        if (getSn_IR(MODBUS_SOCK) & Sn_IR_SENDOK) setSn_IMR(MODBUS_SOCK, (uint8_t) (getSn_IMR(MODBUS_SOCK) & ~Sn_IR_SENDOK));
+        else setSn_IMR(MODBUS_SOCK, (uint8_t) (getSn_IMR(MODBUS_SOCK) | Sn_IR_SENDOK));
+        return;
+    }
+
+    setSn_IMR(MODBUS_SOCK, (uint8_t) (getSn_IMR(MODBUS_SOCK) & ~Sn_IR_SENDOK));
+    if (sr == SOCK_CLOSED || sr == SOCK_INIT || sr == SOCK_CLOSE_WAIT
+            || (sr == SOCK_ESTABLISHED && ((getSn_RX_RSR(MODBUS_SOCK) > 0 && modbus_rx_len < MODBUS_RX_BUF_SIZE) || Modbus_Pending()))) {
+        Event_Post(EVENT_SOCKET(MODBUS_SOCK));
+    }
+}
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
@@ -0,0 +1,77 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/modbus.h
+ * @author  WIZnet
+ * @brief   Header for modbus.c module
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MODBUS_H
+#define __MODBUS_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "adc_sampler.h"
+#include "moisture.h"
+#include "metrics.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Hardware socket and port of the Modbus/TCP server */
+#ifndef MODBUS_SOCK
+#define MODBUS_SOCK 5
+#endif
+#ifndef MODBUS_PORT
+#define MODBUS_PORT 502
+#endif
+
+/* A connection without a request for this long is closed */
+#ifndef MODBUS_IDLE_TIMEOUT_MS
+#define MODBUS_IDLE_TIMEOUT_MS 60000
+#endif
+
+/* Request and reply buffers; the RX buffer bounds the requests taken in
+ * one pass, the TX buffer the replies sent with one SEND */
+#ifndef MODBUS_RX_BUF_SIZE
+#define MODBUS_RX_BUF_SIZE 512
+#endif
+#ifndef MODBUS_TX_BUF_SIZE
+#define MODBUS_TX_BUF_SIZE 512
+#endif
+
+/* Function codes */
+#define MODBUS_FC_READ_HOLDING      0x03
+#define MODBUS_FC_READ_INPUT        0x04
+#define MODBUS_FC_WRITE_SINGLE      0x06
+#define MODBUS_FC_WRITE_MULTIPLE    0x10
+
+/* Exception codes */
+#define MODBUS_EX_ILLEGAL_FUNCTION  0x01
+#define MODBUS_EX_ILLEGAL_ADDRESS   0x02
+#define MODBUS_EX_ILLEGAL_VALUE     0x03
+
+/* Input registers, read-only, from the latest snapshot. 32-bit values
+ * take two registers, high word first. */
+#define MODBUS_IR_MOISTURE  0                               /* Per channel, 0.1 % */
+#define MODBUS_IR_COUNTS    (MODBUS_IR_MOISTURE + SAMPLER_CH_NUM)   /* Filtered ADC counts per channel */
+#define MODBUS_IR_SEQ       (MODBUS_IR_COUNTS + SAMPLER_CH_NUM)     /* Scan sequence number, 32-bit */
+#define MODBUS_IR_TICK      (MODBUS_IR_SEQ + 2)             /* Millisecond tick of the scan, 32-bit */
+#define MODBUS_IR_CAL_ID    (MODBUS_IR_TICK + 2)            /* Calibration id */
+#define MODBUS_IR_COUNTERS  (MODBUS_IR_CAL_ID + 1)          /* METRICS_* counters, 32-bit each; 0 without METRICS_ENABLE */
+#define MODBUS_IR_NUM       (MODBUS_IR_COUNTERS + 2 * METRICS_COUNTER_NUM)
+
+/* Holding registers, the calibration of each channel in a block of its
+ * own: the number of points, then counts and moisture of every point.
+ * Unused points read 0. A write replaces the whole curve and must leave
+ * it valid; it cannot span channels. */
+#define MODBUS_HR_CAL_REGS  (1 + 2 * MOISTURE_CAL_POINTS_MAX)
+#define MODBUS_HR_CAL(ch)   ((ch) * MODBUS_HR_CAL_REGS)
+#define MODBUS_HR_NUM       (SAMPLER_CH_NUM * MODBUS_HR_CAL_REGS)
+
+/* Exported functions ------------------------------------------------------- */
+void Modbus_Init(void);
+void Modbus_Run(void);
+
+#endif /* __MODBUS_H */
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
@@ -0,0 +1,289 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/moisture.c
+ * @author  WIZnet
+ * @brief   Fixed-point filtering and calibration of the probe readings
+ ******************************************************************************
+ * @attention
+ *
+ * Every scan passes each channel through three integer stages:
+ *
+ *   1. Median of the last MOISTURE_MEDIAN_N readings, which removes single
+ *      spikes without moving the edges of real steps.
+ *   2. Exponential moving average, kept with MOISTURE_EMA_FRAC fraction
+ *      bits so small steps are not lost to truncation.
+ *   3. Calibration: counts are turned into moisture in tenths of a percent
+ *      through a table of MOISTURE_LUT_LEN entries, one every
+ *      2^MOISTURE_LUT_SHIFT counts, interpolated between its two nearest
+ *      entries.
+ *
+ * The table is computed from the calibration points when they are set, so a
+ * reading costs the same few compares, shifts and one multiply whatever the
+ * number of points, and nothing needs floating point. Between calibration
+ * points that do not fall on a table entry the curve is off by at most the
+ * rounding of one interpolation step.
+ *
+ * Moisture_Process() runs in the sampler interrupt; the calibration is set
+ * from the main loop, which builds the new table on its stack and copies it
+ * in with interrupts held off.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "main.h"
+#include "moisture.h"
+
+/* Private define ------------------------------------------------------------*/
+#if (MOISTURE_MEDIAN_N & 1) == 0 || MOISTURE_MEDIAN_N > 9
+#error "MOISTURE_MEDIAN_N must be odd and at most 9"
+#endif
+
+#define MOISTURE_EMA_FRAC   4
+#define MOISTURE_LUT_SHIFT  6
+#define MOISTURE_LUT_LEN    ((4096 >> MOISTURE_LUT_SHIFT) + 1)
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+    uint16_t window[MOISTURE_MEDIAN_N]; /* Last readings, oldest overwritten */
+    uint8_t next;
+    uint8_t primed;                     /* Window and EMA hold readings */
+    int32_t ema;                        /* Counts << MOISTURE_EMA_FRAC */
+} Moisture_Filter;
+
+/* Private variables ---------------------------------------------------------*/
+static Moisture_Filter moisture_filter[SAMPLER_CH_NUM];
+static uint16_t moisture_lut[SAMPLER_CH_NUM][MOISTURE_LUT_LEN];
+
+static Moisture_Point moisture_cal[SAMPLER_CH_NUM][MOISTURE_CAL_POINTS_MAX];
+static uint8_t moisture_cal_len[SAMPLER_CH_NUM];
+static uint16_t moisture_cal_id;
+
+/* Fails to compile if MOISTURE_RAM_SIZE no longer covers the state above */
+typedef char moisture_ram_check[(sizeof(moisture_filter) + sizeof(moisture_lut) + sizeof(moisture_cal)
+        + sizeof(moisture_cal_len) + sizeof(moisture_cal_id) <= MOISTURE_RAM_SIZE) ? 1 : -1];
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Returns the median of a channel's window.
+ * @param  f: Filter of the channel.
+ * @retval Median reading.
+ */
+static uint16_t Moisture_Median(const Moisture_Filter* f)
+{
+    uint16_t v[MOISTURE_MEDIAN_N];
+    uint16_t x;
+    uint8_t i;
+    uint8_t j;
+
+    /* Insertion sort of a handful of values */
+    for (i = 0; i < MOISTURE_MEDIAN_N; i++) {
+        x = f->window[i];
+        for (j = i; j > 0 && v[j - 1] > x; j--) {
+            v[j] = v[j - 1];
+        }
+        v[j] = x;
+    }
+    return v[MOISTURE_MEDIAN_N / 2];
+}
+
+/**
+ * @brief  Evaluates a calibration curve.
+ * @note   Piecewise linear through the points, flat beyond the first and
+ *         the last one.
+ * @param  points: Calibration points in increasing count order.
+ * @param  n: Number of points, at least 2.
+ * @param  counts: ADC counts.
+ * @retval Moisture in tenths of a percent.
+ */
+static uint16_t Moisture_Curve(const Moisture_Point* points, uint8_t n, int32_t counts)
+{
+    const Moisture_Point* a;
+    const Moisture_Point* b;
+    int32_t dx;
+    int32_t dy;
+    uint8_t i;
+
+    if (counts <= points[0].counts) return points[0].moisture;
+    if (counts >= points[n - 1].counts) return points[n - 1].moisture;
+
+    for (i = 1; counts > points[i].counts; i++)
+        ;
+    a = &points[i - 1];
+    b = &points[i];
+    dx = (int32_t) b->counts - a->counts;
+    dy = (int32_t) b->moisture - a->moisture;
+
+    /* Rounded to the nearest tenth either way */
+    return (uint16_t) (a->moisture + (dy * (counts - a->counts) + (dy < 0 ? -dx : dx) / 2) / dx);
+}
+
+/**
+ * @brief  Hashes the calibration points of every channel.
+ * @param  None
+ * @retval 16-bit FNV-1a hash, folded.
+ */
+static uint16_t Moisture_HashCalibration(void)
+{
+    uint32_t h = 2166136261UL;
+    const uint8_t* p;
+    uint16_t len;
+    uint8_t ch;
+
+    for (ch = 0; ch < SAMPLER_CH_NUM; ch++) {
+        p = (const uint8_t*) moisture_cal[ch];
+        for (len = moisture_cal_len[ch] * sizeof(Moisture_Point); len > 0; len--) {
+            h = (h ^ *p++) * 16777619UL;
+        }
+        h = (h ^ moisture_cal_len[ch]) * 16777619UL;
+    }
+    return (uint16_t) (h ^ (h >> 16));
+}
+
+/**
+ * @brief  Initializes the filters and sets the default calibration.
+ * @param  None
+ * @retval None
+ */
+void Moisture_Init(void)
+{
+    uint8_t ch;
+
+    memset(moisture_filter, 0, sizeof(moisture_filter));
+    for (ch = 0; ch < SAMPLER_CH_NUM; ch++) {
+        Moisture_SetDryWet(ch, MOISTURE_DRY_COUNTS, MOISTURE_WET_COUNTS);
+    }
+}
+
+/**
+ * @brief  Filters one scan and converts it to moisture.
+ * @note   Runs in DUALTIMER0 interrupt context, on every scan.
+ * @param  raw: Averaged ADC counts of every channel.
+ * @param  value: Receives the filtered counts of every channel.
+ * @param  moisture: Receives the moisture of every channel, 0.1 %.
+ * @retval None
+ */
+void Moisture_Process(const uint16_t* raw, uint16_t* value, uint16_t* moisture)
+{
+    Moisture_Filter* f;
+    const uint16_t* lut;
+    uint32_t counts;
+    uint32_t frac;
+    uint8_t ch;
+    uint8_t i;
+
+    for (ch = 0; ch < SAMPLER_CH_NUM; ch++) {
+        f = &moisture_filter[ch];
+
+        if (!f->primed) {
+            for (i = 0; i < MOISTURE_MEDIAN_N; i++) {
+                f->window[i] = raw[ch];
+            }
+            f->ema = (int32_t) raw[ch] << MOISTURE_EMA_FRAC;
+            f->primed = 1;
+        }
+
+        f->window[f->next] = raw[ch];
+        if (++f->next == MOISTURE_MEDIAN_N) f->next = 0;
+
+        f->ema += (((int32_t) Moisture_Median(f) << MOISTURE_EMA_FRAC) - f->ema) >> MOISTURE_EMA_SHIFT;
+        counts = (uint32_t) (f->ema + (1 << (MOISTURE_EMA_FRAC - 1))) >> MOISTURE_EMA_FRAC;
+        if (counts > 4095) counts = 4095;
+        value[ch] = (uint16_t) counts;
+
+        lut = &moisture_lut[ch][counts >> MOISTURE_LUT_SHIFT];
+        frac = counts & ((1 << MOISTURE_LUT_SHIFT) - 1);
+        moisture[ch] = (uint16_t) (((lut[0] << MOISTURE_LUT_SHIFT) + ((int32_t) lut[1] - lut[0]) * (int32_t) frac
+                + (1 << (MOISTURE_LUT_SHIFT - 1))) >> MOISTURE_LUT_SHIFT);
+    }
+}
+
+/**
+ * @brief  Sets the calibration curve of a channel.
+ * @param  ch: Channel, below SAMPLER_CH_NUM.
+ * @param  points: 2 to MOISTURE_CAL_POINTS_MAX points in strictly
+ *         increasing count order, moisture up to MOISTURE_FULL.
+ * @param  n: Number of points.
+ * @retval 0 on success, -1 if the channel or the points are invalid.
+ */
+int8_t Moisture_SetCalibration(uint8_t ch, const Moisture_Point* points, uint8_t n)
+{
+    uint16_t lut[MOISTURE_LUT_LEN];
+    uint8_t i;
+
+    if (ch >= SAMPLER_CH_NUM || n < 2 || n > MOISTURE_CAL_POINTS_MAX) return -1;
+    for (i = 0; i < n; i++) {
+        if (points[i].counts > 4095 || points[i].moisture > MOISTURE_FULL) return -1;
+        if (i > 0 && points[i].counts <= points[i - 1].counts) return -1;
+    }
+
+    for (i = 0; i < MOISTURE_LUT_LEN; i++) {
+        lut[i] = Moisture_Curve(points, n, (int32_t) i << MOISTURE_LUT_SHIFT);
+    }
+
+    __disable_irq();
+    memcpy(moisture_lut[ch], lut, sizeof(lut));
+    __enable_irq();
+
+    memcpy(moisture_cal[ch], points, n * sizeof(*points));
+    moisture_cal_len[ch] = n;
+    moisture_cal_id = Moisture_HashCalibration();
+    return 0;
+}
+
+/**
+ * @brief  Sets a two-point calibration of a channel.
+ * @param  ch: Channel, below SAMPLER_CH_NUM.
+ * @param  dry: Counts of the probe in dry soil or air, 0 %.
+ * @param  wet: Counts of the probe in saturated soil or water, 100 %.
+ * @retval 0 on success, -1 if the channel or the counts are invalid.
+ */
+int8_t Moisture_SetDryWet(uint8_t ch, uint16_t dry, uint16_t wet)
+{
+    Moisture_Point points[2];
+
+    if (dry < wet) {
+        points[0].counts = dry;
+        points[0].moisture = 0;
+        points[1].counts = wet;
+        points[1].moisture = MOISTURE_FULL;
+    }
+    else {
+        points[0].counts = wet;
+        points[0].moisture = MOISTURE_FULL;
+        points[1].counts = dry;
+        points[1].moisture = 0;
+    }
+    return Moisture_SetCalibration(ch, points, 2);
+}
+
+/**
+ * @brief  Returns the calibration points of a channel.
+ * @param  ch: Channel, below SAMPLER_CH_NUM.
+ * @param  points: Receives up to MOISTURE_CAL_POINTS_MAX points.
+ * @retval Number of points.
+ */
+uint8_t Moisture_GetCalibration(uint8_t ch, Moisture_Point* points)
+{
+    if (ch >= SAMPLER_CH_NUM) return 0;
+
+    memcpy(points, moisture_cal[ch], moisture_cal_len[ch] * sizeof(*points));
+    return moisture_cal_len[ch];
+}
+
+/**
+ * @brief  Returns an identifier of the calibration of every channel.
+ * @note   A hash of the calibration points: it changes when they do and is
+ *         the same after a reset with the same calibration.
+ * @param  None
+ * @retval Calibration identifier.
+ */
+uint16_t Moisture_GetCalibrationId(void)
+{
+    return moisture_cal_id;
+}
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
@@ -0,0 +1,65 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/moisture.h
+ * @author  WIZnet
+ * @brief   Header for moisture.c module
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MOISTURE_H
+#define __MOISTURE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "adc_sampler.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Readings the spike filter takes the median of; odd, at most 9 */
+#ifndef MOISTURE_MEDIAN_N
+#define MOISTURE_MEDIAN_N 5
+#endif
+
+/* EMA weight of a new reading is 1 / 2^MOISTURE_EMA_SHIFT; 0 turns the
+ * smoothing off */
+#ifndef MOISTURE_EMA_SHIFT
+#define MOISTURE_EMA_SHIFT 2
+#endif
+
+/* Default two-point calibration: counts of a probe in dry air and in
+ * water. Capacitive probes read lower the wetter the soil. */
+#ifndef MOISTURE_DRY_COUNTS
+#define MOISTURE_DRY_COUNTS 3100
+#endif
+#ifndef MOISTURE_WET_COUNTS
+#define MOISTURE_WET_COUNTS 1500
+#endif
+
+/* Most calibration points per channel */
+#define MOISTURE_CAL_POINTS_MAX 8
+
+/* SRAM of the filters, the 65-entry lookup tables and the calibrations of
+ * every channel */
+#define MOISTURE_RAM_SIZE (SAMPLER_CH_NUM * (2 * MOISTURE_MEDIAN_N + 8 + 2 * 65 + 4 * MOISTURE_CAL_POINTS_MAX + 1) + 4)
+
+/* Full scale of a moisture value: 100.0 % in tenths */
+#define MOISTURE_FULL 1000
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+    uint16_t counts;                    /* ADC counts */
+    uint16_t moisture;                  /* Moisture at these counts, 0.1 % */
+} Moisture_Point;
+
+/* Exported functions ------------------------------------------------------- */
+void Moisture_Init(void);
+void Moisture_Process(const uint16_t* raw, uint16_t* value, uint16_t* moisture);
+int8_t Moisture_SetCalibration(uint8_t ch, const Moisture_Point* points, uint8_t n);
+int8_t Moisture_SetDryWet(uint8_t ch, uint16_t dry, uint16_t wet);
+uint8_t Moisture_GetCalibration(uint8_t ch, Moisture_Point* points);
+uint16_t Moisture_GetCalibrationId(void);
+
+#endif /* __MOISTURE_H */
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
@@ -0,0 +1,198 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/telemetry.c
+ * @author  WIZnet
+ * @brief   Batched UDP push of the sampled readings to a collector
+ ******************************************************************************
+ * @attention
+ *
+ * Every new snapshot is appended to the current batch as one text line;
+ * a batch goes out as a single datagram on TELEMETRY_SOCK:
+ *
+ *   SM1 <mac> <datagram seq> <sample count>
+ *   <sample seq> <tick ms> <ch0> <ch1> <ch2> <ch3>
+ *   ...
+ *
+ * The datagram sequence number grows by one per batch, including batches
+ * that could not be sent, so the collector can count lost datagrams; gaps
+ * in the sample sequence numbers show scans that were not pushed.
+ *
+ * The socket is opened in non-blocking mode: while the previous datagram is
+ * still being sent the batch is kept and sending is retried on the next
+ * pass of the main loop.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "wizchip_conf.h"
+#include "socket.h"
+#include "telemetry.h"
+#include "adc_sampler.h"
+#include "web_server.h"
+#include "arena.h"
+#include "tick.h"
+
+/* Private define ------------------------------------------------------------*/
+/* Space kept in front of the sample lines for the datagram header */
+#define TELEMETRY_HDR_MAX 40
+
+/* Longest sample line */
+#define TELEMETRY_LINE_MAX (11 + 11 + 6 * SAMPLER_CH_NUM + 1)
+
+#if TELEMETRY_BUF_SIZE < (TELEMETRY_HDR_MAX + TELEMETRY_LINE_MAX)
+#error "TELEMETRY_BUF_SIZE too small for one sample"
+#endif
+
+#if (TELEMETRY_SOCK >= HTTP_SOCK_START) && (TELEMETRY_SOCK < HTTP_SOCK_START + HTTP_SOCK_COUNT)
+#error "TELEMETRY_SOCK is part of the HTTP socket pool"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t telemetry_ip[4] = TELEMETRY_DEST_IP;
+static uint16_t telemetry_port = TELEMETRY_DEST_PORT;
+static uint16_t telemetry_batch = TELEMETRY_BATCH;
+static uint32_t telemetry_interval = TELEMETRY_INTERVAL_MS;
+
+static uint8_t* const telemetry_buf = arena.telemetry;   /* TELEMETRY_BUF_SIZE bytes */
+static uint16_t telemetry_len;          /* Bytes of sample lines */
+static uint16_t telemetry_count;        /* Samples in the batch */
+static uint32_t telemetry_first;        /* Tick of the oldest sample */
+static uint32_t telemetry_seq;          /* Next datagram sequence number */
+static uint32_t telemetry_sample_seq;   /* Last snapshot batched */
+static uint32_t telemetry_dropped;      /* Samples lost */
+static uint8_t telemetry_mac[6];
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Appends the latest snapshot to the batch.
+ * @param  None
+ * @retval None
+ */
+static void Telemetry_Append(void)
+{
+    Sampler_Snapshot snap;
+    char* p;
+    uint8_t ch;
+    int n;
+
+    Sampler_Read(&snap);
+    telemetry_sample_seq = snap.seq;
+
+    if (TELEMETRY_HDR_MAX + telemetry_len + TELEMETRY_LINE_MAX > TELEMETRY_BUF_SIZE) {
+        /* Previous batches still waiting to go out */
+        telemetry_dropped++;
+        return;
+    }
+
+    if (telemetry_count == 0) telemetry_first = snap.tick;
+
+    p = (char*) telemetry_buf + TELEMETRY_HDR_MAX + telemetry_len;
+    n = sprintf(p, "%lu %lu", (unsigned long) snap.seq, (unsigned long) snap.tick);
+    for (ch = 0; ch < SAMPLER_CH_NUM; ch++) {
+        n += sprintf(p + n, " %u", snap.value[ch]);
+    }
+    p[n++] = '\n';
+
+    telemetry_len += (uint16_t) n;
+    telemetry_count++;
+}
+
+/**
+ * @brief  Sends the batch as one datagram.
+ * @param  None
+ * @retval None
+ */
+static void Telemetry_Flush(void)
+{
+    char hdr[TELEMETRY_HDR_MAX];
+    uint8_t* p;
+    int32_t ret;
+    int n;
+
+    n = snprintf(hdr, sizeof(hdr), "SM1 %02X%02X%02X%02X%02X%02X %lu %u\n",
+            telemetry_mac[0], telemetry_mac[1], telemetry_mac[2], telemetry_mac[3], telemetry_mac[4], telemetry_mac[5],
+            (unsigned long) telemetry_seq, telemetry_count);
+
+    /* The header goes right in front of the lines */
+    p = telemetry_buf + TELEMETRY_HDR_MAX - n;
+    memcpy(p, hdr, n);
+
+    ret = sendto(TELEMETRY_SOCK, p, (uint16_t) (n + telemetry_len), telemetry_ip, telemetry_port);
+    if (ret == SOCK_BUSY) return;
+
+    if (ret < 0) {
+        /* Give the batch up and reopen the socket on the next pass */
+        telemetry_dropped += telemetry_count;
+        close(TELEMETRY_SOCK);
+    }
+
+    telemetry_seq++;
+    telemetry_len = 0;
+    telemetry_count = 0;
+}
+
+/**
+ * @brief  Sets the collector and the batching of the push.
+ * @param  ip: Collector IP address.
+ * @param  port: Collector UDP port, 0 to stop pushing.
+ * @param  batch: Samples per datagram at most.
+ * @param  interval_ms: Age of the oldest sample at which a batch is sent
+ *         even if it is not full.
+ * @retval None
+ */
+void Telemetry_Config(const uint8_t* ip, uint16_t port, uint16_t batch, uint32_t interval_ms)
+{
+    memcpy(telemetry_ip, ip, 4);
+    telemetry_port = port;
+    telemetry_batch = batch ? batch : 1;
+    telemetry_interval = interval_ms;
+
+    if (port == 0 && getSn_SR(TELEMETRY_SOCK) == SOCK_UDP) close(TELEMETRY_SOCK);
+    telemetry_len = 0;
+    telemetry_count = 0;
+}
+
+/**
+ * @brief  Batches new samples and pushes full or aged batches.
+ * @note   Called from the main loop; never waits for the network.
+ * @param  None
+ * @retval None
+ */
+void Telemetry_Run(void)
+{
+    wiz_NetInfo info;
+
+    if (telemetry_port == 0) return;
+
+    if (getSn_SR(TELEMETRY_SOCK) != SOCK_UDP) {
+        ctlnetwork(CN_GET_NETINFO, (void*) &info);
+        memcpy(telemetry_mac, info.mac, 6);
+        if (socket(TELEMETRY_SOCK, Sn_MR_UDP, TELEMETRY_LOCAL_PORT, SF_IO_NONBLOCK) != TELEMETRY_SOCK) return;
+    }
+
+    if (Sampler_GetSeq() != telemetry_sample_seq) Telemetry_Append();
+
+    if (telemetry_count == 0) return;
+
+    if (telemetry_count >= telemetry_batch
+            || TICK_REACHED(Tick_GetMs(), telemetry_first + telemetry_interval)
+            || TELEMETRY_HDR_MAX + telemetry_len + TELEMETRY_LINE_MAX > TELEMETRY_BUF_SIZE) {
+        Telemetry_Flush();
+    }
+}
+
+/**
+ * @brief  Returns the number of samples that could not be pushed.
+ * @param  None
+ * @retval Dropped samples since boot.
+ */
+uint32_t Telemetry_GetDropped(void)
+{
+    return telemetry_dropped;
+}
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
@@ -0,0 +1,54 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/telemetry.h
+ * @author  WIZnet
+ * @brief   Header for telemetry.c module
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TELEMETRY_H
+#define __TELEMETRY_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/* Hardware socket and local port of the UDP push */
+#ifndef TELEMETRY_SOCK
+#define TELEMETRY_SOCK 7
+#endif
+#ifndef TELEMETRY_LOCAL_PORT
+#define TELEMETRY_LOCAL_PORT 5000
+#endif
+
+/* Collector; a destination port of 0 disables the push */
+#ifndef TELEMETRY_DEST_IP
+#define TELEMETRY_DEST_IP { 192, 168, 0, 100 }
+#endif
+#ifndef TELEMETRY_DEST_PORT
+#define TELEMETRY_DEST_PORT 0
+#endif
+
+/* A datagram is sent once it holds TELEMETRY_BATCH samples or its oldest
+ * sample is TELEMETRY_INTERVAL_MS old, whichever comes first */
+#ifndef TELEMETRY_BATCH
+#define TELEMETRY_BATCH 10
+#endif
+#ifndef TELEMETRY_INTERVAL_MS
+#define TELEMETRY_INTERVAL_MS 5000
+#endif
+
+/* Datagram buffer; bounds the batch size as well */
+#ifndef TELEMETRY_BUF_SIZE
+#define TELEMETRY_BUF_SIZE 512
+#endif
+
+/* Exported functions ------------------------------------------------------- */
+void Telemetry_Config(const uint8_t* ip, uint16_t port, uint16_t batch, uint32_t interval_ms);
+void Telemetry_Run(void);
+uint32_t Telemetry_GetDropped(void);
+
+#endif /* __TELEMETRY_H */
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
@@ -0,0 +1,25 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/tick.h
+ * @author  WIZnet
+ * @brief   Millisecond time base kept by the SysTick interrupt
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TICK_H
+#define __TICK_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported macro ------------------------------------------------------------*/
+/* Wrap-safe check that tick 'now' is at or past tick 'deadline' */
+#define TICK_REACHED(now, deadline) ((int32_t) ((now) - (deadline)) >= 0)
+
+/* Exported functions ------------------------------------------------------- */
+uint32_t Tick_GetMs(void);
+
+#endif /* __TICK_H */
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
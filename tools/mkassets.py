@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""Embed the web page assets into the firmware as const flash tables.
+
+Usage: mkassets.py <www-dir> <output.c>
+
+Every file in <www-dir> becomes one WebAsset (see web_assets.h) served at
+/<name>; index.html is served at /. For each asset the complete reply,
+status line and header included, is stored once as sent with identity
+encoding and once gzip-compressed, so a reply is a single send() straight
+from flash. The gzip form is dropped when it would not be smaller.
+
+The output only depends on the input files, so it can be regenerated as a
+pre-build step and stays byte-identical when nothing changed.
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+CONTENT_TYPES = {
+    ".html": "text/html; charset=utf-8",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".ico": "image/x-icon",
+    ".png": "image/png",
+}
+
+# Pages are revalidated on every load, everything they link is cached.
+CACHE_CONTROL = {
+    ".html": "no-cache",
+}
+DEFAULT_CACHE_CONTROL = "max-age=86400"
+
+
+def c_ident(name):
+    return re.sub(r"[^0-9A-Za-z]", "_", name)
+
+
+def c_bytes(data, indent="    "):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append(indent + ", ".join("0x%02X" % b for b in data[i:i + 16]) + ",")
+    return "\n".join(lines)
+
+
+def reply(ctype, cache, etag, body, encoding):
+    header = "HTTP/1.1 200 OK\r\n"
+    header += "Content-Type: %s\r\n" % ctype
+    if encoding:
+        header += "Content-Encoding: %s\r\n" % encoding
+    header += "Content-Length: %d\r\n" % len(body)
+    header += "ETag: %s\r\n" % etag
+    header += "Cache-Control: %s\r\n" % cache
+    header += "Vary: Accept-Encoding\r\n"
+    header += "\r\n"
+    header = header.encode("ascii")
+    return header + body, len(header)
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.stderr.write(__doc__)
+        return 2
+
+    www, out_c = sys.argv[1], sys.argv[2]
+    names = sorted(n for n in os.listdir(www) if os.path.isfile(os.path.join(www, n)))
+
+    out = []
+    out.append("/**")
+    out.append(" ******************************************************************************")
+    out.append(" * @file    WZTOE/WZTOE_WebServer/web_assets.c")
+    out.append(" * @author  WIZnet")
+    out.append(" * @brief   Embedded web assets, generated by tools/mkassets.py from www/.")
+    out.append(" *          Do not edit.")
+    out.append(" ******************************************************************************")
+    out.append(" */")
+    out.append("")
+    out.append("/* Includes ------------------------------------------------------------------*/")
+    out.append("#include \"web_assets.h\"")
+    out.append("")
+
+    table = []
+    total_identity = 0
+    total_gzip = 0
+    for name in names:
+        ext = os.path.splitext(name)[1]
+        if ext not in CONTENT_TYPES:
+            sys.stderr.write("mkassets: skipping %s (unknown type)\n" % name)
+            continue
+
+        with open(os.path.join(www, name), "rb") as f:
+            body = f.read()
+        ident = c_ident(name)
+        ctype = CONTENT_TYPES[ext]
+        cache = CACHE_CONTROL.get(ext, DEFAULT_CACHE_CONTROL)
+        digest = hashlib.sha1(body).hexdigest()[:8]
+        etag = '"%s"' % digest
+        etag_gzip = '"%s-gz"' % digest
+
+        resp, hdr_len = reply(ctype, cache, etag, body, None)
+        out.append("/* %s: %d bytes */" % (name, len(body)))
+        out.append("static const uint8_t asset_%s[%d] = {" % (ident, len(resp)))
+        out.append(c_bytes(resp))
+        out.append("};")
+        out.append("")
+        total_identity += len(body)
+
+        packed = gzip.compress(body, compresslevel=9, mtime=0)
+        if len(packed) < len(body):
+            resp_gz, hdr_len_gz = reply(ctype, cache, etag_gzip, packed, "gzip")
+            out.append("/* %s, gzip: %d bytes */" % (name, len(packed)))
+            out.append("static const uint8_t asset_%s_gz[%d] = {" % (ident, len(resp_gz)))
+            out.append(c_bytes(resp_gz))
+            out.append("};")
+            out.append("")
+            gz = ("asset_%s_gz" % ident, len(resp_gz), hdr_len_gz, '"\\"%s-gz\\""' % digest)
+            total_gzip += len(packed)
+        else:
+            gz = ("0", 0, 0, "0")
+            total_gzip += len(body)
+
+        path = "/" if name == "index.html" else "/" + name
+        table.append((path, '"\\"%s\\""' % digest, cache, "asset_%s" % ident, len(resp), hdr_len) + gz)
+
+    out.append("/* Exported variables --------------------------------------------------------*/")
+    out.append("const WebAsset web_assets[] = {")
+    for path, etag, cache, resp, resp_len, hdr_len, resp_gz, resp_gz_len, hdr_gz_len, etag_gz in table:
+        out.append("    { \"%s\", \"%s\", %s, %s, %s, %d, %d, %s, %d, %d }," % (
+            path, cache, etag, etag_gz, resp, resp_len, hdr_len, resp_gz, resp_gz_len, hdr_gz_len))
+    out.append("};")
+    out.append("")
+    out.append("const uint8_t web_asset_count = %d;" % len(table))
+    out.append("")
+    out.append("/* Body bytes: %d identity, %d gzip */" % (total_identity, total_gzip))
+    out.append("")
+    out.append("/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/")
+
+    with open(out_c, "w", newline="\n") as f:
+        f.write("\n".join(out) + "\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
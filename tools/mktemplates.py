@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+"""Compile the reply templates into segment tables for the firmware.
+
+Usage: mktemplates.py <template-dir> <output-dir>
+
+Every file in <template-dir> is a reply body with named placeholders such
+as {{reading}}. It is cut at the placeholders into static segments, each
+followed by the slot that goes after it, and written as one WebTemplate
+(see web_render.h) named web_tmpl_<stem> into <output-dir>/web_templates.c,
+with the slot numbers and the longest reply of each template in
+<output-dir>/web_templates.h. web_render.c then renders a reply in one pass
+over the table, and the buffer sizes are checked at compile time.
+
+A final newline of a template is dropped. Placeholders other than the
+slots listed below are an error.
+
+The output only depends on the input files, so it can be regenerated as a
+pre-build step and stays byte-identical when nothing changed.
+"""
+
+import os
+import re
+import sys
+
+CONTENT_TYPES = {
+    ".html": "text/html; charset=utf-8",
+    ".json": "application/json",
+    ".txt": "text/plain",
+}
+
+# Slot name, format and widest value. The order is the order of the
+# values array the firmware fills, see WebServer_Values().
+SLOTS = [
+    ("reading", "WEB_FMT_TENTHS", 5),       # Moisture of channel 0, "100.0"
+    ("gauge_pct", "WEB_FMT_UINT", 3),       # The same in whole percent
+    ("moisture0", "WEB_FMT_UINT", 4),       # Moisture per channel, 0.1 %
+    ("moisture1", "WEB_FMT_UINT", 4),
+    ("moisture2", "WEB_FMT_UINT", 4),
+    ("moisture3", "WEB_FMT_UINT", 4),
+    ("channel0", "WEB_FMT_UINT", 4),        # Filtered ADC counts per channel
+    ("channel1", "WEB_FMT_UINT", 4),
+    ("channel2", "WEB_FMT_UINT", 4),
+    ("channel3", "WEB_FMT_UINT", 4),
+    ("ts", "WEB_FMT_UINT", 10),             # Snapshot tick, ms
+    ("seq", "WEB_FMT_UINT", 10),            # Snapshot sequence number
+]
+
+PLACEHOLDER = re.compile(r"\{\{\s*([A-Za-z0-9_]+)\s*\}\}")
+
+HEADER = """/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/%s
+ * @author  WIZnet
+ * @brief   %s, generated by tools/mktemplates.py
+ *          from templates/. Do not edit.
+ ******************************************************************************
+ */"""
+
+FOOTER = "/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/"
+
+
+def c_ident(name):
+    return re.sub(r"[^0-9A-Za-z]", "_", name)
+
+
+def c_string(data, indent):
+    """Returns data as C string literals, one per source line."""
+    parts = []
+    cur = ""
+    for b in data:
+        c = chr(b)
+        if c == "\\" or c == '"':
+            cur += "\\" + c
+        elif c == "\n":
+            cur += "\\n"
+            parts.append(cur)
+            cur = ""
+            continue
+        elif c == "\r":
+            cur += "\\r"
+        elif c == "\t":
+            cur += "\\t"
+        elif 0x20 <= b < 0x7F:
+            cur += c
+        else:
+            cur += "\\%03o" % b
+    if cur or not parts:
+        parts.append(cur)
+    return ("\n" + indent).join('"%s"' % p for p in parts)
+
+
+def compile_template(name, body):
+    """Cuts a body into (text, slot) segments; the last one has no slot."""
+    slots = dict((s[0], i) for i, s in enumerate(SLOTS))
+    segments = []
+    pos = 0
+    for m in PLACEHOLDER.finditer(body):
+        if m.group(1) not in slots:
+            raise ValueError("%s: unknown placeholder {{%s}}" % (name, m.group(1)))
+        segments.append((body[pos:m.start()], slots[m.group(1)]))
+        pos = m.end()
+    segments.append((body[pos:], None))
+
+    for text, _ in segments:
+        if "{{" in text or "}}" in text:
+            raise ValueError("%s: malformed placeholder" % name)
+    return segments
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.stderr.write(__doc__)
+        return 2
+
+    src, out_dir = sys.argv[1], sys.argv[2]
+    names = sorted(n for n in os.listdir(src) if os.path.isfile(os.path.join(src, n)))
+
+    out_c = [HEADER % ("web_templates.c", "Reply templates"), ""]
+    out_c.append("/* Includes ------------------------------------------------------------------*/")
+    out_c.append("#include \"web_templates.h\"")
+    out_c.append("")
+
+    out_h = [HEADER % ("web_templates.h", "Slots and reply templates"), ""]
+    out_h.append("/* Define to prevent recursive inclusion -------------------------------------*/")
+    out_h.append("#ifndef __WEB_TEMPLATES_H")
+    out_h.append("#define __WEB_TEMPLATES_H")
+    out_h.append("")
+    out_h.append("/* Includes ------------------------------------------------------------------*/")
+    out_h.append("#include \"web_render.h\"")
+    out_h.append("")
+    out_h.append("/* Exported constants --------------------------------------------------------*/")
+    out_h.append("/* Slots, indices into the values array */")
+    for i, (slot, _, _) in enumerate(SLOTS):
+        out_h.append("#define %-31s %d" % ("WEB_SLOT_" + slot.upper(), i))
+    out_h.append("#define %-31s %d" % ("WEB_SLOT_NUM", len(SLOTS)))
+    out_h.append("")
+    out_h.append("/* Longest body and longest reply of each template, without the extra")
+    out_h.append(" * header fields passed to WebRender_Reply() */")
+
+    externs = []
+    for name in names:
+        stem, ext = os.path.splitext(name)
+        if ext not in CONTENT_TYPES:
+            sys.stderr.write("mktemplates: skipping %s (unknown type)\n" % name)
+            continue
+
+        with open(os.path.join(src, name), "rb") as f:
+            body = f.read().decode("utf-8")
+        if body.endswith("\n"):
+            body = body[:-1]
+        try:
+            segments = compile_template(name, body)
+        except ValueError as e:
+            sys.stderr.write("mktemplates: %s\n" % e)
+            return 1
+
+        ident = c_ident(stem)
+        head = ("HTTP/1.1 200 OK\r\n"
+                "Content-Type: %s\r\n"
+                "Cache-Control: no-cache\r\n" % CONTENT_TYPES[ext]).encode("ascii")
+        texts = [t.encode("utf-8") for t, _ in segments]
+        text_len = sum(len(t) for t in texts)
+        body_max = text_len + sum(SLOTS[s][2] for _, s in segments if s is not None)
+        reply_max = len(head) + len("Content-Length: \r\n\r\n") + len(str(body_max)) + body_max
+
+        out_c.append("/* %s: %d segments, %d static bytes, body %d bytes at most */" % (
+            name, len(segments), text_len, body_max))
+        out_c.append("static const WebSegment tmpl_%s_seg[%d] = {" % (ident, len(segments)))
+        for text, (_, slot) in zip(texts, segments):
+            if slot is None:
+                slot_name, fmt = "WEB_SLOT_NONE", "WEB_FMT_UINT"
+            else:
+                slot_name, fmt = "WEB_SLOT_" + SLOTS[slot][0].upper(), SLOTS[slot][1]
+            out_c.append("    { %s," % c_string(text, "      "))
+            out_c.append("      %d, %s, %s }," % (len(text), slot_name, fmt))
+        out_c.append("};")
+        out_c.append("")
+        out_c.append("const WebTemplate web_tmpl_%s = {" % ident)
+        out_c.append("    %s," % c_string(head, "    "))
+        out_c.append("    %d, tmpl_%s_seg, %d, %d" % (len(head), ident, len(segments), text_len))
+        out_c.append("};")
+        out_c.append("")
+
+        out_h.append("#define %-31s %d" % ("WEB_TMPL_%s_BODY_MAX" % ident.upper(), body_max))
+        out_h.append("#define %-31s %d" % ("WEB_TMPL_%s_MAX" % ident.upper(), reply_max))
+        externs.append("extern const WebTemplate web_tmpl_%s;" % ident)
+
+    out_c.append(FOOTER)
+
+    out_h.append("")
+    out_h.append("/* Exported variables --------------------------------------------------------*/")
+    out_h.extend(externs)
+    out_h.append("")
+    out_h.append("#endif /* __WEB_TEMPLATES_H */")
+    out_h.append("")
+    out_h.append(FOOTER)
+
+    for path, lines in ((os.path.join(out_dir, "web_templates.c"), out_c),
+                        (os.path.join(out_dir, "web_templates.h"), out_h)):
+        with open(path, "w", newline="\n") as f:
+            f.write("\n".join(lines) + "\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
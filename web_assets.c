@@ -0,0 +1,280 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/web_assets.c
+ * @author  WIZnet
+ * @brief   Embedded web assets, generated by tools/mkassets.py from www/.
+ *          Do not edit.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "web_assets.h"
+
+/* app.js: 422 bytes */
+static const uint8_t asset_app_js[571] = {
+    0x48, 0x54, 0x54, 0x50, 0x2F, 0x31, 0x2E, 0x31, 0x20, 0x32, 0x30, 0x30, 0x20, 0x4F, 0x4B, 0x0D,
+    0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x54, 0x79, 0x70, 0x65, 0x3A, 0x20, 0x61,
+    0x70, 0x70, 0x6C, 0x69, 0x63, 0x61, 0x74, 0x69, 0x6F, 0x6E, 0x2F, 0x6A, 0x61, 0x76, 0x61, 0x73,
+    0x63, 0x72, 0x69, 0x70, 0x74, 0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x4C,
+    0x65, 0x6E, 0x67, 0x74, 0x68, 0x3A, 0x20, 0x34, 0x32, 0x32, 0x0D, 0x0A, 0x45, 0x54, 0x61, 0x67,
+    0x3A, 0x20, 0x22, 0x63, 0x36, 0x35, 0x63, 0x30, 0x62, 0x30, 0x39, 0x22, 0x0D, 0x0A, 0x43, 0x61,
+    0x63, 0x68, 0x65, 0x2D, 0x43, 0x6F, 0x6E, 0x74, 0x72, 0x6F, 0x6C, 0x3A, 0x20, 0x6D, 0x61, 0x78,
+    0x2D, 0x61, 0x67, 0x65, 0x3D, 0x38, 0x36, 0x34, 0x30, 0x30, 0x0D, 0x0A, 0x56, 0x61, 0x72, 0x79,
+    0x3A, 0x20, 0x41, 0x63, 0x63, 0x65, 0x70, 0x74, 0x2D, 0x45, 0x6E, 0x63, 0x6F, 0x64, 0x69, 0x6E,
+    0x67, 0x0D, 0x0A, 0x0D, 0x0A, 0x66, 0x75, 0x6E, 0x63, 0x74, 0x69, 0x6F, 0x6E, 0x20, 0x73, 0x68,
+    0x6F, 0x77, 0x28, 0x64, 0x29, 0x20, 0x7B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x76, 0x61, 0x72, 0x20,
+    0x76, 0x20, 0x3D, 0x20, 0x64, 0x2E, 0x72, 0x65, 0x61, 0x64, 0x69, 0x6E, 0x67, 0x2C, 0x20, 0x67,
+    0x20, 0x3D, 0x20, 0x64, 0x6F, 0x63, 0x75, 0x6D, 0x65, 0x6E, 0x74, 0x2E, 0x67, 0x65, 0x74, 0x45,
+    0x6C, 0x65, 0x6D, 0x65, 0x6E, 0x74, 0x42, 0x79, 0x49, 0x64, 0x28, 0x27, 0x67, 0x27, 0x29, 0x3B,
+    0x0A, 0x20, 0x20, 0x20, 0x20, 0x67, 0x2E, 0x73, 0x65, 0x74, 0x41, 0x74, 0x74, 0x72, 0x69, 0x62,
+    0x75, 0x74, 0x65, 0x28, 0x27, 0x64, 0x61, 0x74, 0x61, 0x2D, 0x76, 0x27, 0x2C, 0x20, 0x76, 0x20,
+    0x2B, 0x20, 0x27, 0x25, 0x27, 0x29, 0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x67, 0x2E, 0x73, 0x74,
+    0x79, 0x6C, 0x65, 0x2E, 0x62, 0x61, 0x63, 0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64, 0x20, 0x3D,
+    0x20, 0x27, 0x63, 0x6F, 0x6E, 0x69, 0x63, 0x2D, 0x67, 0x72, 0x61, 0x64, 0x69, 0x65, 0x6E, 0x74,
+    0x28, 0x23, 0x34, 0x63, 0x61, 0x66, 0x35, 0x30, 0x20, 0x30, 0x25, 0x20, 0x27, 0x20, 0x2B, 0x20,
+    0x76, 0x20, 0x2B, 0x20, 0x27, 0x25, 0x2C, 0x20, 0x23, 0x66, 0x34, 0x34, 0x33, 0x33, 0x36, 0x20,
+    0x27, 0x20, 0x2B, 0x20, 0x76, 0x20, 0x2B, 0x20, 0x27, 0x25, 0x20, 0x31, 0x30, 0x30, 0x25, 0x29,
+    0x27, 0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x64, 0x6F, 0x63, 0x75, 0x6D, 0x65, 0x6E, 0x74, 0x2E,
+    0x67, 0x65, 0x74, 0x45, 0x6C, 0x65, 0x6D, 0x65, 0x6E, 0x74, 0x42, 0x79, 0x49, 0x64, 0x28, 0x27,
+    0x72, 0x27, 0x29, 0x2E, 0x74, 0x65, 0x78, 0x74, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x20,
+    0x3D, 0x20, 0x76, 0x20, 0x2B, 0x20, 0x27, 0x25, 0x27, 0x3B, 0x0A, 0x7D, 0x0A, 0x66, 0x65, 0x74,
+    0x63, 0x68, 0x28, 0x27, 0x2F, 0x61, 0x70, 0x69, 0x2F, 0x6D, 0x6F, 0x69, 0x73, 0x74, 0x75, 0x72,
+    0x65, 0x27, 0x29, 0x2E, 0x74, 0x68, 0x65, 0x6E, 0x28, 0x66, 0x75, 0x6E, 0x63, 0x74, 0x69, 0x6F,
+    0x6E, 0x20, 0x28, 0x72, 0x29, 0x20, 0x7B, 0x20, 0x72, 0x65, 0x74, 0x75, 0x72, 0x6E, 0x20, 0x72,
+    0x2E, 0x6A, 0x73, 0x6F, 0x6E, 0x28, 0x29, 0x3B, 0x20, 0x7D, 0x29, 0x2E, 0x74, 0x68, 0x65, 0x6E,
+    0x28, 0x73, 0x68, 0x6F, 0x77, 0x29, 0x3B, 0x0A, 0x6E, 0x65, 0x77, 0x20, 0x45, 0x76, 0x65, 0x6E,
+    0x74, 0x53, 0x6F, 0x75, 0x72, 0x63, 0x65, 0x28, 0x27, 0x2F, 0x65, 0x76, 0x65, 0x6E, 0x74, 0x73,
+    0x27, 0x29, 0x2E, 0x6F, 0x6E, 0x6D, 0x65, 0x73, 0x73, 0x61, 0x67, 0x65, 0x20, 0x3D, 0x20, 0x66,
+    0x75, 0x6E, 0x63, 0x74, 0x69, 0x6F, 0x6E, 0x20, 0x28, 0x65, 0x29, 0x20, 0x7B, 0x20, 0x73, 0x68,
+    0x6F, 0x77, 0x28, 0x4A, 0x53, 0x4F, 0x4E, 0x2E, 0x70, 0x61, 0x72, 0x73, 0x65, 0x28, 0x65, 0x2E,
+    0x64, 0x61, 0x74, 0x61, 0x29, 0x29, 0x3B, 0x20, 0x7D, 0x3B, 0x0A,
+};
+
+/* app.js, gzip: 295 bytes */
+static const uint8_t asset_app_js_gz[471] = {
+    0x48, 0x54, 0x54, 0x50, 0x2F, 0x31, 0x2E, 0x31, 0x20, 0x32, 0x30, 0x30, 0x20, 0x4F, 0x4B, 0x0D,
+    0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x54, 0x79, 0x70, 0x65, 0x3A, 0x20, 0x61,
+    0x70, 0x70, 0x6C, 0x69, 0x63, 0x61, 0x74, 0x69, 0x6F, 0x6E, 0x2F, 0x6A, 0x61, 0x76, 0x61, 0x73,
+    0x63, 0x72, 0x69, 0x70, 0x74, 0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x45,
+    0x6E, 0x63, 0x6F, 0x64, 0x69, 0x6E, 0x67, 0x3A, 0x20, 0x67, 0x7A, 0x69, 0x70, 0x0D, 0x0A, 0x43,
+    0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x4C, 0x65, 0x6E, 0x67, 0x74, 0x68, 0x3A, 0x20, 0x32,
+    0x39, 0x35, 0x0D, 0x0A, 0x45, 0x54, 0x61, 0x67, 0x3A, 0x20, 0x22, 0x63, 0x36, 0x35, 0x63, 0x30,
+    0x62, 0x30, 0x39, 0x2D, 0x67, 0x7A, 0x22, 0x0D, 0x0A, 0x43, 0x61, 0x63, 0x68, 0x65, 0x2D, 0x43,
+    0x6F, 0x6E, 0x74, 0x72, 0x6F, 0x6C, 0x3A, 0x20, 0x6D, 0x61, 0x78, 0x2D, 0x61, 0x67, 0x65, 0x3D,
+    0x38, 0x36, 0x34, 0x30, 0x30, 0x0D, 0x0A, 0x56, 0x61, 0x72, 0x79, 0x3A, 0x20, 0x41, 0x63, 0x63,
+    0x65, 0x70, 0x74, 0x2D, 0x45, 0x6E, 0x63, 0x6F, 0x64, 0x69, 0x6E, 0x67, 0x0D, 0x0A, 0x0D, 0x0A,
+    0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x75, 0x90, 0xC1, 0x4E, 0xC3, 0x30,
+    0x0C, 0x86, 0xEF, 0x7D, 0x0A, 0x4B, 0xD3, 0x94, 0x54, 0x6C, 0x59, 0xD1, 0x0A, 0x97, 0x8A, 0x03,
+    0xA0, 0x1D, 0xE0, 0x00, 0x87, 0x3D, 0x41, 0x96, 0xBA, 0x69, 0x61, 0x4D, 0xA6, 0xC4, 0xED, 0x98,
+    0xD0, 0xDE, 0x1D, 0x67, 0x1B, 0x62, 0x17, 0x72, 0x8A, 0x9D, 0xDF, 0xDF, 0xEF, 0xFC, 0xCD, 0xE0,
+    0x0C, 0x75, 0xDE, 0x41, 0x6C, 0xFD, 0x5E, 0xD6, 0x39, 0x7C, 0x67, 0xC0, 0x67, 0xD4, 0x01, 0x46,
+    0x78, 0x80, 0x5A, 0x05, 0xD4, 0x75, 0xE7, 0xEC, 0x0C, 0x6C, 0x2A, 0xBD, 0x19, 0x7A, 0x74, 0xA4,
+    0x2C, 0xD2, 0x6A, 0x8B, 0xE9, 0xFA, 0x74, 0x78, 0xA9, 0xA5, 0xB0, 0x22, 0xAF, 0x4E, 0x83, 0x56,
+    0x45, 0xA4, 0x47, 0xA2, 0xD0, 0x6D, 0x06, 0x42, 0x29, 0x6A, 0x4D, 0x7A, 0x3E, 0x8A, 0x19, 0xD3,
+    0x6E, 0x40, 0x4C, 0xAF, 0x64, 0x74, 0xD8, 0xA2, 0xDA, 0x68, 0xF3, 0x69, 0x83, 0x1F, 0x5C, 0xCD,
+    0x74, 0x61, 0xBC, 0xEB, 0xCC, 0xDC, 0x06, 0x76, 0x64, 0xB2, 0x9C, 0x94, 0x46, 0x37, 0x77, 0x05,
+    0x14, 0x53, 0x10, 0x3C, 0x7D, 0x26, 0xCC, 0x60, 0xD2, 0x94, 0xE5, 0x72, 0x79, 0x7F, 0xD5, 0x83,
+    0xDB, 0xA2, 0x98, 0xE6, 0xE2, 0x8C, 0xFE, 0x77, 0xC7, 0x20, 0x72, 0x45, 0xF8, 0x45, 0xCF, 0xDE,
+    0x11, 0x37, 0xD9, 0xF0, 0xB2, 0x53, 0x95, 0x1D, 0xB3, 0x06, 0xC9, 0xB4, 0x52, 0x2C, 0xF4, 0xAE,
+    0x5B, 0xF4, 0xBE, 0x8B, 0x34, 0x04, 0x4C, 0xFA, 0x16, 0x9D, 0x6C, 0x7E, 0x33, 0x92, 0x81, 0xF3,
+    0x81, 0x80, 0xFC, 0xE8, 0x20, 0xA8, 0x8F, 0xE8, 0x9D, 0xCC, 0x2B, 0x38, 0x5E, 0x74, 0x29, 0x42,
+    0xFE, 0x9F, 0xC3, 0x3D, 0xAC, 0x46, 0x76, 0x58, 0xFB, 0x21, 0x18, 0xCE, 0x60, 0x81, 0xA9, 0x8A,
+    0x8C, 0xF3, 0xAE, 0xC7, 0x18, 0xB5, 0x45, 0x36, 0xFF, 0xA3, 0x62, 0xA2, 0x9E, 0xF2, 0x7F, 0x5D,
+    0xBF, 0xBF, 0xA9, 0x9D, 0x0E, 0x11, 0x25, 0xAA, 0x14, 0x5D, 0x9E, 0xF0, 0x55, 0xF6, 0x03, 0x2D,
+    0xBF, 0x84, 0xD9, 0xA6, 0x01, 0x00, 0x00,
+};
+
+/* index.html: 403 bytes */
+static const uint8_t asset_index_html[549] = {
+    0x48, 0x54, 0x54, 0x50, 0x2F, 0x31, 0x2E, 0x31, 0x20, 0x32, 0x30, 0x30, 0x20, 0x4F, 0x4B, 0x0D,
+    0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x54, 0x79, 0x70, 0x65, 0x3A, 0x20, 0x74,
+    0x65, 0x78, 0x74, 0x2F, 0x68, 0x74, 0x6D, 0x6C, 0x3B, 0x20, 0x63, 0x68, 0x61, 0x72, 0x73, 0x65,
+    0x74, 0x3D, 0x75, 0x74, 0x66, 0x2D, 0x38, 0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74,
+    0x2D, 0x4C, 0x65, 0x6E, 0x67, 0x74, 0x68, 0x3A, 0x20, 0x34, 0x30, 0x33, 0x0D, 0x0A, 0x45, 0x54,
+    0x61, 0x67, 0x3A, 0x20, 0x22, 0x38, 0x31, 0x63, 0x33, 0x65, 0x65, 0x65, 0x39, 0x22, 0x0D, 0x0A,
+    0x43, 0x61, 0x63, 0x68, 0x65, 0x2D, 0x43, 0x6F, 0x6E, 0x74, 0x72, 0x6F, 0x6C, 0x3A, 0x20, 0x6E,
+    0x6F, 0x2D, 0x63, 0x61, 0x63, 0x68, 0x65, 0x0D, 0x0A, 0x56, 0x61, 0x72, 0x79, 0x3A, 0x20, 0x41,
+    0x63, 0x63, 0x65, 0x70, 0x74, 0x2D, 0x45, 0x6E, 0x63, 0x6F, 0x64, 0x69, 0x6E, 0x67, 0x0D, 0x0A,
+    0x0D, 0x0A, 0x3C, 0x21, 0x44, 0x4F, 0x43, 0x54, 0x59, 0x50, 0x45, 0x20, 0x48, 0x54, 0x4D, 0x4C,
+    0x3E, 0x0A, 0x3C, 0x68, 0x74, 0x6D, 0x6C, 0x3E, 0x0A, 0x3C, 0x68, 0x65, 0x61, 0x64, 0x3E, 0x0A,
+    0x20, 0x20, 0x20, 0x20, 0x3C, 0x6D, 0x65, 0x74, 0x61, 0x20, 0x63, 0x68, 0x61, 0x72, 0x73, 0x65,
+    0x74, 0x3D, 0x22, 0x55, 0x54, 0x46, 0x2D, 0x38, 0x22, 0x3E, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x3C,
+    0x74, 0x69, 0x74, 0x6C, 0x65, 0x3E, 0x57, 0x69, 0x7A, 0x6E, 0x65, 0x74, 0x20, 0x57, 0x37, 0x35,
+    0x30, 0x30, 0x78, 0x20, 0x57, 0x65, 0x62, 0x20, 0x53, 0x65, 0x72, 0x76, 0x65, 0x72, 0x3C, 0x2F,
+    0x74, 0x69, 0x74, 0x6C, 0x65, 0x3E, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x6C, 0x69, 0x6E, 0x6B,
+    0x20, 0x72, 0x65, 0x6C, 0x3D, 0x22, 0x73, 0x74, 0x79, 0x6C, 0x65, 0x73, 0x68, 0x65, 0x65, 0x74,
+    0x22, 0x20, 0x68, 0x72, 0x65, 0x66, 0x3D, 0x22, 0x2F, 0x73, 0x74, 0x79, 0x6C, 0x65, 0x2E, 0x63,
+    0x73, 0x73, 0x22, 0x3E, 0x0A, 0x3C, 0x2F, 0x68, 0x65, 0x61, 0x64, 0x3E, 0x0A, 0x3C, 0x62, 0x6F,
+    0x64, 0x79, 0x3E, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6C, 0x61,
+    0x73, 0x73, 0x3D, 0x22, 0x63, 0x6F, 0x6E, 0x74, 0x61, 0x69, 0x6E, 0x65, 0x72, 0x22, 0x3E, 0x0A,
+    0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x68, 0x31, 0x3E, 0x57, 0x69, 0x7A, 0x6E,
+    0x65, 0x74, 0x20, 0x57, 0x37, 0x35, 0x30, 0x30, 0x78, 0x20, 0x57, 0x65, 0x62, 0x20, 0x53, 0x65,
+    0x72, 0x76, 0x65, 0x72, 0x3C, 0x2F, 0x68, 0x31, 0x3E, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+    0x20, 0x20, 0x3C, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6C, 0x61, 0x73, 0x73, 0x3D, 0x22, 0x67, 0x61,
+    0x75, 0x67, 0x65, 0x22, 0x20, 0x69, 0x64, 0x3D, 0x22, 0x67, 0x22, 0x20, 0x64, 0x61, 0x74, 0x61,
+    0x2D, 0x76, 0x3D, 0x22, 0x2D, 0x2D, 0x22, 0x3E, 0x3C, 0x2F, 0x64, 0x69, 0x76, 0x3E, 0x0A, 0x20,
+    0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x70, 0x3E, 0x53, 0x6F, 0x69, 0x6C, 0x20, 0x6D,
+    0x6F, 0x69, 0x73, 0x74, 0x75, 0x72, 0x65, 0x20, 0x69, 0x73, 0x20, 0x3C, 0x73, 0x70, 0x61, 0x6E,
+    0x20, 0x69, 0x64, 0x3D, 0x22, 0x72, 0x22, 0x3E, 0x2D, 0x2D, 0x3C, 0x2F, 0x73, 0x70, 0x61, 0x6E,
+    0x3E, 0x3C, 0x2F, 0x70, 0x3E, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x2F, 0x64, 0x69, 0x76, 0x3E,
+    0x0A, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x20, 0x73, 0x72, 0x63,
+    0x3D, 0x22, 0x2F, 0x61, 0x70, 0x70, 0x2E, 0x6A, 0x73, 0x22, 0x3E, 0x3C, 0x2F, 0x73, 0x63, 0x72,
+    0x69, 0x70, 0x74, 0x3E, 0x0A, 0x3C, 0x2F, 0x62, 0x6F, 0x64, 0x79, 0x3E, 0x0A, 0x3C, 0x2F, 0x68,
+    0x74, 0x6D, 0x6C, 0x3E, 0x0A,
+};
+
+/* index.html, gzip: 264 bytes */
+static const uint8_t asset_index_html_gz[437] = {
+    0x48, 0x54, 0x54, 0x50, 0x2F, 0x31, 0x2E, 0x31, 0x20, 0x32, 0x30, 0x30, 0x20, 0x4F, 0x4B, 0x0D,
+    0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x54, 0x79, 0x70, 0x65, 0x3A, 0x20, 0x74,
+    0x65, 0x78, 0x74, 0x2F, 0x68, 0x74, 0x6D, 0x6C, 0x3B, 0x20, 0x63, 0x68, 0x61, 0x72, 0x73, 0x65,
+    0x74, 0x3D, 0x75, 0x74, 0x66, 0x2D, 0x38, 0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74,
+    0x2D, 0x45, 0x6E, 0x63, 0x6F, 0x64, 0x69, 0x6E, 0x67, 0x3A, 0x20, 0x67, 0x7A, 0x69, 0x70, 0x0D,
+    0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x4C, 0x65, 0x6E, 0x67, 0x74, 0x68, 0x3A,
+    0x20, 0x32, 0x36, 0x34, 0x0D, 0x0A, 0x45, 0x54, 0x61, 0x67, 0x3A, 0x20, 0x22, 0x38, 0x31, 0x63,
+    0x33, 0x65, 0x65, 0x65, 0x39, 0x2D, 0x67, 0x7A, 0x22, 0x0D, 0x0A, 0x43, 0x61, 0x63, 0x68, 0x65,
+    0x2D, 0x43, 0x6F, 0x6E, 0x74, 0x72, 0x6F, 0x6C, 0x3A, 0x20, 0x6E, 0x6F, 0x2D, 0x63, 0x61, 0x63,
+    0x68, 0x65, 0x0D, 0x0A, 0x56, 0x61, 0x72, 0x79, 0x3A, 0x20, 0x41, 0x63, 0x63, 0x65, 0x70, 0x74,
+    0x2D, 0x45, 0x6E, 0x63, 0x6F, 0x64, 0x69, 0x6E, 0x67, 0x0D, 0x0A, 0x0D, 0x0A, 0x1F, 0x8B, 0x08,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x7D, 0x50, 0xB1, 0x4E, 0xC3, 0x30, 0x10, 0xDD, 0xFB,
+    0x15, 0x87, 0x77, 0x37, 0x65, 0x40, 0x30, 0x38, 0x5E, 0x0A, 0x88, 0x01, 0x04, 0x52, 0x83, 0x22,
+    0x46, 0xD7, 0x39, 0x1A, 0x83, 0x93, 0x58, 0xBE, 0x6B, 0x44, 0xF9, 0x7A, 0x9C, 0x38, 0x52, 0x3B,
+    0xE1, 0xC5, 0xBE, 0x7B, 0xF7, 0xDE, 0xBD, 0x67, 0x75, 0x75, 0xFF, 0xBA, 0xAD, 0x3E, 0xDE, 0x1E,
+    0xE0, 0xA9, 0x7A, 0x79, 0xD6, 0x2B, 0xD5, 0x72, 0xE7, 0xA7, 0x0B, 0x4D, 0xA3, 0x57, 0x90, 0x8E,
+    0xEA, 0x90, 0x0D, 0xD8, 0xD6, 0x44, 0x42, 0x2E, 0xC5, 0x7B, 0xF5, 0x28, 0xEF, 0xC4, 0x02, 0xB1,
+    0x63, 0x8F, 0xBA, 0x76, 0xBF, 0x3D, 0x32, 0xD4, 0xB7, 0x37, 0x9B, 0xCD, 0x0F, 0xD4, 0xB8, 0x87,
+    0x1D, 0xC6, 0x11, 0xA3, 0x2A, 0x32, 0x9E, 0x67, 0xBD, 0xEB, 0xBF, 0x21, 0xA2, 0x2F, 0x05, 0xF1,
+    0xC9, 0x23, 0xB5, 0x88, 0x2C, 0xA0, 0x8D, 0xF8, 0x59, 0x8A, 0x62, 0x6E, 0xAD, 0x2D, 0x51, 0x52,
+    0x56, 0x45, 0x5E, 0xAE, 0xF6, 0x43, 0x73, 0x5A, 0xC8, 0x8D, 0x1B, 0xC1, 0x7A, 0x43, 0x54, 0x0A,
+    0x3B, 0xF4, 0x6C, 0x5C, 0x8F, 0x71, 0x31, 0x31, 0xE3, 0xED, 0xF5, 0x3F, 0x2E, 0x12, 0x78, 0x9E,
+    0xBC, 0x50, 0x3A, 0x98, 0xE3, 0x01, 0x05, 0xB8, 0x26, 0x3D, 0x05, 0x34, 0x86, 0x8D, 0x1C, 0x4B,
+    0x21, 0xA5, 0xD0, 0xAA, 0x48, 0x63, 0x17, 0xA4, 0xA0, 0x77, 0x83, 0xF3, 0xD0, 0x0D, 0x8E, 0xF8,
+    0x18, 0x11, 0x1C, 0x81, 0xA2, 0x60, 0xFA, 0x99, 0x9B, 0x8C, 0x48, 0xA9, 0x8A, 0xA9, 0x4E, 0xC4,
+    0xB0, 0x38, 0x3E, 0x2B, 0x28, 0xB2, 0xD1, 0x05, 0x06, 0x8A, 0x36, 0x25, 0x35, 0x21, 0xAC, 0xBF,
+    0x68, 0x5A, 0x91, 0xDB, 0x53, 0xDE, 0x1C, 0x34, 0x19, 0x9D, 0xFF, 0xFE, 0x0F, 0xD8, 0xA6, 0x7B,
+    0xD9, 0x93, 0x01, 0x00, 0x00,
+};
+
+/* style.css: 937 bytes */
+static const uint8_t asset_style_css[1072] = {
+    0x48, 0x54, 0x54, 0x50, 0x2F, 0x31, 0x2E, 0x31, 0x20, 0x32, 0x30, 0x30, 0x20, 0x4F, 0x4B, 0x0D,
+    0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x54, 0x79, 0x70, 0x65, 0x3A, 0x20, 0x74,
+    0x65, 0x78, 0x74, 0x2F, 0x63, 0x73, 0x73, 0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74,
+    0x2D, 0x4C, 0x65, 0x6E, 0x67, 0x74, 0x68, 0x3A, 0x20, 0x39, 0x33, 0x37, 0x0D, 0x0A, 0x45, 0x54,
+    0x61, 0x67, 0x3A, 0x20, 0x22, 0x30, 0x33, 0x36, 0x61, 0x34, 0x31, 0x31, 0x38, 0x22, 0x0D, 0x0A,
+    0x43, 0x61, 0x63, 0x68, 0x65, 0x2D, 0x43, 0x6F, 0x6E, 0x74, 0x72, 0x6F, 0x6C, 0x3A, 0x20, 0x6D,
+    0x61, 0x78, 0x2D, 0x61, 0x67, 0x65, 0x3D, 0x38, 0x36, 0x34, 0x30, 0x30, 0x0D, 0x0A, 0x56, 0x61,
+    0x72, 0x79, 0x3A, 0x20, 0x41, 0x63, 0x63, 0x65, 0x70, 0x74, 0x2D, 0x45, 0x6E, 0x63, 0x6F, 0x64,
+    0x69, 0x6E, 0x67, 0x0D, 0x0A, 0x0D, 0x0A, 0x62, 0x6F, 0x64, 0x79, 0x20, 0x7B, 0x0A, 0x20, 0x20,
+    0x20, 0x20, 0x66, 0x6F, 0x6E, 0x74, 0x2D, 0x66, 0x61, 0x6D, 0x69, 0x6C, 0x79, 0x3A, 0x20, 0x41,
+    0x72, 0x69, 0x61, 0x6C, 0x2C, 0x20, 0x73, 0x61, 0x6E, 0x73, 0x2D, 0x73, 0x65, 0x72, 0x69, 0x66,
+    0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x6D, 0x61, 0x72, 0x67, 0x69, 0x6E, 0x3A, 0x20, 0x30, 0x3B,
+    0x0A, 0x20, 0x20, 0x20, 0x20, 0x70, 0x61, 0x64, 0x64, 0x69, 0x6E, 0x67, 0x3A, 0x20, 0x30, 0x3B,
+    0x0A, 0x20, 0x20, 0x20, 0x20, 0x64, 0x69, 0x73, 0x70, 0x6C, 0x61, 0x79, 0x3A, 0x20, 0x66, 0x6C,
+    0x65, 0x78, 0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x6A, 0x75, 0x73, 0x74, 0x69, 0x66, 0x79, 0x2D,
+    0x63, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x3A, 0x20, 0x63, 0x65, 0x6E, 0x74, 0x65, 0x72, 0x3B,
+    0x0A, 0x20, 0x20, 0x20, 0x20, 0x61, 0x6C, 0x69, 0x67, 0x6E, 0x2D, 0x69, 0x74, 0x65, 0x6D, 0x73,
+    0x3A, 0x20, 0x63, 0x65, 0x6E, 0x74, 0x65, 0x72, 0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x68, 0x65,
+    0x69, 0x67, 0x68, 0x74, 0x3A, 0x20, 0x31, 0x30, 0x30, 0x76, 0x68, 0x3B, 0x0A, 0x20, 0x20, 0x20,
+    0x20, 0x62, 0x61, 0x63, 0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64, 0x2D, 0x63, 0x6F, 0x6C, 0x6F,
+    0x72, 0x3A, 0x20, 0x23, 0x66, 0x34, 0x66, 0x34, 0x66, 0x39, 0x3B, 0x0A, 0x7D, 0x0A, 0x2E, 0x63,
+    0x6F, 0x6E, 0x74, 0x61, 0x69, 0x6E, 0x65, 0x72, 0x20, 0x7B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x74,
+    0x65, 0x78, 0x74, 0x2D, 0x61, 0x6C, 0x69, 0x67, 0x6E, 0x3A, 0x20, 0x63, 0x65, 0x6E, 0x74, 0x65,
+    0x72, 0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x62, 0x61, 0x63, 0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E,
+    0x64, 0x3A, 0x20, 0x23, 0x66, 0x66, 0x66, 0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x70, 0x61, 0x64,
+    0x64, 0x69, 0x6E, 0x67, 0x3A, 0x20, 0x32, 0x30, 0x70, 0x78, 0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20,
+    0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x2D, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3A, 0x20, 0x31,
+    0x30, 0x70, 0x78, 0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x62, 0x6F, 0x78, 0x2D, 0x73, 0x68, 0x61,
+    0x64, 0x6F, 0x77, 0x3A, 0x20, 0x30, 0x20, 0x34, 0x70, 0x78, 0x20, 0x38, 0x70, 0x78, 0x20, 0x72,
+    0x67, 0x62, 0x61, 0x28, 0x30, 0x2C, 0x30, 0x2C, 0x30, 0x2C, 0x30, 0x2E, 0x31, 0x29, 0x3B, 0x0A,
+    0x7D, 0x0A, 0x68, 0x31, 0x20, 0x7B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6F, 0x6C, 0x6F, 0x72,
+    0x3A, 0x20, 0x23, 0x33, 0x33, 0x33, 0x3B, 0x0A, 0x7D, 0x0A, 0x2E, 0x67, 0x61, 0x75, 0x67, 0x65,
+    0x20, 0x7B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3A, 0x20, 0x32, 0x30,
+    0x30, 0x70, 0x78, 0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A,
+    0x20, 0x32, 0x30, 0x30, 0x70, 0x78, 0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x62, 0x6F, 0x72, 0x64,
+    0x65, 0x72, 0x2D, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3A, 0x20, 0x35, 0x30, 0x25, 0x3B, 0x0A,
+    0x20, 0x20, 0x20, 0x20, 0x62, 0x61, 0x63, 0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64, 0x3A, 0x20,
+    0x63, 0x6F, 0x6E, 0x69, 0x63, 0x2D, 0x67, 0x72, 0x61, 0x64, 0x69, 0x65, 0x6E, 0x74, 0x28, 0x23,
+    0x34, 0x63, 0x61, 0x66, 0x35, 0x30, 0x20, 0x30, 0x25, 0x20, 0x35, 0x30, 0x25, 0x2C, 0x20, 0x23,
+    0x66, 0x34, 0x34, 0x33, 0x33, 0x36, 0x20, 0x35, 0x30, 0x25, 0x20, 0x31, 0x30, 0x30, 0x25, 0x29,
+    0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x70, 0x6F, 0x73, 0x69, 0x74, 0x69, 0x6F, 0x6E, 0x3A, 0x20,
+    0x72, 0x65, 0x6C, 0x61, 0x74, 0x69, 0x76, 0x65, 0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x6D, 0x61,
+    0x72, 0x67, 0x69, 0x6E, 0x3A, 0x20, 0x32, 0x30, 0x70, 0x78, 0x20, 0x61, 0x75, 0x74, 0x6F, 0x3B,
+    0x0A, 0x7D, 0x0A, 0x2E, 0x67, 0x61, 0x75, 0x67, 0x65, 0x3A, 0x62, 0x65, 0x66, 0x6F, 0x72, 0x65,
+    0x20, 0x7B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x3A, 0x20,
+    0x27, 0x27, 0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3A, 0x20, 0x31,
+    0x36, 0x30, 0x70, 0x78, 0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74,
+    0x3A, 0x20, 0x31, 0x36, 0x30, 0x70, 0x78, 0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x62, 0x61, 0x63,
+    0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64, 0x3A, 0x20, 0x23, 0x66, 0x66, 0x66, 0x3B, 0x0A, 0x20,
+    0x20, 0x20, 0x20, 0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x2D, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73,
+    0x3A, 0x20, 0x35, 0x30, 0x25, 0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x70, 0x6F, 0x73, 0x69, 0x74,
+    0x69, 0x6F, 0x6E, 0x3A, 0x20, 0x61, 0x62, 0x73, 0x6F, 0x6C, 0x75, 0x74, 0x65, 0x3B, 0x0A, 0x20,
+    0x20, 0x20, 0x20, 0x74, 0x6F, 0x70, 0x3A, 0x20, 0x35, 0x30, 0x25, 0x3B, 0x0A, 0x20, 0x20, 0x20,
+    0x20, 0x6C, 0x65, 0x66, 0x74, 0x3A, 0x20, 0x35, 0x30, 0x25, 0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20,
+    0x74, 0x72, 0x61, 0x6E, 0x73, 0x66, 0x6F, 0x72, 0x6D, 0x3A, 0x20, 0x74, 0x72, 0x61, 0x6E, 0x73,
+    0x6C, 0x61, 0x74, 0x65, 0x28, 0x2D, 0x35, 0x30, 0x25, 0x2C, 0x20, 0x2D, 0x35, 0x30, 0x25, 0x29,
+    0x3B, 0x0A, 0x7D, 0x0A, 0x2E, 0x67, 0x61, 0x75, 0x67, 0x65, 0x3A, 0x61, 0x66, 0x74, 0x65, 0x72,
+    0x20, 0x7B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x3A, 0x20,
+    0x61, 0x74, 0x74, 0x72, 0x28, 0x64, 0x61, 0x74, 0x61, 0x2D, 0x76, 0x29, 0x3B, 0x0A, 0x20, 0x20,
+    0x20, 0x20, 0x66, 0x6F, 0x6E, 0x74, 0x2D, 0x73, 0x69, 0x7A, 0x65, 0x3A, 0x20, 0x32, 0x65, 0x6D,
+    0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6F, 0x6C, 0x6F, 0x72, 0x3A, 0x20, 0x23, 0x33, 0x33,
+    0x33, 0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x70, 0x6F, 0x73, 0x69, 0x74, 0x69, 0x6F, 0x6E, 0x3A,
+    0x20, 0x61, 0x62, 0x73, 0x6F, 0x6C, 0x75, 0x74, 0x65, 0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x74,
+    0x6F, 0x70, 0x3A, 0x20, 0x35, 0x30, 0x25, 0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x6C, 0x65, 0x66,
+    0x74, 0x3A, 0x20, 0x35, 0x30, 0x25, 0x3B, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x74, 0x72, 0x61, 0x6E,
+    0x73, 0x66, 0x6F, 0x72, 0x6D, 0x3A, 0x20, 0x74, 0x72, 0x61, 0x6E, 0x73, 0x6C, 0x61, 0x74, 0x65,
+    0x28, 0x2D, 0x35, 0x30, 0x25, 0x2C, 0x20, 0x2D, 0x35, 0x30, 0x25, 0x29, 0x3B, 0x0A, 0x7D, 0x0A,
+};
+
+/* style.css, gzip: 409 bytes */
+static const uint8_t asset_style_css_gz[571] = {
+    0x48, 0x54, 0x54, 0x50, 0x2F, 0x31, 0x2E, 0x31, 0x20, 0x32, 0x30, 0x30, 0x20, 0x4F, 0x4B, 0x0D,
+    0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x54, 0x79, 0x70, 0x65, 0x3A, 0x20, 0x74,
+    0x65, 0x78, 0x74, 0x2F, 0x63, 0x73, 0x73, 0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74,
+    0x2D, 0x45, 0x6E, 0x63, 0x6F, 0x64, 0x69, 0x6E, 0x67, 0x3A, 0x20, 0x67, 0x7A, 0x69, 0x70, 0x0D,
+    0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x4C, 0x65, 0x6E, 0x67, 0x74, 0x68, 0x3A,
+    0x20, 0x34, 0x30, 0x39, 0x0D, 0x0A, 0x45, 0x54, 0x61, 0x67, 0x3A, 0x20, 0x22, 0x30, 0x33, 0x36,
+    0x61, 0x34, 0x31, 0x31, 0x38, 0x2D, 0x67, 0x7A, 0x22, 0x0D, 0x0A, 0x43, 0x61, 0x63, 0x68, 0x65,
+    0x2D, 0x43, 0x6F, 0x6E, 0x74, 0x72, 0x6F, 0x6C, 0x3A, 0x20, 0x6D, 0x61, 0x78, 0x2D, 0x61, 0x67,
+    0x65, 0x3D, 0x38, 0x36, 0x34, 0x30, 0x30, 0x0D, 0x0A, 0x56, 0x61, 0x72, 0x79, 0x3A, 0x20, 0x41,
+    0x63, 0x63, 0x65, 0x70, 0x74, 0x2D, 0x45, 0x6E, 0x63, 0x6F, 0x64, 0x69, 0x6E, 0x67, 0x0D, 0x0A,
+    0x0D, 0x0A, 0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xB5, 0x53, 0xDB, 0x6E,
+    0xA3, 0x30, 0x10, 0x7D, 0xCF, 0x57, 0x58, 0xAA, 0xA2, 0x26, 0x52, 0x5C, 0x91, 0x25, 0xAD, 0x76,
+    0xC9, 0x53, 0x3F, 0x65, 0xC0, 0x63, 0x33, 0xBB, 0x06, 0x23, 0x7B, 0x48, 0x93, 0xAE, 0xF6, 0xDF,
+    0xD7, 0x06, 0x4A, 0x48, 0xB3, 0xFB, 0x58, 0x10, 0x16, 0x73, 0xF1, 0xE1, 0x9C, 0x33, 0xA6, 0x74,
+    0xEA, 0x22, 0x7E, 0xAF, 0x44, 0xBC, 0xB4, 0x6B, 0x59, 0x6A, 0x68, 0xC8, 0x5E, 0x0A, 0xF1, 0xEA,
+    0x09, 0xEC, 0x4E, 0x04, 0x68, 0x83, 0x0C, 0xE8, 0x49, 0x1F, 0x87, 0x9E, 0x06, 0xBC, 0xA1, 0xB6,
+    0x10, 0xD9, 0x18, 0x76, 0xA0, 0x14, 0xB5, 0x66, 0x8E, 0x15, 0x85, 0xCE, 0x42, 0xDC, 0xAE, 0x2D,
+    0x9E, 0xC7, 0xD4, 0xCF, 0x3E, 0x30, 0xE9, 0x8B, 0xAC, 0x22, 0x3A, 0xB6, 0x5C, 0x88, 0x2A, 0xAE,
+    0xE8, 0xC7, 0x22, 0x58, 0x32, 0xAD, 0x24, 0xC6, 0x26, 0xDC, 0x16, 0x6A, 0x24, 0x53, 0xC7, 0xE6,
+    0x7D, 0x96, 0x9D, 0xEA, 0x31, 0x55, 0x42, 0xF5, 0xCB, 0x78, 0xD7, 0xB7, 0x2A, 0x62, 0x59, 0xE7,
+    0x0B, 0xF1, 0xA0, 0x0F, 0xF1, 0xFE, 0x71, 0x5C, 0xFD, 0x59, 0x3D, 0x25, 0x78, 0xA0, 0x16, 0xFD,
+    0x24, 0x86, 0xF1, 0xCC, 0x72, 0x80, 0xBF, 0x05, 0xBE, 0xA2, 0xA4, 0xFD, 0x5A, 0x7F, 0xD2, 0xF1,
+    0x2D, 0xEB, 0x26, 0xDE, 0xA5, 0xF3, 0x0A, 0xBD, 0xF4, 0xA0, 0xA8, 0x0F, 0x89, 0xC8, 0xB5, 0x70,
+    0x96, 0xA1, 0x06, 0xE5, 0xDE, 0xA2, 0x6C, 0x71, 0xE8, 0xCE, 0xE2, 0x7B, 0x7C, 0xBC, 0x29, 0x61,
+    0x93, 0xED, 0x86, 0xFB, 0x69, 0xBF, 0x4D, 0x9C, 0xEA, 0xFD, 0xC4, 0xE5, 0x83, 0x6E, 0x9E, 0xE7,
+    0x03, 0x57, 0x03, 0xBD, 0xC1, 0xA9, 0xF6, 0x46, 0x8A, 0xEB, 0xF4, 0xDD, 0x19, 0xFF, 0x43, 0xFA,
+    0x22, 0xF5, 0x89, 0xCB, 0x73, 0xB6, 0xBE, 0x17, 0x13, 0x0D, 0xA0, 0x4A, 0x9A, 0xD4, 0x13, 0xE5,
+    0x6E, 0x1E, 0x0E, 0x15, 0xE8, 0xE7, 0x4C, 0x64, 0xEB, 0xD4, 0xBE, 0x4B, 0x5E, 0x1D, 0xF2, 0xFC,
+    0x25, 0x05, 0xC9, 0xD4, 0xF5, 0x76, 0x12, 0xEE, 0x02, 0x31, 0xB9, 0x68, 0x92, 0x47, 0x0B, 0x4C,
+    0x27, 0xBC, 0x9D, 0x73, 0xF2, 0x43, 0x40, 0xCF, 0xEE, 0x4A, 0xBC, 0x28, 0x51, 0x3B, 0x8F, 0xB3,
+    0xB6, 0x69, 0xAC, 0x8F, 0x8F, 0xC7, 0xA5, 0xA0, 0xFD, 0xCB, 0x9D, 0xA0, 0x45, 0xEA, 0xDF, 0x53,
+    0xF8, 0x9F, 0xCC, 0x2B, 0x49, 0x28, 0x83, 0xB3, 0x3D, 0x4F, 0x24, 0xD9, 0x75, 0x8B, 0x2E, 0x8B,
+    0x9A, 0x17, 0x21, 0xFB, 0x78, 0x74, 0x23, 0xD1, 0xA6, 0x18, 0x5F, 0xA3, 0x3A, 0xDC, 0xC8, 0xC1,
+    0x8B, 0xB4, 0x6E, 0x17, 0x82, 0x40, 0xF3, 0x7C, 0x6E, 0x66, 0x3D, 0xC0, 0xEC, 0x37, 0x0A, 0x18,
+    0xE4, 0x69, 0xF2, 0x6A, 0xF8, 0x3F, 0x02, 0xBD, 0x63, 0xB4, 0x05, 0x9B, 0xE3, 0xFD, 0x68, 0xBF,
+    0x94, 0xEB, 0x5F, 0x0B, 0x0C, 0x64, 0x2A, 0xA9, 0x03, 0x00, 0x00,
+};
+
+/* Exported variables --------------------------------------------------------*/
+const WebAsset web_assets[] = {
+    { "/app.js", "max-age=86400", "\"c65c0b09\"", "\"c65c0b09-gz\"", asset_app_js, 571, 149, asset_app_js_gz, 471, 176 },
+    { "/", "no-cache", "\"81c3eee9\"", "\"81c3eee9-gz\"", asset_index_html, 549, 146, asset_index_html_gz, 437, 173 },
+    { "/style.css", "max-age=86400", "\"036a4118\"", "\"036a4118-gz\"", asset_style_css, 1072, 135, asset_style_css_gz, 571, 162 },
+};
+
+const uint8_t web_asset_count = 3;
+
+/* Body bytes: 1762 identity, 968 gzip */
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
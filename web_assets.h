@@ -0,0 +1,49 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/web_assets.h
+ * @author  WIZnet
+ * @brief   Static web assets embedded in flash by tools/mkassets.py
+ ******************************************************************************
+ * @attention
+ *
+ * web_assets.c is generated from the files in www/ and must be regenerated
+ * whenever they change, as a pre-build step:
+ *
+ *   python3 tools/mkassets.py www web_assets.c
+ *
+ * Every reply is stored complete, status line and header included, so it
+ * can be sent straight from flash with one send(); a HEAD reply is its
+ * first hdr_len bytes.
+ *
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __WEB_ASSETS_H
+#define __WEB_ASSETS_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+    const char* path;
+    const char* cache_control;
+    const char* etag;               /* Quoted entity tag, identity encoding */
+    const char* etag_gzip;          /* Quoted entity tag, gzip encoding */
+    const uint8_t* resp;            /* Identity reply */
+    uint16_t resp_len;
+    uint16_t hdr_len;
+    const uint8_t* resp_gzip;       /* gzip reply, 0 if not worth it */
+    uint16_t resp_gzip_len;
+    uint16_t hdr_gzip_len;
+} WebAsset;
+
+/* Exported variables --------------------------------------------------------*/
+extern const WebAsset web_assets[];
+extern const uint8_t web_asset_count;
+
+#endif /* __WEB_ASSETS_H */
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
@@ -0,0 +1,178 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/web_render.c
+ * @author  WIZnet
+ * @brief   Single-pass rendering of the compiled reply templates
+ ******************************************************************************
+ * @attention
+ *
+ * A template is a table of static segments, each followed by a slot that
+ * takes one value of the caller's values array (see web_templates.h). A
+ * reply is rendered in one pass: the body length is the static length plus
+ * the digits of every slot, counted with a few compares, so the header is
+ * written with the exact Content-Length first and the body straight behind
+ * it, with no scratch buffer and no move.
+ *
+ * Numbers are converted by subtracting powers of ten, at most nine times a
+ * digit. The Cortex-M0 has no divide instruction, and this stays well below
+ * a library division per digit for the few-digit values of a reading.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "web_render.h"
+
+/* Private variables ---------------------------------------------------------*/
+static const uint32_t web_pow10[WEB_UTOA_MAX] = {
+    1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL, 100000000UL, 1000000000UL
+};
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Returns the number of decimal digits of a value.
+ * @param  value: Value.
+ * @retval 1 to WEB_UTOA_MAX.
+ */
+static uint8_t WebRender_Digits(uint32_t value)
+{
+    uint8_t n = 1;
+
+    while (n < WEB_UTOA_MAX && value >= web_pow10[n]) n++;
+    return n;
+}
+
+/**
+ * @brief  Returns the rendered length of a slot value.
+ * @param  fmt: WEB_FMT_* of the slot.
+ * @param  value: Value.
+ * @retval Length in bytes.
+ */
+static uint8_t WebRender_SlotLength(uint8_t fmt, uint32_t value)
+{
+    if (fmt == WEB_FMT_TENTHS) return (uint8_t) (WebRender_Digits(value) + (value < 10 ? 2 : 1));
+    return WebRender_Digits(value);
+}
+
+/**
+ * @brief  Renders a slot value.
+ * @param  fmt: WEB_FMT_* of the slot.
+ * @param  value: Value.
+ * @param  out: Output, WebRender_SlotLength() bytes.
+ * @retval Length in bytes.
+ */
+static uint8_t WebRender_Slot(uint8_t fmt, uint32_t value, char* out)
+{
+    uint8_t n = WebRender_Utoa(value, out);
+
+    if (fmt != WEB_FMT_TENTHS) return n;
+
+    /* Tenths: the point goes before the last digit, "0." before a lone one */
+    if (n == 1) {
+        out[1] = out[0];
+        out[0] = '0';
+        n = 2;
+    }
+    out[n] = out[n - 1];
+    out[n - 1] = '.';
+    return (uint8_t) (n + 1);
+}
+
+/**
+ * @brief  Converts a value to decimal, without a terminator.
+ * @param  value: Value.
+ * @param  out: Output, at least WEB_UTOA_MAX bytes.
+ * @retval Number of digits.
+ */
+uint8_t WebRender_Utoa(uint32_t value, char* out)
+{
+    uint8_t n = WebRender_Digits(value);
+    uint8_t i;
+    char d;
+
+    for (i = (uint8_t) (n - 1); i > 0; i--) {
+        d = '0';
+        while (value >= web_pow10[i]) {
+            value -= web_pow10[i];
+            d++;
+        }
+        *out++ = d;
+    }
+    *out = (char) ('0' + value);
+    return n;
+}
+
+/**
+ * @brief  Returns the length of a template's body for a set of values.
+ * @param  tmpl: Template.
+ * @param  values: Value of every slot, WEB_SLOT_NUM entries.
+ * @retval Length in bytes.
+ */
+uint16_t WebRender_BodyLength(const WebTemplate* tmpl, const uint32_t* values)
+{
+    const WebSegment* seg = tmpl->seg;
+    uint16_t len = tmpl->text_len;
+    uint8_t i;
+
+    for (i = 0; i < tmpl->seg_count; i++, seg++) {
+        if (seg->slot != WEB_SLOT_NONE) len += WebRender_SlotLength(seg->fmt, values[seg->slot]);
+    }
+    return len;
+}
+
+/**
+ * @brief  Renders a template's body.
+ * @param  tmpl: Template.
+ * @param  values: Value of every slot, WEB_SLOT_NUM entries.
+ * @param  out: Output, the template's WEB_TMPL_*_BODY_MAX bytes.
+ * @retval Length in bytes.
+ */
+uint16_t WebRender_Body(const WebTemplate* tmpl, const uint32_t* values, char* out)
+{
+    const WebSegment* seg = tmpl->seg;
+    char* p = out;
+    uint8_t i;
+
+    for (i = 0; i < tmpl->seg_count; i++, seg++) {
+        memcpy(p, seg->text, seg->len);
+        p += seg->len;
+        if (seg->slot != WEB_SLOT_NONE) p += WebRender_Slot(seg->fmt, values[seg->slot], p);
+    }
+    return (uint16_t) (p - out);
+}
+
+/**
+ * @brief  Renders a complete reply, header with the exact Content-Length
+ *         and body.
+ * @param  tmpl: Template.
+ * @param  values: Value of every slot, WEB_SLOT_NUM entries.
+ * @param  fields: Extra header fields, CRLF terminated, or 0.
+ * @param  out: Output, the template's WEB_TMPL_*_MAX bytes plus the length
+ *         of fields.
+ * @param  hdr_len: Receives the length of the header.
+ * @retval Length of the reply.
+ */
+uint16_t WebRender_Reply(const WebTemplate* tmpl, const uint32_t* values, const char* fields, char* out, uint16_t* hdr_len)
+{
+    uint16_t len = tmpl->head_len;
+    uint16_t n;
+
+    memcpy(out, tmpl->head, len);
+    if (fields != 0) {
+        n = (uint16_t) strlen(fields);
+        memcpy(out + len, fields, n);
+        len += n;
+    }
+    memcpy(out + len, "Content-Length: ", 16);
+    len += 16;
+    len += WebRender_Utoa(WebRender_BodyLength(tmpl, values), out + len);
+    memcpy(out + len, "\r\n\r\n", 4);
+    len += 4;
+    *hdr_len = len;
+
+    return (uint16_t) (len + WebRender_Body(tmpl, values, out + len));
+}
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
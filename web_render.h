@@ -0,0 +1,63 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/web_render.h
+ * @author  WIZnet
+ * @brief   Header for web_render.c module
+ ******************************************************************************
+ * @attention
+ *
+ * The templates are compiled by tools/mktemplates.py from templates/ into
+ * web_templates.c and web_templates.h, which must be regenerated whenever
+ * they change, as a pre-build step:
+ *
+ *   python3 tools/mktemplates.py templates .
+ *
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __WEB_RENDER_H
+#define __WEB_RENDER_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/* Slot of the last segment, which has none */
+#define WEB_SLOT_NONE   0xFF
+
+/* Slot formats */
+#define WEB_FMT_UINT    0       /* Unsigned decimal */
+#define WEB_FMT_TENTHS  1       /* Tenths as a decimal with one fraction digit */
+
+/* Longest decimal of a uint32_t */
+#define WEB_UTOA_MAX    10
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+    const char* text;           /* Static bytes before the slot */
+    uint16_t len;
+    uint8_t slot;               /* WEB_SLOT_*, WEB_SLOT_NONE on the last one */
+    uint8_t fmt;                /* WEB_FMT_* of the slot */
+} WebSegment;
+
+typedef struct
+{
+    const char* head;           /* Status line and header fields other than
+                                   Content-Length */
+    uint16_t head_len;
+    const WebSegment* seg;
+    uint8_t seg_count;
+    uint16_t text_len;          /* Static bytes of the body */
+} WebTemplate;
+
+/* Exported functions ------------------------------------------------------- */
+uint8_t WebRender_Utoa(uint32_t value, char* out);
+uint16_t WebRender_BodyLength(const WebTemplate* tmpl, const uint32_t* values);
+uint16_t WebRender_Body(const WebTemplate* tmpl, const uint32_t* values, char* out);
+uint16_t WebRender_Reply(const WebTemplate* tmpl, const uint32_t* values, const char* fields, char* out, uint16_t* hdr_len);
+
+#endif /* __WEB_RENDER_H */
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
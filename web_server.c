@@ -0,0 +1,1350 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/web_server.c
+ * @author  WIZnet
+ * @brief   HTTP server on a pool of W7500x hardware sockets
+ ******************************************************************************
+ * @attention
+ *
+ * Every socket of the pool listens on HTTP_PORT and runs its own copy of the
+ * WebServer() state machine with its own RX buffer slice. WebServer_Run()
+ * services the pool round-robin, starting one socket later on every pass,
+ * and each socket handles at most one RX buffer worth of data per pass, so
+ * a busy connection cannot starve the others.
+ *
+ * Endpoints:
+ *   /, /style.css, ...  Static assets embedded by tools/mkassets.py, sent
+ *                       gzip-compressed when the client accepts it
+ *   /gauge              The gauge page rendered with the latest reading, for
+ *                       clients without scripts
+ *   /api/moisture       JSON document of the latest sample snapshot
+ *   /api/moisture.bin   Fixed-layout binary record of the same snapshot
+ *   /api/calibration    JSON calibration points of every channel; POST
+ *                       ?ch=<n>&dry=<counts>&wet=<counts> or
+ *                       ?ch=<n>&points=<counts>:<0.1 %>,... sets them
+ *   /events             Server-Sent Events stream of new readings; the
+ *                       socket stays with the client until it disconnects
+ *   /history            Stored readings as CSV, /history.bin as a binary
+ *                       record; ?tier=raw|minute|hour&since=<entry>
+ *   /metrics            Counters and hot path timings in the Prometheus
+ *                       text format, unless METRICS_ENABLE is 0
+ *
+ * The sockets are non-blocking and no reply waits for the chip. A constant
+ * reply, such as an embedded asset, is queued on its connection and handed
+ * over in as many SEND commands as the TX free size allows; a long document
+ * follows a piece of HTTP_TX_BUF_SIZE at a time whenever a whole piece
+ * fits. A short generated reply goes out whole or is rendered again on a
+ * later pass. The next request of a connection is not answered before its
+ * reply is out.
+ *
+ * The readings carry a weak ETag built from the filtered counts of every
+ * channel and the calibration. The counts in the tag only follow a channel
+ * once it has moved by more than HTTP_ETAG_DEADBAND, so a poll with
+ * If-None-Match is answered with a bodiless 304 while the reading only
+ * shows noise, even though every sample has a new sequence number.
+ *
+ * A reply waiting for the SEND in progress unmasks SENDOK, which resumes it.
+ * With none in progress the TX buffer is full, and the sample tick retries
+ * until the client makes room or HTTP_SEND_TIMEOUT_MS have passed without
+ * it taking any data, when the connection is dropped.
+ *
+ * Every request is admitted before anything is sampled or rendered for
+ * it. Each client address, as read from the socket on connect, has a
+ * token bucket refilled at HTTP_ADMIT_RATE requests per second up to
+ * HTTP_ADMIT_BURST, and a request is only answered while the other
+ * sockets have fewer than HTTP_INFLIGHT_MAX replies going out. A request
+ * turned away gets a constant 503 with Retry-After and its connection is
+ * closed, which frees the socket for other clients. Event streams are
+ * paced by the sample rate and do not count as replies in flight.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "wizchip_conf.h"
+#include "socket.h"
+#include "web_server.h"
+#include "adc_sampler.h"
+#include "moisture.h"
+#include "http_parser.h"
+#include "tick.h"
+#include "web_assets.h"
+#include "web_templates.h"
+#include "history.h"
+#include "flash_store.h"
+#include "arena.h"
+#include "event_loop.h"
+#include "metrics.h"
+#include "log.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Token bucket of one client address */
+typedef struct
+{
+    uint8_t ip[4];
+    uint32_t tokens;                        /* Thousandths of a request */
+    uint32_t last;                          /* Tick of the last refill */
+} HTTP_Client;
+
+/* Read position in a document sent piecewise */
+typedef union
+{
+    History_Cursor history;
+    Metrics_Cursor metrics;
+} HTTP_DocCursor;
+
+typedef struct
+{
+    uint8_t* rx_buf;                        /* HTTP_RX_BUF_SIZE bytes of the arena */
+    uint16_t rx_len;
+    HTTP_Request req;
+    uint8_t peer_ip[4];
+    uint16_t peer_port;
+    uint8_t client;                         /* Bucket of the peer address */
+    uint8_t admitted;                       /* Current request was admitted */
+    uint32_t last_active;
+    uint32_t requests;
+    uint8_t backlog;                        /* Requests left for next pass */
+    uint8_t stream;                         /* Socket serves /events */
+    uint32_t stream_seq;                    /* Last snapshot looked at */
+    uint16_t stream_value[SAMPLER_CH_NUM];  /* Last values pushed */
+    const uint8_t* tx_data;                 /* Queued reply bytes not sent yet */
+    uint16_t tx_len;
+    uint8_t tx_doc;                         /* HTTP_DOC_* sent after tx_data */
+    HTTP_DocCursor tx_cur;
+    uint8_t tx_close;                       /* Disconnect once the reply is out */
+    uint8_t tx_wait;                        /* Output waits for the chip */
+    uint32_t tx_last;                       /* Tick the chip last took data */
+} HTTP_Conn;
+
+/* Private define ------------------------------------------------------------*/
+#define HTTP_RESP_HDR_SIZE 128
+#define HTTP_API_RECORD_VERSION 2
+#define HTTP_API_RECORD_SIZE (12 + 4 * SAMPLER_CH_NUM)
+
+/* Documents sent piecewise behind their header */
+#define HTTP_DOC_NONE    0
+#define HTTP_DOC_HISTORY 1
+#define HTTP_DOC_METRICS 2
+
+/* Admission of a request */
+#define HTTP_ADMIT_OK      0
+#define HTTP_ADMIT_SHED    1                /* Too many replies in flight */
+#define HTTP_ADMIT_LIMITED 2                /* Client over its rate */
+
+/* A bucket idle for this long is full again */
+#define HTTP_ADMIT_FULL_MS ((uint32_t) HTTP_ADMIT_BURST * 1000 / HTTP_ADMIT_RATE)
+
+/* /api/calibration: at most 12 bytes a point, "[4095,1000]," */
+#define HTTP_CAL_BODY_SIZE (20 + SAMPLER_CH_NUM * (3 + 12 * MOISTURE_CAL_POINTS_MAX))
+
+/* Weak ETag of the readings, W/"<counts>-<cal>": 3 hex digits of counts
+ * per channel and the calibration identifier. The length is that of the
+ * quoted tag. */
+#define HTTP_ETAG_LEN (1 + 3 * SAMPLER_CH_NUM + 1 + 4 + 1)
+#define HTTP_ETAG_FIELD_SIZE (8 + HTTP_ETAG_LEN + 2 + 1)
+
+/* Event of the stream: "id: <seq>\ndata: <JSON>\n\n" */
+#define HTTP_SSE_EVENT_MAX (4 + WEB_UTOA_MAX + 7 + WEB_TMPL_MOISTURE_BODY_MAX + 2)
+
+#if HTTP_TX_BUF_SIZE < (WEB_TMPL_MOISTURE_MAX + HTTP_ETAG_FIELD_SIZE) || HTTP_TX_BUF_SIZE < (HTTP_RESP_HDR_SIZE + HTTP_CAL_BODY_SIZE)
+#error "HTTP_TX_BUF_SIZE too small for the /api replies"
+#endif
+#if HTTP_TX_BUF_SIZE < (WEB_TMPL_GAUGE_MAX + HTTP_ETAG_FIELD_SIZE) || HTTP_TX_BUF_SIZE < HTTP_SSE_EVENT_MAX
+#error "HTTP_TX_BUF_SIZE too small for the rendered pages"
+#endif
+#if SAMPLER_CH_NUM > 4
+#error "The templates have slots for 4 channels"
+#endif
+#if (MOISTURE_CAL_POINTS_MAX * 4) > STORE_DATA_MAX
+#error "A calibration does not fit in a store record"
+#endif
+
+#if HTTP_ADMIT_RATE && (HTTP_ADMIT_BURST < 1 || HTTP_ADMIT_CLIENTS < 1)
+#error "HTTP_ADMIT_BURST and HTTP_ADMIT_CLIENTS must be at least 1"
+#endif
+
+#if (HTTP_SOCK_START + HTTP_SOCK_COUNT) > _WIZCHIP_SOCK_NUM_
+#error "HTTP socket pool exceeds the number of hardware sockets"
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define HTTP_STR_(x) #x
+#define HTTP_STR(x) HTTP_STR_(x)
+
+/* Private variables ---------------------------------------------------------*/
+static HTTP_Conn http_conn[HTTP_SOCK_COUNT];
+static uint8_t http_rr_start = 0;
+static HTTP_Client http_client[HTTP_ADMIT_CLIENTS];
+
+/* Reply buffer of the /api endpoints, rendered per request from the latest
+ * sample snapshot, and of the other generated replies; HTTP_TX_BUF_SIZE
+ * bytes of the arena */
+static uint8_t* const http_api_buf = arena.http_tx;
+
+/* Counts and calibration the ETag of the readings stands for, the quoted
+ * tag without "W/" as HTTP_ETagMatch() takes it, and the header field */
+static uint16_t http_etag_counts[SAMPLER_CH_NUM];
+static uint16_t http_etag_cal;
+static uint8_t http_etag_set;
+static char http_etag[HTTP_ETAG_LEN + 1];
+static char http_etag_field[HTTP_ETAG_FIELD_SIZE];
+
+/* Fails to compile if HTTP_RAM_SIZE no longer covers the state above */
+typedef char http_ram_check[(sizeof(http_conn) + sizeof(http_rr_start) + sizeof(http_client) + sizeof(http_etag_counts)
+        + sizeof(http_etag_cal) + sizeof(http_etag_set) + sizeof(http_etag) + sizeof(http_etag_field) <= HTTP_RAM_SIZE) ? 1 : -1];
+
+static const char http_resp_400[] = "HTTP/1.1 400 Bad Request\r\n"
+        "Connection: close\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n";
+
+/* Well-formed request with unusable parameters; the connection stays */
+static const char http_resp_400_param[] = "HTTP/1.1 400 Bad Request\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n";
+
+static const char http_resp_404[] = "HTTP/1.1 404 Not Found\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n";
+
+static const char http_resp_405[] = "HTTP/1.1 405 Method Not Allowed\r\n"
+        "Allow: GET, HEAD\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n";
+
+static const char http_resp_431[] = "HTTP/1.1 431 Request Header Fields Too Large\r\n"
+        "Connection: close\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n";
+
+/* Request turned away by admission control */
+static const char http_resp_503[] = "HTTP/1.1 503 Service Unavailable\r\n"
+        "Retry-After: " HTTP_STR(HTTP_RETRY_AFTER_S) "\r\n"
+        "Connection: close\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n";
+
+static const char http_sse_hdr[] = "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/event-stream\r\n"
+        "Cache-Control: no-cache\r\n"
+        "\r\n";
+
+/* Private function prototypes -----------------------------------------------*/
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Initializes the HTTP socket pool.
+ * @param  None
+ * @retval None
+ */
+void WebServer_Init(void)
+{
+    uint8_t i;
+
+    memset(http_conn, 0, sizeof(http_conn));
+    for (i = 0; i < HTTP_SOCK_COUNT; i++) {
+        http_conn[i].rx_buf = arena.http_rx[i];
+    }
+    memset(http_client, 0, sizeof(http_client));
+    http_rr_start = 0;
+}
+
+/**
+ * @brief  Services every socket of the HTTP pool once.
+ * @note   Called from the main loop on socket events of the pool and on
+ *         every sample, which paces the streams, idle timeouts and replies
+ *         waiting for a full TX buffer. A socket with work left that no
+ *         interrupt will announce, unread data, pipelined requests or a
+ *         state to move on from, is posted again; one whose reply waits for
+ *         the SEND in progress gets its SENDOK interrupt instead.
+ * @param  None
+ * @retval None
+ */
+void WebServer_Run(void)
+{
+    HTTP_Conn* conn;
+    uint8_t i;
+    uint8_t idx;
+    uint8_t sn;
+    uint8_t sr;
+
+    for (i = 0; i < HTTP_SOCK_COUNT; i++) {
+        idx = (uint8_t) ((http_rr_start + i) % HTTP_SOCK_COUNT);
+        sn = HTTP_SOCK_START + idx;
+        conn = &http_conn[idx];
+        WebServer(sn, conn->rx_buf, HTTP_PORT);
+
+        sr = getSn_SR(sn);
+        if (conn->tx_wait && (sr == SOCK_ESTABLISHED || sr == SOCK_CLOSE_WAIT)) {
+            /* SENDOK still set means no SEND is in progress */
+            if (getSn_IR(sn) & Sn_IR_SENDOK) setSn_IMR(sn, (uint8_t) (getSn_IMR(sn) & ~Sn_IR_SENDOK));
+            else setSn_IMR(sn, (uint8_t) (getSn_IMR(sn) | Sn_IR_SENDOK));
+            continue;
+        }
+
+        setSn_IMR(sn, (uint8_t) (getSn_IMR(sn) & ~Sn_IR_SENDOK));
+        if (sr == SOCK_CLOSED || sr == SOCK_INIT || sr == SOCK_CLOSE_WAIT || conn->backlog
+                || (sr == SOCK_ESTABLISHED && getSn_RX_RSR(sn) > 0)) {
+            Event_Post(EVENT_SOCKET(sn));
+        }
+    }
+
+    if (++http_rr_start >= HTTP_SOCK_COUNT) http_rr_start = 0;
+}
+
+/**
+ * @brief  Puts the status line and header in front of a rendered body.
+ * @note   The body is rendered behind a reserved header area first so that
+ *         the header can carry the exact Content-Length, then moved up to
+ *         follow the header. Replies carry no Connection header: HTTP/1.1
+ *         clients keep the connection, HTTP/1.0 clients close it.
+ * @param  out: Reply buffer, the body starts at out + HTTP_RESP_HDR_SIZE.
+ * @param  fields: Header fields other than Content-Length, CRLF terminated.
+ * @param  extra: More header fields, CRLF terminated, or "".
+ * @param  body_len: Length of the body.
+ * @param  hdr_len: Receives the length of the header.
+ * @retval Length of the reply, 0 if the header did not fit.
+ */
+static uint16_t WebServer_Frame(uint8_t* out, const char* fields, const char* extra, uint16_t body_len, uint16_t* hdr_len)
+{
+    int len;
+
+    len = snprintf((char*) out, HTTP_RESP_HDR_SIZE, "HTTP/1.1 200 OK\r\n"
+            "%s%s"
+            "Content-Length: %u\r\n"
+            "\r\n", fields, extra, (unsigned) body_len);
+    if (len < 0 || len >= HTTP_RESP_HDR_SIZE) return 0;
+
+    memmove(out + len, out + HTTP_RESP_HDR_SIZE, body_len);
+    *hdr_len = (uint16_t) len;
+
+    return (uint16_t) (len + body_len);
+}
+
+/**
+ * @brief  Fills the template slots from a snapshot.
+ * @param  snap: Sample snapshot.
+ * @param  values: Receives the value of every slot, WEB_SLOT_NUM entries.
+ * @retval None
+ */
+static void WebServer_Values(const Sampler_Snapshot* snap, uint32_t* values)
+{
+    uint8_t ch;
+
+    memset(values, 0, WEB_SLOT_NUM * sizeof(*values));
+    for (ch = 0; ch < SAMPLER_CH_NUM; ch++) {
+        values[WEB_SLOT_MOISTURE0 + ch] = snap->moisture[ch];
+        values[WEB_SLOT_CHANNEL0 + ch] = snap->value[ch];
+    }
+    values[WEB_SLOT_READING] = snap->moisture[0];
+    values[WEB_SLOT_GAUGE_PCT] = (snap->moisture[0] + 5) / 10;
+    values[WEB_SLOT_TS] = snap->tick;
+    values[WEB_SLOT_SEQ] = snap->seq;
+}
+
+/**
+ * @brief  Checks a request for the readings against their ETag.
+ * @note   The tag first moves to the snapshot's counts if any channel is
+ *         more than HTTP_ETAG_DEADBAND away from those it stands for, or
+ *         if the calibration has changed.
+ * @param  req: Parsed request.
+ * @param  snap: Sample snapshot.
+ * @retval 1 if the client holds the current tag, 0 otherwise.
+ */
+static uint8_t WebServer_Unchanged(const HTTP_Request* req, const Sampler_Snapshot* snap)
+{
+    static const char hex[] = "0123456789abcdef";
+    uint16_t cal = Moisture_GetCalibrationId();
+    uint8_t moved = !http_etag_set || cal != http_etag_cal;
+    char* p;
+    uint8_t ch;
+
+    for (ch = 0; ch < SAMPLER_CH_NUM && !moved; ch++) {
+        if (snap->value[ch] > http_etag_counts[ch] + HTTP_ETAG_DEADBAND
+                || snap->value[ch] + HTTP_ETAG_DEADBAND < http_etag_counts[ch]) {
+            moved = 1;
+        }
+    }
+
+    if (moved) {
+        memcpy(http_etag_counts, snap->value, sizeof(http_etag_counts));
+        http_etag_cal = cal;
+        http_etag_set = 1;
+
+        p = http_etag;
+        *p++ = '"';
+        for (ch = 0; ch < SAMPLER_CH_NUM; ch++) {
+            *p++ = hex[(snap->value[ch] >> 8) & 0x0F];
+            *p++ = hex[(snap->value[ch] >> 4) & 0x0F];
+            *p++ = hex[snap->value[ch] & 0x0F];
+        }
+        *p++ = '-';
+        *p++ = hex[cal >> 12];
+        *p++ = hex[(cal >> 8) & 0x0F];
+        *p++ = hex[(cal >> 4) & 0x0F];
+        *p++ = hex[cal & 0x0F];
+        *p++ = '"';
+        *p = '\0';
+        snprintf(http_etag_field, sizeof(http_etag_field), "ETag: W/%s\r\n", http_etag);
+    }
+
+    return (req->flags & HTTP_REQ_INM) && HTTP_ETagMatch(req, http_etag);
+}
+
+/**
+ * @brief  Renders the /api/moisture.bin reply for a snapshot.
+ * @note   The record is HTTP_API_RECORD_SIZE bytes, all fields little-endian:
+ *         "SM", version, channel count, uint32 seq, uint32 tick [ms],
+ *         uint16 filtered ADC counts of every channel, then uint16
+ *         moisture of every channel in tenths of a percent.
+ * @param  snap: Sample snapshot.
+ * @param  hdr_len: Receives the length of the header.
+ * @retval Length of the reply in http_api_buf, 0 if it did not fit.
+ */
+static uint16_t WebServer_RenderRecord(const Sampler_Snapshot* snap, uint16_t* hdr_len)
+{
+    uint8_t* p = http_api_buf + HTTP_RESP_HDR_SIZE;
+    uint8_t ch;
+
+    *p++ = 'S';
+    *p++ = 'M';
+    *p++ = HTTP_API_RECORD_VERSION;
+    *p++ = SAMPLER_CH_NUM;
+    *p++ = (uint8_t) snap->seq;
+    *p++ = (uint8_t) (snap->seq >> 8);
+    *p++ = (uint8_t) (snap->seq >> 16);
+    *p++ = (uint8_t) (snap->seq >> 24);
+    *p++ = (uint8_t) snap->tick;
+    *p++ = (uint8_t) (snap->tick >> 8);
+    *p++ = (uint8_t) (snap->tick >> 16);
+    *p++ = (uint8_t) (snap->tick >> 24);
+    for (ch = 0; ch < SAMPLER_CH_NUM; ch++) {
+        *p++ = (uint8_t) snap->value[ch];
+        *p++ = (uint8_t) (snap->value[ch] >> 8);
+    }
+    for (ch = 0; ch < SAMPLER_CH_NUM; ch++) {
+        *p++ = (uint8_t) snap->moisture[ch];
+        *p++ = (uint8_t) (snap->moisture[ch] >> 8);
+    }
+
+    return WebServer_Frame(http_api_buf, "Content-Type: application/octet-stream\r\n"
+            "Cache-Control: no-cache\r\n", http_etag_field, HTTP_API_RECORD_SIZE, hdr_len);
+}
+
+/**
+ * @brief  Issues one SEND command.
+ * @note   The socket is non-blocking: SOCK_BUSY is returned while the SEND
+ *         before is in progress or if the data does not fit in the TX free
+ *         size.
+ * @param  sn: Socket number to use.
+ * @param  conn: Connection state of the socket.
+ * @param  data: Data to send.
+ * @param  len: Length of data.
+ * @retval Number of bytes sent, SOCK_BUSY, or a negative socket error.
+ */
+static int32_t WebServer_Send(uint8_t sn, HTTP_Conn* conn, const uint8_t* data, uint16_t len)
+{
+    METRICS_TIMER(t);
+    int32_t ret;
+
+    METRICS_START(t);
+    ret = send(sn, (uint8_t*) data, len);
+    METRICS_STOP(METRICS_PHASE_SEND, t);
+    if (ret < 0) {
+        METRICS_ADD(METRICS_SEND_ERRORS, 1);
+        close(sn);
+        return ret;
+    }
+
+    if (ret > 0) {
+        METRICS_ADD(METRICS_BYTES_OUT, ret);
+        conn->tx_last = Tick_GetMs();
+    }
+    return ret;
+}
+
+/**
+ * @brief  Sends a reply rendered into http_api_buf.
+ * @note   The reply goes out whole or not at all, since the next request on
+ *         any socket renders over it; a busy reply is rendered again on a
+ *         later pass.
+ * @param  sn: Socket number to use.
+ * @param  conn: Connection state of the socket.
+ * @param  len: Length of the reply.
+ * @retval Length of the reply, SOCK_BUSY, or a negative socket error.
+ */
+static int32_t WebServer_Reply(uint8_t sn, HTTP_Conn* conn, uint16_t len)
+{
+    int32_t ret = SOCK_BUSY;
+
+    if (getSn_TX_FSR(sn) >= len) ret = WebServer_Send(sn, conn, http_api_buf, len);
+    if (ret == SOCK_BUSY) conn->tx_wait = 1;
+
+    return ret;
+}
+
+/**
+ * @brief  Queues a constant reply on a connection with no output queued.
+ * @note   WebServer_Flush() sends it.
+ * @param  conn: Connection state of the socket.
+ * @param  data: Reply, which must stay in place until it is sent.
+ * @param  len: Length of the reply.
+ * @retval Length of the reply.
+ */
+static int32_t WebServer_Queue(HTTP_Conn* conn, const void* data, uint16_t len)
+{
+    conn->tx_data = (const uint8_t*) data;
+    conn->tx_len = len;
+
+    return len;
+}
+
+/**
+ * @brief  Renders the next piece of the document a connection sends.
+ * @param  sn: Socket number to use.
+ * @param  conn: Connection state of the socket.
+ * @param  out: Output buffer of HTTP_TX_BUF_SIZE bytes.
+ * @retval Length of the piece, 0 at the end of the document, or
+ *         SOCKERR_DATALEN if it cannot be completed.
+ */
+static int32_t WebServer_DocRead(uint8_t sn, HTTP_Conn* conn, uint8_t* out)
+{
+    History_Cursor* cur = &conn->tx_cur.history;
+    uint16_t len;
+
+#if METRICS_ENABLE
+    if (conn->tx_doc == HTTP_DOC_METRICS) return Metrics_Read(&conn->tx_cur.metrics, out, HTTP_TX_BUF_SIZE);
+#endif
+    if (conn->tx_doc != HTTP_DOC_HISTORY) return 0;
+
+    len = History_Read(cur, out, HTTP_TX_BUF_SIZE);
+    if (len == 0 && cur->index < cur->end) {
+        LOG_WARN("%d:History overwritten while sent, reply cut short", sn);
+        return SOCKERR_DATALEN;
+    }
+    return len;
+}
+
+/**
+ * @brief  Hands as much of a connection's output to the chip as it takes.
+ * @note   Queued bytes go out as far as the TX free size allows, the
+ *         document behind them a whole piece at a time. What is left is
+ *         sent on a later pass.
+ * @param  sn: Socket number to use.
+ * @param  conn: Connection state of the socket.
+ * @retval 1 if all output is sent, 0 if some is left, or a negative socket
+ *         error.
+ */
+static int32_t WebServer_Flush(uint8_t sn, HTTP_Conn* conn)
+{
+    HTTP_DocCursor cur;
+    uint16_t room;
+    int32_t ret;
+
+    while (conn->tx_len > 0 || conn->tx_doc != HTTP_DOC_NONE) {
+        room = getSn_TX_FSR(sn);
+
+        if (conn->tx_len > 0) {
+            if (room == 0) break;
+            if ((ret = WebServer_Send(sn, conn, conn->tx_data, (conn->tx_len < room) ? conn->tx_len : room)) < 0) return ret;
+            if (ret == SOCK_BUSY) break;
+            conn->tx_data += ret;
+            conn->tx_len -= (uint16_t) ret;
+            continue;
+        }
+
+        if (room < HTTP_TX_BUF_SIZE) break;
+
+        cur = conn->tx_cur;
+        if ((ret = WebServer_DocRead(sn, conn, http_api_buf)) <= 0) {
+            if (ret < 0) {
+                close(sn);
+                return ret;
+            }
+            conn->tx_doc = HTTP_DOC_NONE;
+            break;
+        }
+        if ((ret = WebServer_Send(sn, conn, http_api_buf, (uint16_t) ret)) < 0) return ret;
+        if (ret == SOCK_BUSY) {
+            /* Rendered again on the next try */
+            conn->tx_cur = cur;
+            break;
+        }
+    }
+
+    if (conn->tx_len > 0 || conn->tx_doc != HTTP_DOC_NONE) {
+        conn->tx_wait = 1;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief  Drops the output of a connection.
+ * @param  conn: Connection state of the socket.
+ * @retval None
+ */
+static void WebServer_ResetOutput(HTTP_Conn* conn)
+{
+    conn->tx_len = 0;
+    conn->tx_doc = HTTP_DOC_NONE;
+    conn->tx_close = 0;
+    conn->tx_wait = 0;
+}
+
+/**
+ * @brief  Resets the state a connection keeps between requests, including
+ *         the event stream of an /events client.
+ * @note   Run when the socket is reopened and again when a client connects.
+ * @param  conn: Connection state of the socket.
+ * @retval None
+ */
+static void WebServer_ResetConn(HTTP_Conn* conn)
+{
+    memset(conn->peer_ip, 0, sizeof(conn->peer_ip));
+    conn->peer_port = 0;
+    conn->rx_len = 0;
+    conn->requests = 0;
+    conn->admitted = 0;
+    conn->backlog = 0;
+    conn->stream = 0;
+    conn->stream_seq = 0;
+    memset(conn->stream_value, 0, sizeof(conn->stream_value));
+    conn->last_active = Tick_GetMs();
+    HTTP_ParserInit(&conn->req);
+    WebServer_ResetOutput(conn);
+}
+
+/**
+ * @brief  Keeps track of a reply waiting for the chip.
+ * @note   The connection is dropped once the client has taken no data for
+ *         HTTP_SEND_TIMEOUT_MS.
+ * @param  sn: Socket number to use.
+ * @param  conn: Connection state of the socket.
+ * @param  waited: The reply was waiting on the pass before already.
+ * @retval None
+ */
+static void WebServer_Wait(uint8_t sn, HTTP_Conn* conn, uint8_t waited)
+{
+    uint32_t now = Tick_GetMs();
+
+    if (!waited) {
+        conn->tx_last = now;
+        METRICS_ADD(METRICS_SEND_WAITS, 1);
+        return;
+    }
+
+    if (TICK_REACHED(now, conn->tx_last + HTTP_SEND_TIMEOUT_MS)) {
+        LOG_WARN("%d:Send timeout", sn);
+        METRICS_ADD(METRICS_SEND_TIMEOUTS, 1);
+        close(sn);
+        WebServer_ResetOutput(conn);
+    }
+}
+
+/**
+ * @brief  Closes a connection gracefully.
+ * @note   The socket is non-blocking, so the close completes after the
+ *         call; SOCK_BUSY is returned meanwhile.
+ * @param  sn: Socket number to use.
+ * @retval SOCK_OK, SOCK_BUSY, or a negative socket error.
+ */
+static int8_t WebServer_Disconnect(uint8_t sn)
+{
+    METRICS_TIMER(t);
+    int8_t ret;
+
+    METRICS_START(t);
+    ret = disconnect(sn);
+    METRICS_STOP(METRICS_PHASE_DISCONNECT, t);
+
+    return ret;
+}
+
+/**
+ * @brief  Looks up the embedded asset served at the request path.
+ * @param  req: Parsed request.
+ * @param  buf: RX buffer holding the request.
+ * @retval The asset, or 0 if there is none.
+ */
+static const WebAsset* WebServer_FindAsset(const HTTP_Request* req, const uint8_t* buf)
+{
+    uint8_t i;
+
+    for (i = 0; i < web_asset_count; i++) {
+        if (HTTP_PathIs(req, buf, web_assets[i].path)) return &web_assets[i];
+    }
+    return 0;
+}
+
+/**
+ * @brief  Answers a request for the readings with 304 Not Modified.
+ * @param  sn: Socket number to use.
+ * @param  conn: Connection the request was received on.
+ * @retval Length of the reply, SOCK_BUSY, or a negative socket error.
+ */
+static int32_t WebServer_NotModified(uint8_t sn, HTTP_Conn* conn)
+{
+    int len;
+
+    len = snprintf((char*) http_api_buf, HTTP_TX_BUF_SIZE, "HTTP/1.1 304 Not Modified\r\n"
+            "%s"
+            "Cache-Control: no-cache\r\n"
+            "\r\n", http_etag_field);
+    METRICS_ADD(METRICS_NOT_MODIFIED, 1);
+    return WebServer_Reply(sn, conn, (uint16_t) len);
+}
+
+/**
+ * @brief  Answers a request for an embedded asset.
+ * @note   The gzip reply is sent when the client accepts it, the identity
+ *         reply otherwise. A matching If-None-Match gets a 304.
+ * @param  sn: Socket number to use.
+ * @param  conn: Connection the request was received on.
+ * @param  asset: Requested asset.
+ * @retval Length of the reply, SOCK_BUSY, or a negative socket error.
+ */
+static int32_t WebServer_SendAsset(uint8_t sn, HTTP_Conn* conn, const WebAsset* asset)
+{
+    const HTTP_Request* req = &conn->req;
+    uint8_t gzip = asset->resp_gzip && (req->flags & HTTP_REQ_GZIP);
+    const char* etag = gzip ? asset->etag_gzip : asset->etag;
+    int len;
+
+    if ((req->flags & HTTP_REQ_INM) && HTTP_ETagMatch(req, etag)) {
+        len = snprintf((char*) http_api_buf, HTTP_TX_BUF_SIZE, "HTTP/1.1 304 Not Modified\r\n"
+                "ETag: %s\r\n"
+                "Cache-Control: %s\r\n"
+                "Vary: Accept-Encoding\r\n"
+                "\r\n", etag, asset->cache_control);
+        METRICS_ADD(METRICS_NOT_MODIFIED, 1);
+        return WebServer_Reply(sn, conn, (uint16_t) len);
+    }
+
+    if (gzip) {
+        return WebServer_Queue(conn, asset->resp_gzip, (req->method == HTTP_METHOD_HEAD) ? asset->hdr_gzip_len : asset->resp_gzip_len);
+    }
+    return WebServer_Queue(conn, asset->resp, (req->method == HTTP_METHOD_HEAD) ? asset->hdr_len : asset->resp_len);
+}
+
+/**
+ * @brief  Answers a /history or /history.bin request.
+ * @note   The document can be larger than the reply buffer, so its length
+ *         is computed first and it is rendered and sent piecewise. The
+ *         X-History-Next header carries the since= value of the next read.
+ * @param  sn: Socket number to use.
+ * @param  conn: Connection the request was received on.
+ * @param  fmt: HISTORY_FMT_CSV or HISTORY_FMT_BIN.
+ * @retval Length of the first piece, SOCK_BUSY, or a negative socket error.
+ */
+static int32_t WebServer_SendHistory(uint8_t sn, HTTP_Conn* conn, uint8_t fmt)
+{
+    HTTP_Request* req = &conn->req;
+    History_Cursor* cur = &conn->tx_cur.history;
+    const uint8_t* v;
+    int16_t vlen;
+    uint8_t tier = HISTORY_TIER_RAW;
+    uint32_t since = 0;
+    int32_t ret;
+    uint16_t len;
+    int n;
+
+    if ((vlen = HTTP_QueryParam(req, conn->rx_buf, "tier", &v)) >= 0) {
+        if (vlen == 6 && memcmp(v, "minute", 6) == 0) tier = HISTORY_TIER_MINUTE;
+        else if (vlen == 4 && memcmp(v, "hour", 4) == 0) tier = HISTORY_TIER_HOUR;
+        else if (vlen != 3 || memcmp(v, "raw", 3) != 0) vlen = -2;
+    }
+    if (vlen == -2 || HTTP_QueryUint(req, conn->rx_buf, "since", &since) < 0) {
+        return WebServer_Queue(conn, http_resp_400_param, sizeof(http_resp_400_param) - 1);
+    }
+
+    History_Open(cur, tier, fmt, since);
+
+    n = snprintf((char*) http_api_buf, HTTP_RESP_HDR_SIZE, "HTTP/1.1 200 OK\r\n"
+            "Content-Type: %s\r\n"
+            "Cache-Control: no-cache\r\n"
+            "X-History-Next: %lu\r\n"
+            "Content-Length: %lu\r\n"
+            "\r\n", fmt == HISTORY_FMT_BIN ? "application/octet-stream" : "text/csv",
+            (unsigned long) cur->end, (unsigned long) History_Length(cur));
+    if (n < 0 || n >= HTTP_RESP_HDR_SIZE) return SOCKERR_DATALEN;
+
+    len = (uint16_t) n;
+    if (req->method == HTTP_METHOD_HEAD) return WebServer_Reply(sn, conn, len);
+
+    /* The header goes out with the first piece of the document, the rest
+     * from WebServer_Flush() */
+    len += History_Read(cur, http_api_buf + len, HTTP_TX_BUF_SIZE - len);
+    if ((ret = WebServer_Reply(sn, conn, len)) > 0) conn->tx_doc = HTTP_DOC_HISTORY;
+
+    return ret;
+}
+
+/**
+ * @brief  Reads a calibration point list, "<counts>:<0.1 %>,...".
+ * @param  v: Value of the points parameter.
+ * @param  len: Length of the value.
+ * @param  points: Receives up to MOISTURE_CAL_POINTS_MAX points.
+ * @retval Number of points, 0 if the list is malformed.
+ */
+static uint8_t WebServer_ParsePoints(const uint8_t* v, int16_t len, Moisture_Point* points)
+{
+    const uint8_t* end = v + len;
+    uint32_t x;
+    uint8_t n = 0;
+    uint8_t field = 0;
+    uint8_t digits = 0;
+
+    for (x = 0; v <= end; v++) {
+        if (v < end && *v >= '0' && *v <= '9') {
+            x = x * 10 + (*v - '0');
+            if (x > 0xFFFF) return 0;
+            digits++;
+            continue;
+        }
+        if (digits == 0 || n == MOISTURE_CAL_POINTS_MAX) return 0;
+        if (field == 0) {
+            if (v == end || *v != ':') return 0;
+            points[n].counts = (uint16_t) x;
+        }
+        else {
+            if (v < end && *v != ',') return 0;
+            points[n++].moisture = (uint16_t) x;
+        }
+        field ^= 1;
+        digits = 0;
+        x = 0;
+    }
+    return n;
+}
+
+/**
+ * @brief  Answers an /api/calibration request.
+ * @note   A POST sets the calibration of channel ch, either two-point from
+ *         its dry and wet counts or from a list of points, then returns
+ *         the calibration like a GET.
+ * @param  sn: Socket number to use.
+ * @param  conn: Connection the request was received on.
+ * @retval Length of the reply, SOCK_BUSY, or a negative socket error.
+ */
+static int32_t WebServer_SendCalibration(uint8_t sn, HTTP_Conn* conn)
+{
+    HTTP_Request* req = &conn->req;
+    Moisture_Point points[MOISTURE_CAL_POINTS_MAX];
+    char* body = (char*) http_api_buf + HTTP_RESP_HDR_SIZE;
+    uint16_t len;
+    uint16_t hdr_len;
+    uint32_t ch = SAMPLER_CH_NUM;
+    uint32_t dry = 0;
+    uint32_t wet = 0;
+    const uint8_t* v;
+    int16_t vlen;
+    int8_t ret = -1;
+    uint8_t n;
+    uint8_t i;
+
+    if (req->method == HTTP_METHOD_POST) {
+        if (HTTP_QueryUint(req, conn->rx_buf, "ch", &ch) == 1) {
+            if ((vlen = HTTP_QueryParam(req, conn->rx_buf, "points", &v)) >= 0) {
+                n = WebServer_ParsePoints(v, vlen, points);
+                if (n > 0) ret = Moisture_SetCalibration((uint8_t) ch, points, n);
+            }
+            else if (HTTP_QueryUint(req, conn->rx_buf, "dry", &dry) == 1 && HTTP_QueryUint(req, conn->rx_buf, "wet", &wet) == 1
+                    && dry <= 4095 && wet <= 4095 && ch < SAMPLER_CH_NUM) {
+                ret = Moisture_SetDryWet((uint8_t) ch, (uint16_t) dry, (uint16_t) wet);
+            }
+        }
+        if (ret < 0) {
+            return WebServer_Queue(conn, http_resp_400_param, sizeof(http_resp_400_param) - 1);
+        }
+        LOG_INFO("Calibration of channel %lu set", (unsigned long) ch);
+        n = Moisture_GetCalibration((uint8_t) ch, points);
+        Store_Write(STORE_REC_CALIBRATION, (uint8_t) ch, points, (uint8_t) (n * sizeof(Moisture_Point)));
+    }
+
+    len = (uint16_t) sprintf(body, "{\"calibration\":[");
+    for (ch = 0; ch < SAMPLER_CH_NUM; ch++) {
+        n = Moisture_GetCalibration((uint8_t) ch, points);
+        len += (uint16_t) sprintf(body + len, "%s[", ch ? "," : "");
+        for (i = 0; i < n; i++) {
+            len += (uint16_t) sprintf(body + len, "%s[%u,%u]", i ? "," : "", points[i].counts, points[i].moisture);
+        }
+        body[len++] = ']';
+    }
+    len += (uint16_t) sprintf(body + len, "]}");
+
+    len = WebServer_Frame(http_api_buf, "Content-Type: application/json\r\n"
+            "Cache-Control: no-cache\r\n", "", len, &hdr_len);
+    if (len == 0) return SOCKERR_DATALEN;
+
+    return WebServer_Reply(sn, conn, (req->method == HTTP_METHOD_HEAD) ? hdr_len : len);
+}
+
+#if METRICS_ENABLE
+/**
+ * @brief  Answers a /metrics request.
+ * @note   The document is rendered from a snapshot, its length computed
+ *         first and it is sent piecewise like /history. There is one
+ *         snapshot, so a request waits while another connection is still
+ *         sending the document.
+ * @param  sn: Socket number to use.
+ * @param  conn: Connection the request was received on.
+ * @retval Length of the first piece, SOCK_BUSY, or a negative socket error.
+ */
+static int32_t WebServer_SendMetrics(uint8_t sn, HTTP_Conn* conn)
+{
+    Metrics_Cursor* cur = &conn->tx_cur.metrics;
+    int32_t ret;
+    uint16_t len;
+    uint8_t i;
+    int n;
+
+    for (i = 0; i < HTTP_SOCK_COUNT; i++) {
+        if (http_conn[i].tx_doc == HTTP_DOC_METRICS) {
+            conn->tx_wait = 1;
+            return SOCK_BUSY;
+        }
+    }
+
+    Metrics_Open(cur);
+
+    n = snprintf((char*) http_api_buf, HTTP_RESP_HDR_SIZE, "HTTP/1.1 200 OK\r\n"
+            "Content-Type: text/plain; version=0.0.4\r\n"
+            "Cache-Control: no-cache\r\n"
+            "Content-Length: %lu\r\n"
+            "\r\n", (unsigned long) Metrics_Length(cur));
+    if (n < 0 || n >= HTTP_RESP_HDR_SIZE) return SOCKERR_DATALEN;
+
+    len = (uint16_t) n;
+    if (conn->req.method == HTTP_METHOD_HEAD) return WebServer_Reply(sn, conn, len);
+
+    /* The header goes out with the first piece of the document */
+    len += Metrics_Read(cur, http_api_buf + len, HTTP_TX_BUF_SIZE - len);
+    if ((ret = WebServer_Reply(sn, conn, len)) > 0) conn->tx_doc = HTTP_DOC_METRICS;
+
+    return ret;
+}
+#endif
+
+#if HTTP_ADMIT_RATE
+
+/**
+ * @brief  Looks up the token bucket of a client address.
+ * @note   An address not seen before takes the bucket used least recently,
+ *         filled up.
+ * @param  ip: Client address.
+ * @retval Index of the bucket in http_client.
+ */
+static uint8_t WebServer_Client(const uint8_t* ip)
+{
+    uint32_t now = Tick_GetMs();
+    uint8_t oldest = 0;
+    uint8_t i;
+
+    for (i = 0; i < HTTP_ADMIT_CLIENTS; i++) {
+        if (memcmp(http_client[i].ip, ip, 4) == 0) return i;
+        if (now - http_client[i].last > now - http_client[oldest].last) oldest = i;
+    }
+
+    memcpy(http_client[oldest].ip, ip, 4);
+    http_client[oldest].tokens = (uint32_t) HTTP_ADMIT_BURST * 1000;
+    http_client[oldest].last = now;
+
+    return oldest;
+}
+#endif
+
+/**
+ * @brief  Decides whether a request is answered.
+ * @note   Takes a token from the client's bucket when it is admitted. Runs
+ *         once per request, however many passes its reply takes.
+ * @param  conn: Connection the request was received on.
+ * @retval HTTP_ADMIT_OK, HTTP_ADMIT_SHED or HTTP_ADMIT_LIMITED.
+ */
+static uint8_t WebServer_Admit(HTTP_Conn* conn)
+{
+#if HTTP_INFLIGHT_MAX
+    uint8_t busy = 0;
+    uint8_t i;
+#endif
+#if HTTP_ADMIT_RATE
+    HTTP_Client* client;
+    uint32_t now;
+    uint32_t idle;
+#endif
+
+#if HTTP_INFLIGHT_MAX
+    for (i = 0; i < HTTP_SOCK_COUNT; i++) {
+        if (&http_conn[i] != conn && !http_conn[i].stream
+                && (http_conn[i].tx_len > 0 || http_conn[i].tx_doc != HTTP_DOC_NONE || http_conn[i].tx_wait)) {
+            busy++;
+        }
+    }
+    if (busy >= HTTP_INFLIGHT_MAX) return HTTP_ADMIT_SHED;
+#endif
+
+#if HTTP_ADMIT_RATE
+    /* The bucket went to another address while the connection was open */
+    client = &http_client[conn->client];
+    if (memcmp(client->ip, conn->peer_ip, 4) != 0) {
+        conn->client = WebServer_Client(conn->peer_ip);
+        client = &http_client[conn->client];
+    }
+
+    now = Tick_GetMs();
+    idle = now - client->last;
+    client->last = now;
+    if (idle >= HTTP_ADMIT_FULL_MS) client->tokens = (uint32_t) HTTP_ADMIT_BURST * 1000;
+    else client->tokens += idle * HTTP_ADMIT_RATE;
+    if (client->tokens > (uint32_t) HTTP_ADMIT_BURST * 1000) client->tokens = (uint32_t) HTTP_ADMIT_BURST * 1000;
+
+    if (client->tokens < 1000) return HTTP_ADMIT_LIMITED;
+    client->tokens -= 1000;
+#endif
+
+    return HTTP_ADMIT_OK;
+}
+
+/**
+ * @brief  Answers one parsed request.
+ * @param  sn: Socket number to use.
+ * @param  conn: Connection the request was received on.
+ * @retval Length of the reply or of its first part, SOCK_BUSY if it has to
+ *         be answered again on a later pass, or a negative socket error.
+ */
+static int32_t WebServer_Respond(uint8_t sn, HTTP_Conn* conn)
+{
+    METRICS_TIMER(t);
+    HTTP_Request* req = &conn->req;
+    const WebAsset* asset;
+    Sampler_Snapshot snap;
+    uint32_t values[WEB_SLOT_NUM];
+    uint16_t len;
+    uint16_t hdr_len;
+
+    if (HTTP_PathIs(req, conn->rx_buf, "/api/calibration")) {
+        return WebServer_SendCalibration(sn, conn);
+    }
+    if (req->method != HTTP_METHOD_GET && req->method != HTTP_METHOD_HEAD) {
+        return WebServer_Queue(conn, http_resp_405, sizeof(http_resp_405) - 1);
+    }
+
+    if ((asset = WebServer_FindAsset(req, conn->rx_buf)) != 0) {
+        return WebServer_SendAsset(sn, conn, asset);
+    }
+
+    METRICS_START(t);
+    Sampler_Read(&snap);
+
+    if (HTTP_PathIs(req, conn->rx_buf, "/api/moisture")) {
+        if (WebServer_Unchanged(req, &snap)) return WebServer_NotModified(sn, conn);
+        WebServer_Values(&snap, values);
+        len = WebRender_Reply(&web_tmpl_moisture, values, http_etag_field, (char*) http_api_buf, &hdr_len);
+    }
+    else if (HTTP_PathIs(req, conn->rx_buf, "/api/moisture.bin")) {
+        if (WebServer_Unchanged(req, &snap)) return WebServer_NotModified(sn, conn);
+        len = WebServer_RenderRecord(&snap, &hdr_len);
+    }
+    else if (HTTP_PathIs(req, conn->rx_buf, "/gauge")) {
+        if (WebServer_Unchanged(req, &snap)) return WebServer_NotModified(sn, conn);
+        WebServer_Values(&snap, values);
+        len = WebRender_Reply(&web_tmpl_gauge, values, http_etag_field, (char*) http_api_buf, &hdr_len);
+    }
+    else if (HTTP_PathIs(req, conn->rx_buf, "/history")) {
+        return WebServer_SendHistory(sn, conn, HISTORY_FMT_CSV);
+    }
+    else if (HTTP_PathIs(req, conn->rx_buf, "/history.bin")) {
+        return WebServer_SendHistory(sn, conn, HISTORY_FMT_BIN);
+    }
+#if METRICS_ENABLE
+    else if (HTTP_PathIs(req, conn->rx_buf, "/metrics")) {
+        return WebServer_SendMetrics(sn, conn);
+    }
+#endif
+    else if (HTTP_PathIs(req, conn->rx_buf, "/events") && req->method == HTTP_METHOD_GET) {
+        /* The socket turns into an event stream until the client leaves */
+        conn->stream = 1;
+        conn->stream_seq = 0;
+        return WebServer_Queue(conn, http_sse_hdr, sizeof(http_sse_hdr) - 1);
+    }
+    else {
+        return WebServer_Queue(conn, http_resp_404, sizeof(http_resp_404) - 1);
+    }
+
+    METRICS_STOP(METRICS_PHASE_RENDER, t);
+
+    if (len == 0) {
+        close(sn);
+        return SOCKERR_DATALEN;
+    }
+
+    return WebServer_Reply(sn, conn, (req->method == HTTP_METHOD_HEAD) ? hdr_len : len);
+}
+
+/**
+ * @brief  Pushes new readings to a Server-Sent Events client.
+ * @note   An event is sent when the sampler has published a snapshot whose
+ *         values differ from the last one pushed, at most every
+ *         HTTP_SSE_MIN_INTERVAL_MS. A comment line is sent after
+ *         HTTP_SSE_HEARTBEAT_MS without events to keep the connection up.
+ *         An event that does not fit in the TX buffer is skipped; the next
+ *         one carries the newer values.
+ * @param  sn: Socket number to use.
+ * @param  buf: The RX buffer slice of the socket.
+ * @param  conn: Connection state of the socket.
+ * @retval 1 if the connection stays open, or a negative socket error.
+ */
+static int32_t WebServer_Stream(uint8_t sn, uint8_t* buf, HTTP_Conn* conn)
+{
+    Sampler_Snapshot snap;
+    uint32_t values[WEB_SLOT_NUM];
+    uint32_t now = Tick_GetMs();
+    uint16_t size;
+    uint16_t len;
+    int32_t ret;
+
+    /* Nothing more is expected from an event stream client */
+    if ((size = getSn_RX_RSR(sn)) > 0) {
+        if (size > HTTP_RX_BUF_SIZE) size = HTTP_RX_BUF_SIZE;
+        if ((ret = recv(sn, buf, size)) <= 0) return ret;
+        METRICS_ADD(METRICS_BYTES_IN, ret);
+    }
+
+    /* The stream header or a heartbeat is still going out */
+    if ((ret = WebServer_Flush(sn, conn)) <= 0) return (ret < 0) ? ret : 1;
+
+    if (Sampler_GetSeq() != conn->stream_seq && TICK_REACHED(now, conn->last_active + HTTP_SSE_MIN_INTERVAL_MS)) {
+        Sampler_Read(&snap);
+
+        if (conn->stream_seq == 0 || memcmp(snap.value, conn->stream_value, sizeof(snap.value)) != 0) {
+            WebServer_Values(&snap, values);
+            memcpy(http_api_buf, "id: ", 4);
+            len = 4 + WebRender_Utoa(snap.seq, (char*) http_api_buf + 4);
+            memcpy(http_api_buf + len, "\ndata: ", 7);
+            len += 7;
+            len += WebRender_Body(&web_tmpl_moisture, values, (char*) http_api_buf + len);
+            http_api_buf[len++] = '\n';
+            http_api_buf[len++] = '\n';
+
+            if ((ret = WebServer_Reply(sn, conn, len)) < 0) return ret;
+            if (ret == SOCK_BUSY) return 1;
+
+            memcpy(conn->stream_value, snap.value, sizeof(snap.value));
+            conn->last_active = now;
+        }
+        conn->stream_seq = snap.seq;
+    }
+
+    if (TICK_REACHED(now, conn->last_active + HTTP_SSE_HEARTBEAT_MS)) {
+        WebServer_Queue(conn, ":\n\n", 3);
+        conn->last_active = now;
+        if ((ret = WebServer_Flush(sn, conn)) < 0) return ret;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief  Receives into the connection's RX buffer and answers every
+ *         complete request in it.
+ * @note   At most HTTP_PIPELINE_PER_PASS pipelined requests are answered
+ *         per call so that one client cannot starve the other sockets, and
+ *         none while the reply before is still going out.
+ * @param  sn: Socket number to use.
+ * @param  buf: The RX buffer slice of the socket.
+ * @param  conn: Connection state of the socket.
+ * @retval 1 if the connection stays open, 0 if it was closed, or a negative
+ *         socket error.
+ */
+static int32_t WebServer_Process(uint8_t sn, uint8_t* buf, HTTP_Conn* conn)
+{
+    METRICS_TIMER(t);
+    int32_t ret;
+    uint16_t size;
+    uint8_t served;
+
+    conn->backlog = 0;
+
+    if ((size = getSn_RX_RSR(sn)) > 0 && conn->rx_len < HTTP_RX_BUF_SIZE) {
+        if (size > HTTP_RX_BUF_SIZE - conn->rx_len) size = HTTP_RX_BUF_SIZE - conn->rx_len;
+        METRICS_START(t);
+        ret = recv(sn, buf + conn->rx_len, size);
+        METRICS_STOP(METRICS_PHASE_RECV, t);
+        if (ret <= 0) return ret;
+        METRICS_ADD(METRICS_BYTES_IN, ret);
+        conn->rx_len += ret;
+        conn->last_active = Tick_GetMs();
+    }
+
+    for (served = 0; served < HTTP_PIPELINE_PER_PASS; served++) {
+        if ((ret = WebServer_Flush(sn, conn)) < 0) return ret;
+        if (ret == 0 || conn->tx_close) break;
+
+        ret = HTTP_Parse(&conn->req, buf, conn->rx_len);
+
+        if (ret == HTTP_PARSE_INCOMPLETE) {
+            if (conn->rx_len == HTTP_RX_BUF_SIZE) {
+                conn->rx_len = HTTP_Compact(&conn->req, buf, conn->rx_len);
+                if (conn->rx_len == HTTP_RX_BUF_SIZE) {
+                    /* A single line fills the whole RX buffer */
+                    WebServer_Queue(conn, http_resp_431, sizeof(http_resp_431) - 1);
+                    conn->tx_close = 1;
+                }
+            }
+            break;
+        }
+
+        if (ret == HTTP_PARSE_ERROR) {
+            WebServer_Queue(conn, http_resp_400, sizeof(http_resp_400) - 1);
+            conn->tx_close = 1;
+            break;
+        }
+
+        if (!conn->admitted) {
+            if ((ret = WebServer_Admit(conn)) != HTTP_ADMIT_OK) {
+                /* Nothing is sampled or rendered for a request turned away */
+                METRICS_ADD((ret == HTTP_ADMIT_SHED) ? METRICS_HTTP_SHED : METRICS_HTTP_RATE_LIMITED, 1);
+                LOG_DEBUG("%d:%s", sn, (ret == HTTP_ADMIT_SHED) ? "Shed" : "Rate limited");
+                WebServer_Queue(conn, http_resp_503, sizeof(http_resp_503) - 1);
+                conn->tx_close = 1;
+                break;
+            }
+            METRICS_ADD(METRICS_HTTP_ACCEPTED, 1);
+            conn->admitted = 1;
+        }
+
+        METRICS_START(t);
+        ret = WebServer_Respond(sn, conn);
+        METRICS_STOP(METRICS_PHASE_REQUEST, t);
+        if (ret < 0) return ret;
+
+        /* The request stays in the buffer until it can be answered */
+        if (ret == SOCK_BUSY) break;
+        conn->admitted = 0;
+
+        /* Method and path only; the UART could not keep up with whole heads */
+        LOG_INFO("%d:%s %.*s", sn, conn->req.method == HTTP_METHOD_HEAD ? "HEAD" : conn->req.method == HTTP_METHOD_POST ? "POST" : "GET",
+                (int) conn->req.path_len, buf + conn->req.path);
+        LOG_DEBUG("%d:%u head bytes, flags %02X, keep-alive %u", sn, conn->req.pos, conn->req.flags, HTTP_KeepAlive(&conn->req));
+
+        conn->requests++;
+        METRICS_ADD(METRICS_REQUESTS, 1);
+        conn->last_active = Tick_GetMs();
+
+        if (conn->stream) {
+            conn->rx_len = 0;
+            break;
+        }
+
+        if (!HTTP_KeepAlive(&conn->req) || conn->requests >= HTTP_KEEPALIVE_MAX) {
+            conn->tx_close = 1;
+            break;
+        }
+
+        conn->rx_len = HTTP_Consume(&conn->req, buf, conn->rx_len);
+    }
+
+    if ((ret = WebServer_Flush(sn, conn)) <= 0) return (ret < 0) ? ret : 1;
+
+    if (conn->tx_close) {
+        WebServer_Disconnect(sn);
+        return 0;
+    }
+
+    conn->backlog = (conn->rx_len > 0) && !conn->tx_wait && !conn->stream;
+    return 1;
+}
+
+/**
+ * @brief  WebServer example function.
+ * @note   Connections are kept open between requests until the client asks
+ *         to close, HTTP_KEEPALIVE_MAX requests have been answered or the
+ *         connection has been idle for HTTP_KEEPALIVE_TIMEOUT_MS.
+ * @param  sn: Socket number to use, one of the HTTP socket pool.
+ * @param  buf: The RX buffer slice of the socket, HTTP_RX_BUF_SIZE bytes.
+ * @param  port: Socket port number to use.
+ * @retval Success or Fail of configuration functions
+ */
+int32_t WebServer(uint8_t sn, uint8_t* buf, uint16_t port)
+{
+    HTTP_Conn* conn = &http_conn[sn - HTTP_SOCK_START];
+    uint8_t waited = conn->tx_wait;
+    uint8_t sr = getSn_SR(sn);
+    int32_t ret;
+
+    /* Set again by whatever output still waits for the chip */
+    conn->tx_wait = 0;
+
+    /* A client can connect, send its request and close its side between
+     * two passes, so the new connection may first be seen in CLOSE_WAIT. */
+    if ((sr == SOCK_ESTABLISHED || sr == SOCK_CLOSE_WAIT) && (getSn_IR(sn) & Sn_IR_CON)) {
+
+        WebServer_ResetConn(conn);
+        waited = 0;
+
+        getSn_DIPR(sn, conn->peer_ip);
+        conn->peer_port = getSn_DPORT(sn);
+#if HTTP_ADMIT_RATE
+        conn->client = WebServer_Client(conn->peer_ip);
+#endif
+        LOG_INFO("%d:Connected - %d.%d.%d.%d : %d", sn, conn->peer_ip[0], conn->peer_ip[1], conn->peer_ip[2], conn->peer_ip[3], conn->peer_port);
+
+        METRICS_ADD(METRICS_CONNECTIONS, 1);
+        setSn_IR(sn, Sn_IR_CON);
+    }
+
+    switch (sr)
+    {
+        case SOCK_ESTABLISHED:
+
+            if (conn->stream) ret = WebServer_Stream(sn, buf, conn);
+            else ret = WebServer_Process(sn, buf, conn);
+            if (ret <= 0) return ret;
+
+            if (conn->tx_wait) {
+                WebServer_Wait(sn, conn, waited);
+            }
+            else if (!conn->stream && TICK_REACHED(Tick_GetMs(), conn->last_active + HTTP_KEEPALIVE_TIMEOUT_MS)) {
+                LOG_INFO("%d:Idle timeout", sn);
+                WebServer_Disconnect(sn);
+            }
+
+            break;
+        case SOCK_CLOSE_WAIT:
+
+            /* Answer what the client sent before closing its side */
+            if (!conn->stream && (ret = WebServer_Process(sn, buf, conn)) <= 0) return ret;
+
+            if (!conn->stream && (conn->tx_wait || conn->backlog)) {
+                if (conn->tx_wait) WebServer_Wait(sn, conn, waited);
+                break;
+            }
+
+            METRICS_ADD(METRICS_CLOSE_WAIT, 1);
+            if ((ret = WebServer_Disconnect(sn)) < 0) return ret;
+
+            LOG_INFO("%d:Socket Closed", sn);
+
+            break;
+        case SOCK_INIT:
+
+            LOG_INFO("%d:Listen, Web server, port [%d]", sn, port);
+
+            if ((ret = listen(sn)) != SOCK_OK) return ret;
+
+            break;
+        case SOCK_CLOSED:
+
+            /* Nothing of the last client may leak into the next one */
+            WebServer_ResetConn(conn);
+            if ((ret = socket(sn, Sn_MR_TCP, port, SF_IO_NONBLOCK)) != sn) return ret;
+
+            break;
+        default:
+            break;
+    }
+    return 1;
+}
+
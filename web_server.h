@@ -0,0 +1,120 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/web_server.h
+ * @author  WIZnet
+ * @brief   Header for web_server.c module
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __WEB_SERVER_H
+#define __WEB_SERVER_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#ifndef HTTP_PORT
+#define HTTP_PORT 80
+#endif
+
+/* Hardware sockets HTTP_SOCK_START .. HTTP_SOCK_START + HTTP_SOCK_COUNT - 1
+ * all listen on HTTP_PORT. Socket 0 is left to the DHCP client. */
+#ifndef HTTP_SOCK_START
+#define HTTP_SOCK_START 1
+#endif
+#ifndef HTTP_SOCK_COUNT
+#define HTTP_SOCK_COUNT 4
+#endif
+
+/* RX buffer slice per HTTP socket */
+#ifndef HTTP_RX_BUF_SIZE
+#define HTTP_RX_BUF_SIZE 512
+#endif
+
+/* Buffer generated replies are rendered into; longer ones, such as
+ * /history, are sent in pieces of this size. The TX buffer of every HTTP
+ * socket must hold at least one piece. */
+#ifndef HTTP_TX_BUF_SIZE
+#define HTTP_TX_BUF_SIZE 1024
+#endif
+
+/* Idle time after which a kept-alive connection is closed */
+#ifndef HTTP_KEEPALIVE_TIMEOUT_MS
+#define HTTP_KEEPALIVE_TIMEOUT_MS 10000
+#endif
+
+/* Time a reply may wait for the client to make room in the TX buffer
+ * before the connection is dropped */
+#ifndef HTTP_SEND_TIMEOUT_MS
+#define HTTP_SEND_TIMEOUT_MS 10000
+#endif
+
+/* Requests answered on one connection before it is closed */
+#ifndef HTTP_KEEPALIVE_MAX
+#define HTTP_KEEPALIVE_MAX 100
+#endif
+
+/* Pipelined requests answered per socket and pass of WebServer_Run() */
+#ifndef HTTP_PIPELINE_PER_PASS
+#define HTTP_PIPELINE_PER_PASS 2
+#endif
+
+/* Minimum time between two events on an /events stream */
+#ifndef HTTP_SSE_MIN_INTERVAL_MS
+#define HTTP_SSE_MIN_INTERVAL_MS 200
+#endif
+
+/* Time without events after which an /events stream gets a keep-alive
+ * comment */
+#ifndef HTTP_SSE_HEARTBEAT_MS
+#define HTTP_SSE_HEARTBEAT_MS 15000
+#endif
+
+/* Filtered counts a channel must move by before the readings get a new
+ * ETag; smaller moves are answered with 304 Not Modified. 0 gives every
+ * change a new tag. */
+#ifndef HTTP_ETAG_DEADBAND
+#define HTTP_ETAG_DEADBAND 8
+#endif
+
+/* Requests per second each client address may make on average, and how
+ * many it may make in a burst; a client over its rate is answered with
+ * 503 Service Unavailable. 0 turns the limit off. */
+#ifndef HTTP_ADMIT_RATE
+#define HTTP_ADMIT_RATE 10
+#endif
+#ifndef HTTP_ADMIT_BURST
+#define HTTP_ADMIT_BURST 20
+#endif
+
+/* Client addresses tracked; the one seen least recently gives up its
+ * place to a new one */
+#ifndef HTTP_ADMIT_CLIENTS
+#define HTTP_ADMIT_CLIENTS 8
+#endif
+
+/* Replies that may be going out at once; a request arriving while the
+ * other sockets hold this many is answered with 503 Service Unavailable.
+ * 0 turns the cap off. */
+#ifndef HTTP_INFLIGHT_MAX
+#define HTTP_INFLIGHT_MAX (HTTP_SOCK_COUNT - 1)
+#endif
+
+/* Seconds a client turned away is asked to wait */
+#ifndef HTTP_RETRY_AFTER_S
+#define HTTP_RETRY_AFTER_S 1
+#endif
+
+/* SRAM of the connection states, at most 160 bytes each, the client
+ * buckets and the ETag of the readings */
+#define HTTP_RAM_SIZE (HTTP_SOCK_COUNT * 160 + HTTP_ADMIT_CLIENTS * 12 + 80)
+
+/* Exported functions ------------------------------------------------------- */
+void WebServer_Init(void);
+void WebServer_Run(void);
+int32_t WebServer(uint8_t sn, uint8_t* buf, uint16_t port);
+
+#endif /* __WEB_SERVER_H */
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
@@ -0,0 +1,84 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/web_templates.c
+ * @author  WIZnet
+ * @brief   Reply templates, generated by tools/mktemplates.py
+ *          from templates/. Do not edit.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "web_templates.h"
+
+/* gauge.html: 5 segments, 447 static bytes, body 463 bytes at most */
+static const WebSegment tmpl_gauge_seg[5] = {
+    { "<!DOCTYPE HTML>\n"
+      "<html>\n"
+      "<head>\n"
+      "    <meta charset=\"UTF-8\">\n"
+      "    <meta http-equiv=\"refresh\" content=\"10\">\n"
+      "    <title>Wiznet W7500x Web Server</title>\n"
+      "    <link rel=\"stylesheet\" href=\"/style.css\">\n"
+      "</head>\n"
+      "<body>\n"
+      "    <div class=\"container\">\n"
+      "        <h1>Wiznet W7500x Web Server</h1>\n"
+      "        <div class=\"gauge\" data-v=\"",
+      312, WEB_SLOT_READING, WEB_FMT_TENTHS },
+    { "%\" style=\"background: conic-gradient(#4caf50 0% ",
+      48, WEB_SLOT_GAUGE_PCT, WEB_FMT_UINT },
+    { "%, #f44336 ",
+      11, WEB_SLOT_GAUGE_PCT, WEB_FMT_UINT },
+    { "% 100%)\"></div>\n"
+      "        <p>Soil moisture is ",
+      44, WEB_SLOT_READING, WEB_FMT_TENTHS },
+    { "%</p>\n"
+      "    </div>\n"
+      "</body>\n"
+      "</html>",
+      32, WEB_SLOT_NONE, WEB_FMT_UINT },
+};
+
+const WebTemplate web_tmpl_gauge = {
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/html; charset=utf-8\r\n"
+    "Cache-Control: no-cache\r\n",
+    82, tmpl_gauge_seg, 5, 447
+};
+
+/* moisture.json: 12 segments, 59 static bytes, body 116 bytes at most */
+static const WebSegment tmpl_moisture_seg[12] = {
+    { "{\"reading\":",
+      11, WEB_SLOT_READING, WEB_FMT_TENTHS },
+    { ",\"moisture\":[",
+      13, WEB_SLOT_MOISTURE0, WEB_FMT_UINT },
+    { ",",
+      1, WEB_SLOT_MOISTURE1, WEB_FMT_UINT },
+    { ",",
+      1, WEB_SLOT_MOISTURE2, WEB_FMT_UINT },
+    { ",",
+      1, WEB_SLOT_MOISTURE3, WEB_FMT_UINT },
+    { "],\"channels\":[",
+      14, WEB_SLOT_CHANNEL0, WEB_FMT_UINT },
+    { ",",
+      1, WEB_SLOT_CHANNEL1, WEB_FMT_UINT },
+    { ",",
+      1, WEB_SLOT_CHANNEL2, WEB_FMT_UINT },
+    { ",",
+      1, WEB_SLOT_CHANNEL3, WEB_FMT_UINT },
+    { "],\"ts\":",
+      7, WEB_SLOT_TS, WEB_FMT_UINT },
+    { ",\"seq\":",
+      7, WEB_SLOT_SEQ, WEB_FMT_UINT },
+    { "}",
+      1, WEB_SLOT_NONE, WEB_FMT_UINT },
+};
+
+const WebTemplate web_tmpl_moisture = {
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: application/json\r\n"
+    "Cache-Control: no-cache\r\n",
+    74, tmpl_moisture_seg, 12, 59
+};
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
@@ -0,0 +1,46 @@
+/**
+ ******************************************************************************
+ * @file    WZTOE/WZTOE_WebServer/web_templates.h
+ * @author  WIZnet
+ * @brief   Slots and reply templates, generated by tools/mktemplates.py
+ *          from templates/. Do not edit.
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __WEB_TEMPLATES_H
+#define __WEB_TEMPLATES_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "web_render.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Slots, indices into the values array */
+#define WEB_SLOT_READING                0
+#define WEB_SLOT_GAUGE_PCT              1
+#define WEB_SLOT_MOISTURE0              2
+#define WEB_SLOT_MOISTURE1              3
+#define WEB_SLOT_MOISTURE2              4
+#define WEB_SLOT_MOISTURE3              5
+#define WEB_SLOT_CHANNEL0               6
+#define WEB_SLOT_CHANNEL1               7
+#define WEB_SLOT_CHANNEL2               8
+#define WEB_SLOT_CHANNEL3               9
+#define WEB_SLOT_TS                     10
+#define WEB_SLOT_SEQ                    11
+#define WEB_SLOT_NUM                    12
+
+/* Longest body and longest reply of each template, without the extra
+ * header fields passed to WebRender_Reply() */
+#define WEB_TMPL_GAUGE_BODY_MAX         463
+#define WEB_TMPL_GAUGE_MAX              568
+#define WEB_TMPL_MOISTURE_BODY_MAX      116
+#define WEB_TMPL_MOISTURE_MAX           213
+
+/* Exported variables --------------------------------------------------------*/
+extern const WebTemplate web_tmpl_gauge;
+extern const WebTemplate web_tmpl_moisture;
+
+#endif /* __WEB_TEMPLATES_H */
+
+/******************** (C) COPYRIGHT WIZnet *****END OF FILE********************/
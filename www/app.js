@@ -0,0 +1,8 @@
+function show(d) {
+    var v = d.reading, g = document.getElementById('g');
+    g.setAttribute('data-v', v + '%');
+    g.style.background = 'conic-gradient(#4caf50 0% ' + v + '%, #f44336 ' + v + '% 100%)';
+    document.getElementById('r').textContent = v + '%';
+}
+fetch('/api/moisture').then(function (r) { return r.json(); }).then(show);
+new EventSource('/events').onmessage = function (e) { show(JSON.parse(e.data)); };